@@ -29,6 +29,7 @@
 
 #include HEADER(core/base_definitions.hh)     // IWYU pragma: keep
 #include HEADER(resources/OneCharStringTable.hh) // IWYU pragma: keep
+#include HEADER(resources/Pow10SignificandTable.hh) // IWYU pragma: keep
 #include HEADER(core/cstring.hh)              // IWYU pragma: keep
 #include HEADER(core/range.hh)                // IWYU pragma: keep
 #include HEADER(core/reflection_type.hh)      // IWYU pragma: keep
@@ -43,20 +44,27 @@
 #include HEADER(core/property.hh)             // IWYU pragma: keep
 #include HEADER(core/pointer.hh)              // IWYU pragma: keep
 #include HEADER(core/class.hh)                // IWYU pragma: keep
+#include HEADER(core/spinlock.hh)             // IWYU pragma: keep
+#include HEADER(core/allocator.hh)            // IWYU pragma: keep
 #include HEADER(core/union.hh)                // IWYU pragma: keep
 #include HEADER(core/result.hh)               // IWYU pragma: keep
 #include HEADER(core/optional.hh)             // IWYU pragma: keep
 #include HEADER(core/errors.hh)               // IWYU pragma: keep
 #include HEADER(core/profiler.hh)             // IWYU pragma: keep
+#include HEADER(core/heap_stats.hh)           // IWYU pragma: keep
 
 #include HEADER(core/array_iterator.hh)       // IWYU pragma: keep
 #include HEADER(core/index.hh)                // IWYU pragma: keep
 #include HEADER(core/iterable.hh)             // IWYU pragma: keep
 #include HEADER(core/arrayref.hh)             // IWYU pragma: keep
+#include HEADER(core/string_search.hh)        // IWYU pragma: keep
 #include HEADER(core/string_ref.hh)           // IWYU pragma: keep
 #include HEADER(core/math_int.hh)             // IWYU pragma: keep
 #include HEADER(core/math_float.hh)           // IWYU pragma: keep
 #include HEADER(core/math_double.hh)           // IWYU pragma: keep
+#include HEADER(core/float_to_chars.hh)        // IWYU pragma: keep
+#include HEADER(core/parse_number.hh)          // IWYU pragma: keep
+#include HEADER(core/format_string.hh)        // IWYU pragma: keep
 
 
 #include HEADER(core/rng.hh)                  // IWYU pragma: keep
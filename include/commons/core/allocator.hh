@@ -0,0 +1,306 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+namespace cm {
+
+///
+/// Rounds a value up to the next multiple of a power-of-two alignment.
+///
+FORCEINLINE constexpr usize alignUp(usize value, usize alignment)
+{
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+///
+/// A type-erased reference to a memory allocator.
+/// Containers store one of these by value so that they can be told where their memory comes from without becoming
+/// templates on the allocator type (which would make a DLList<int> from an Arena a different type than a DLList<int>
+/// from the heap). It works just like Class does for type erasure: a record of function pointers plus a state pointer.
+///
+/// A default-constructed Allocator uses the global operator new/delete.
+///
+struct Allocator : IEquatable<Allocator>
+{
+    using AllocateFunction = CFunction<void*(void* state, usize sizeBytes, usize alignment)>;
+    using DeallocateFunction = CFunction<void(void* state, void* ptr, usize sizeBytes, usize alignment)>;
+
+    ///
+    /// Default constructor, uses the global heap
+    ///
+    constexpr Allocator() = default;
+
+    ///
+    /// Constructs an allocator from a state pointer and the functions operating on it.
+    ///
+    constexpr Allocator(void* state, AllocateFunction allocate, DeallocateFunction deallocate)
+        : _state(state), _allocate(allocate), _deallocate(deallocate)
+    {}
+
+    ///
+    /// Allocates a block of memory. Panics if there is no memory left.
+    /// @param sizeBytes The size of the block
+    /// @param alignment The alignment of the block, must be a power of two
+    ///
+    [[gnu::alloc_size(2), gnu::alloc_align(3)]]
+    inline void* allocate(usize sizeBytes, usize alignment = alignof(void*)) const
+    {
+        void* ptr = _allocate(_state, sizeBytes, alignment);
+        Assert(ptr, ASMS_NO_MEMORY);
+        return ptr;
+    }
+
+    ///
+    /// Returns a block of memory to the allocator.
+    /// @param ptr The block, or nullptr
+    /// @param sizeBytes The size that was passed to allocate() for this block
+    /// @param alignment The alignment that was passed to allocate() for this block
+    ///
+    inline void deallocate(void* ptr, usize sizeBytes, usize alignment = alignof(void*)) const
+    {
+        if (ptr != nullptr) {
+            _deallocate(_state, ptr, sizeBytes, alignment);
+        }
+    }
+
+    ///
+    /// Allocates uninitialized storage for n objects of type T.
+    ///
+    template<typename T>
+    inline T* allocateArray(usize n) const
+    {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    ///
+    /// Returns storage obtained from allocateArray<T>(n).
+    ///
+    template<typename T>
+    inline void deallocateArray(T* ptr, usize n) const
+    {
+        deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    ///
+    /// Returns true if this allocator uses the global heap.
+    ///
+    constexpr bool isHeap() const { return _allocate.equals(heapAllocate); }
+
+    constexpr bool equals(Allocator const& other) const
+    {
+        return _state == other._state && _allocate.equals(other._allocate) && _deallocate.equals(other._deallocate);
+    }
+
+private:
+    static void* heapAllocate(void*, usize sizeBytes, usize alignment)
+    {
+        if (alignment <= alignof(void*)) {
+            return ::operator new(sizeBytes);
+        }
+        return ::operator new(sizeBytes, std::align_val_t(alignment));
+    }
+
+    static void heapDeallocate(void*, void* ptr, usize sizeBytes, usize alignment)
+    {
+        if (alignment <= alignof(void*)) {
+            ::operator delete(ptr, sizeBytes);
+        } else {
+            ::operator delete(ptr, sizeBytes, std::align_val_t(alignment));
+        }
+    }
+
+    void* _state = nullptr;
+    AllocateFunction _allocate = heapAllocate;
+    DeallocateFunction _deallocate = heapDeallocate;
+};
+
+
+///
+/// A bump-pointer allocator that carves allocations out of large chunks.
+/// Allocating is a pointer increment, and individual deallocations are (mostly) no-ops: instead, everything that was
+/// allocated from the arena is released at once by reset(), which takes constant time and keeps the chunks around so
+/// the next batch of allocations does not have to go back to the heap.
+///
+/// Typical usage is a request-scoped workload:
+/// \code{.cpp}
+///     Arena arena;
+///     while (auto request = nextRequest()) {
+///         DLList<String> words(arena);
+///         ...
+///         arena.reset();
+///     }
+/// \endcode
+/// @attention Containers given an arena must not be used (or destroyed) after the arena is reset or destroyed.
+///
+class Arena {
+    struct Chunk
+    {
+        Chunk* next;
+        usize capacity;  // bytes available after the header
+    };
+
+    Chunk* _first = nullptr;
+    Chunk* _current = nullptr;
+    u8* _ptr = nullptr;
+    u8* _end = nullptr;
+    usize _chunkSize;
+    Allocator _upstream;
+
+public:
+    constexpr static usize DEFAULT_CHUNK_SIZE = 64_KB;
+
+    ///
+    /// Creates an empty arena. No memory is taken from the upstream allocator until the first allocation.
+    /// @param chunkSize The size of each chunk requested from the upstream allocator
+    /// @param upstream Where the chunks come from
+    ///
+    explicit Arena(usize chunkSize = DEFAULT_CHUNK_SIZE, Allocator const& upstream = {})
+        : _chunkSize(chunkSize), _upstream(upstream)
+    {
+        Assert(chunkSize > sizeof(Chunk), ASMS_INVALID(chunkSize));
+    }
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    ~Arena() { release(); }
+
+    ///
+    /// Allocates a block from the current chunk, moving on to the next chunk if it does not fit.
+    ///
+    [[gnu::alloc_size(2), gnu::alloc_align(3)]]
+    inline void* allocate(usize sizeBytes, usize alignment = alignof(void*))
+    {
+        UNSAFE_BEGIN;
+        auto* p = reinterpret_cast<u8*>(alignUp(reinterpret_cast<usize>(_ptr), alignment));
+        if (p + sizeBytes > _end || _ptr == nullptr) [[unlikely]] {
+            p = _nextChunk(sizeBytes, alignment);
+        }
+        _ptr = p + sizeBytes;
+        return p;
+        UNSAFE_END;
+    }
+
+    ///
+    /// Deallocation only reclaims memory if ptr was the most recent allocation; otherwise it does nothing and the
+    /// memory is reclaimed by reset().
+    ///
+    inline void deallocate(void* ptr, usize sizeBytes, usize = alignof(void*))
+    {
+        UNSAFE_BEGIN;
+        if (static_cast<u8*>(ptr) + sizeBytes == _ptr) {
+            _ptr = static_cast<u8*>(ptr);
+        }
+        UNSAFE_END;
+    }
+
+    ///
+    /// Releases everything allocated from the arena in O(1). The chunks are kept and reused by later allocations.
+    ///
+    inline void reset()
+    {
+        _current = _first;
+        if (_current != nullptr) {
+            _ptr = _chunkData(_current);
+            UNSAFE(_end = _ptr + _current->capacity);
+        }
+    }
+
+    ///
+    /// Returns all chunks to the upstream allocator.
+    ///
+    inline void release()
+    {
+        for (auto* c = _first; c != nullptr;) {
+            auto* next = c->next;
+            _upstream.deallocate(c, sizeof(Chunk) + c->capacity);
+            c = next;
+        }
+        _first = _current = nullptr;
+        _ptr = _end = nullptr;
+    }
+
+    ///
+    /// Returns the number of bytes reserved from the upstream allocator.
+    ///
+    inline usize reservedBytes() const
+    {
+        usize total = 0;
+        for (auto* c = _first; c != nullptr; c = c->next) {
+            total += sizeof(Chunk) + c->capacity;
+        }
+        return total;
+    }
+
+    ///
+    /// Returns a type-erased Allocator which allocates from this arena, to hand to containers.
+    ///
+    inline Allocator allocator() { return Allocator(this, _allocate, _deallocate); }
+    inline operator Allocator() { return allocator(); }
+
+private:
+    static u8* _chunkData(Chunk* c) { return UNSAFE(reinterpret_cast<u8*>(c) + sizeof(Chunk)); }
+
+    static void* _allocate(void* self, usize sizeBytes, usize alignment)
+    {
+        return static_cast<Arena*>(self)->allocate(sizeBytes, alignment);
+    }
+
+    static void _deallocate(void* self, void* ptr, usize sizeBytes, usize alignment)
+    {
+        static_cast<Arena*>(self)->deallocate(ptr, sizeBytes, alignment);
+    }
+
+    ///
+    /// Finds a chunk with room for the allocation, reusing chunks kept from before a reset() if possible.
+    ///
+    [[clang::noinline]]
+    u8* _nextChunk(usize sizeBytes, usize alignment)
+    {
+        UNSAFE_BEGIN;
+        // Reuse chunks retained by reset()
+        for (auto* c = (_current != nullptr) ? _current->next : nullptr; c != nullptr; c = c->next) {
+            auto* p = reinterpret_cast<u8*>(alignUp(reinterpret_cast<usize>(_chunkData(c)), alignment));
+            if (p + sizeBytes <= _chunkData(c) + c->capacity) {
+                _current = c;
+                _end = _chunkData(c) + c->capacity;
+                return p;
+            }
+        }
+        // Otherwise get a new chunk. Oversized requests get a chunk of their own.
+        auto capacity = max(_chunkSize - sizeof(Chunk), sizeBytes + alignment);
+        auto* chunk = static_cast<Chunk*>(_upstream.allocate(sizeof(Chunk) + capacity, alignof(Chunk)));
+        chunk->capacity = capacity;
+
+        // Link it after the current chunk so that it is reused in the same order after a reset()
+        if (_current == nullptr) {
+            chunk->next = _first;
+            _first = chunk;
+        } else {
+            chunk->next = _current->next;
+            _current->next = chunk;
+        }
+        _current = chunk;
+        _end = _chunkData(chunk) + capacity;
+        return reinterpret_cast<u8*>(alignUp(reinterpret_cast<usize>(_chunkData(chunk)), alignment));
+        UNSAFE_END;
+    }
+};
+
+}  // namespace cm
+#endif
@@ -355,6 +355,10 @@ void operator delete(void* ptr) noexcept;
 void operator delete[](void* ptr) noexcept;
 void operator delete(void* ptr, std::size_t sz) noexcept;
 void operator delete[](void* ptr, std::size_t sz) noexcept;
+void operator delete(void* ptr, std::align_val_t al) noexcept;
+void operator delete[](void* ptr, std::align_val_t al) noexcept;
+void operator delete(void* ptr, std::size_t sz, std::align_val_t al) noexcept;
+void operator delete[](void* ptr, std::size_t sz, std::align_val_t al) noexcept;
 
 
 template<typename T, typename... Args>
@@ -39,6 +39,7 @@ public:
     CFunction<void(void*, void*)> moveConstructor;
     CFunction<void(void*, void*)> moveAssignOperator;
     u32 sizeBytes;
+    u32 alignBytes;
     u32 isPrimitive : 1;
     u32 isSigned : 1;
     u32 isFloatingPoint : 1;
@@ -74,6 +75,7 @@ public:
         Class result{};
         result.name = name;
         result.sizeBytes = sizeof(T);
+        result.alignBytes = alignof(T);
         result.isPrimitive = !IsClass<T>;
         result.isSigned = !IsClass<T> && !IsUnsignedInteger<T>;
         result.isFloatingPoint = IsFloatingPoint<T>;
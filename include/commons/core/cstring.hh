@@ -19,117 +19,365 @@
 #else
 UNSAFE_BEGIN;
 
-extern "C" {
+namespace cm::impl {
 
-constexpr void* memset(void* dst, int c, usize n)
+///
+/// memcpy, memmove and memset work in chunks of the widest vector register the target has, and pick a strategy by
+/// size: up to 4 chunks, both ends are loaded before anything is stored (with overlapping stores in the middle), so
+/// there is no loop and overlapping buffers are handled for free; above that, a loop stores 4 chunks at a time to
+/// aligned addresses. Above NON_TEMPORAL_THRESHOLD, the stores bypass the cache, since a copy that large would evict
+/// everything else from it and will not be read back soon.
+///
+#if __AVX2__
+using MemoryChunk = __attribute__((__vector_size__(32))) u8;
+#else
+using MemoryChunk = __attribute__((__vector_size__(16))) u8;
+#endif
+constexpr inline usize MEMORY_CHUNK = sizeof(MemoryChunk);
+constexpr inline usize NON_TEMPORAL_THRESHOLD = 4ull << 20;
+
+template<usize N>
+using MemoryBytes = __attribute__((__vector_size__(N))) u8;
+
+template<usize N>
+[[clang::always_inline]] inline MemoryBytes<N> loadBytes(void const* p)
+{
+    MemoryBytes<N> v;
+    __builtin_memcpy_inline(&v, p, N);
+    return v;
+}
+
+template<usize N>
+[[clang::always_inline]] inline void storeBytes(void* p, MemoryBytes<N> v)
+{
+    __builtin_memcpy_inline(p, &v, N);
+}
+
+///
+/// Copies N to 2N bytes with two loads and two stores that overlap in the middle.
+///
+template<usize N>
+[[clang::always_inline]] inline void copyBothEnds(u8* dst, u8 const* src, usize n)
 {
-    constexpr auto alignment = alignof(long long);
-    auto* p = reinterpret_cast<u8*>(dst);
-    auto* end = p + n;
+    auto head = loadBytes<N>(src);
+    auto tail = loadBytes<N>(src + n - N);
+    storeBytes<N>(dst, head);
+    storeBytes<N>(dst + n - N, tail);
+}
 
-    for (; (reinterpret_cast<usize>(p) & (alignment - 1)) != 0 && p < end; p++) {
-        *p = static_cast<u8>(c);
+///
+/// Copies up to 4 chunks. Everything is loaded before anything is stored, so the buffers may overlap.
+///
+[[clang::always_inline]] inline void copySmall(u8* dst, u8 const* src, usize n)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    if (n <= 16) {
+        if (n >= 8) {
+            copyBothEnds<8>(dst, src, n);
+        } else if (n >= 4) {
+            copyBothEnds<4>(dst, src, n);
+        } else if (n >= 2) {
+            copyBothEnds<2>(dst, src, n);
+        } else if (n == 1) {
+            *dst = *src;
+        }
+    } else if (n <= 32) {
+        copyBothEnds<16>(dst, src, n);
+    } else if (n <= 2 * C) {
+        copyBothEnds<C>(dst, src, n);
+    } else {
+        auto a = loadBytes<C>(src);
+        auto b = loadBytes<C>(src + C);
+        auto c = loadBytes<C>(src + n - (2 * C));
+        auto d = loadBytes<C>(src + n - C);
+        storeBytes<C>(dst, a);
+        storeBytes<C>(dst + C, b);
+        storeBytes<C>(dst + n - (2 * C), c);
+        storeBytes<C>(dst + n - C, d);
     }
-    for (; p < end; p += alignment) {
-        __builtin_memset_inline(p, c, alignment);
+}
+
+///
+/// Copies more than 4 chunks from the front to the back, which is also correct if dst is before src.
+/// The first chunk and the last 4 are loaded up front and stored unaligned at the end; the loop in between stores to
+/// aligned addresses.
+///
+[[clang::noinline, clang::no_builtin]] inline void copyForward(u8* dst, u8 const* src, usize n)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    auto head = loadBytes<C>(src);
+    auto tail0 = loadBytes<C>(src + n - (4 * C));
+    auto tail1 = loadBytes<C>(src + n - (3 * C));
+    auto tail2 = loadBytes<C>(src + n - (2 * C));
+    auto tail3 = loadBytes<C>(src + n - C);
+
+    usize skip = C - (reinterpret_cast<usize>(dst) & (C - 1));
+    u8* d = dst + skip;
+    u8 const* s = src + skip;
+    usize remaining = n - skip;
+    // Only when the buffers are far enough apart that the loop cannot overwrite what it has yet to read
+    bool nonTemporal = n >= NON_TEMPORAL_THRESHOLD && (src + n <= dst || dst + n <= src);
+    if (nonTemporal) {
+        for (; remaining > 4 * C; d += 4 * C, s += 4 * C, remaining -= 4 * C) {
+            __builtin_nontemporal_store(loadBytes<C>(s), reinterpret_cast<MemoryChunk*>(d));
+            __builtin_nontemporal_store(loadBytes<C>(s + C), reinterpret_cast<MemoryChunk*>(d + C));
+            __builtin_nontemporal_store(loadBytes<C>(s + (2 * C)), reinterpret_cast<MemoryChunk*>(d + (2 * C)));
+            __builtin_nontemporal_store(loadBytes<C>(s + (3 * C)), reinterpret_cast<MemoryChunk*>(d + (3 * C)));
+        }
+        // Non-temporal stores are weakly ordered
+        __builtin_ia32_sfence();
+    } else {
+        for (; remaining > 4 * C; d += 4 * C, s += 4 * C, remaining -= 4 * C) {
+            auto a = loadBytes<C>(s);
+            auto b = loadBytes<C>(s + C);
+            auto c = loadBytes<C>(s + (2 * C));
+            auto e = loadBytes<C>(s + (3 * C));
+            *reinterpret_cast<MemoryChunk*>(d) = a;
+            *reinterpret_cast<MemoryChunk*>(d + C) = b;
+            *reinterpret_cast<MemoryChunk*>(d + (2 * C)) = c;
+            *reinterpret_cast<MemoryChunk*>(d + (3 * C)) = e;
+        }
     }
-    return dst;
+    storeBytes<C>(dst + n - (4 * C), tail0);
+    storeBytes<C>(dst + n - (3 * C), tail1);
+    storeBytes<C>(dst + n - (2 * C), tail2);
+    storeBytes<C>(dst + n - C, tail3);
+    storeBytes<C>(dst, head);
 }
 
-constexpr void* memmove(void* pdst, void const* psrc, usize n)
-{
-    auto dst = reinterpret_cast<u8*>(pdst);
-    auto src = reinterpret_cast<u8 const*>(psrc);
-    // TODO: Optimize
-
-    if (src < dst)
-        for (dst += n, src += n; n--;)
-            *--dst = *--src;
-    else
-        while (n--)
-            *dst++ = *src++;
-    return pdst;
+///
+/// Copies more than 4 chunks from the back to the front, for memmove when dst overlaps the end of src.
+///
+[[clang::noinline, clang::no_builtin]] inline void copyBackward(u8* dst, u8 const* src, usize n)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    auto tail = loadBytes<C>(src + n - C);
+    auto head0 = loadBytes<C>(src);
+    auto head1 = loadBytes<C>(src + C);
+    auto head2 = loadBytes<C>(src + (2 * C));
+    auto head3 = loadBytes<C>(src + (3 * C));
+
+    u8* d = dst + n;
+    d -= reinterpret_cast<usize>(d) & (C - 1);
+    u8 const* s = src + (d - dst);
+    for (usize remaining = usize(d - dst); remaining > 4 * C; remaining -= 4 * C) {
+        d -= 4 * C;
+        s -= 4 * C;
+        auto a = loadBytes<C>(s);
+        auto b = loadBytes<C>(s + C);
+        auto c = loadBytes<C>(s + (2 * C));
+        auto e = loadBytes<C>(s + (3 * C));
+        *reinterpret_cast<MemoryChunk*>(d) = a;
+        *reinterpret_cast<MemoryChunk*>(d + C) = b;
+        *reinterpret_cast<MemoryChunk*>(d + (2 * C)) = c;
+        *reinterpret_cast<MemoryChunk*>(d + (3 * C)) = e;
+    }
+    storeBytes<C>(dst, head0);
+    storeBytes<C>(dst + C, head1);
+    storeBytes<C>(dst + (2 * C), head2);
+    storeBytes<C>(dst + (3 * C), head3);
+    storeBytes<C>(dst + n - C, tail);
 }
 
-[[clang::always_inline]] static void* PtrAdd(void const* ptr, usize offset)
-{
-    return reinterpret_cast<u8*>(const_cast<void*>(ptr)) + offset;
+///
+/// Fills more than 4 chunks: aligned stores in a loop, then the unaligned ends.
+///
+[[clang::noinline, clang::no_builtin]] inline void fillLarge(u8* dst, MemoryChunk value, usize n)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    storeBytes<C>(dst, value);
+    usize skip = C - (reinterpret_cast<usize>(dst) & (C - 1));
+    u8* d = dst + skip;
+    usize remaining = n - skip;
+    if (n >= NON_TEMPORAL_THRESHOLD) {
+        for (; remaining > 4 * C; d += 4 * C, remaining -= 4 * C) {
+            for (usize i = 0; i < 4 * C; i += C) {
+                __builtin_nontemporal_store(value, reinterpret_cast<MemoryChunk*>(d + i));
+            }
+        }
+        __builtin_ia32_sfence();
+    } else {
+        for (; remaining > 4 * C; d += 4 * C, remaining -= 4 * C) {
+            for (usize i = 0; i < 4 * C; i += C) {
+                *reinterpret_cast<MemoryChunk*>(d + i) = value;
+            }
+        }
+    }
+    for (usize i = 4 * C; i != 0; i -= C) {
+        storeBytes<C>(dst + n - i, value);
+    }
 }
 
-static void memcpy512(void* dst, void const* src, usize length)
-{
-    while (length != 0) {
-        __builtin_memcpy_inline(dst, src, 64);
-        dst = PtrAdd(dst, 64);
-        src = PtrAdd(src, 64);
-        length--;
+[[clang::always_inline]] inline void fill(u8* dst, u8 c, usize n)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    if (n <= 16) {
+        u64 pattern = u64(c) * 0x0101010101010101;
+        if (n >= 8) {
+            __builtin_memcpy_inline(dst, &pattern, 8);
+            __builtin_memcpy_inline(dst + n - 8, &pattern, 8);
+        } else if (n >= 4) {
+            __builtin_memcpy_inline(dst, &pattern, 4);
+            __builtin_memcpy_inline(dst + n - 4, &pattern, 4);
+        } else if (n >= 2) {
+            __builtin_memcpy_inline(dst, &pattern, 2);
+            __builtin_memcpy_inline(dst + n - 2, &pattern, 2);
+        } else if (n == 1) {
+            *dst = c;
+        }
+        return;
+    }
+    MemoryChunk value = MemoryChunk{} + c;
+    if (n <= 32) {
+        auto half = __builtin_shufflevector(value, value, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        storeBytes<16>(dst, half);
+        storeBytes<16>(dst + n - 16, half);
+    } else if (n <= 4 * C) {
+        storeBytes<C>(dst, value);
+        storeBytes<C>(dst + n - C, value);
+        if (n > 2 * C) {
+            storeBytes<C>(dst + C, value);
+            storeBytes<C>(dst + n - (2 * C), value);
+        }
+    } else {
+        fillLarge(dst, value, n);
     }
 }
 
-static void memcpy256(void* dst, void const* src, usize length)
+///
+/// Returns the top bit of every byte of a chunk-sized vector comparison result, i.e. one bit per byte that matched.
+///
+[[clang::always_inline]] inline u32 byteMask(auto comparison)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 32);
-        dst = PtrAdd(dst, 32);
-        src = PtrAdd(src, 32);
-        length--;
-    }
-    memcpy512(dst, src, length / 2);
+    using Bytes = __attribute__((__vector_size__(MEMORY_CHUNK))) char;
+#if __AVX2__
+    return u32(__builtin_ia32_pmovmskb256(__builtin_bit_cast(Bytes, comparison)));
+#else
+    return u32(__builtin_ia32_pmovmskb128(__builtin_bit_cast(Bytes, comparison)));
+#endif
 }
 
-static void memcpy128(void* dst, void const* src, usize length)
+///
+/// Returns a bit mask of the characters in an aligned chunk that are 0, with one bit per byte (so sizeof(T) bits per
+/// character).
+///
+template<typename T>
+[[clang::always_inline]] inline u32 zeroCharMask(void const* chunk)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 16);
-        dst = PtrAdd(dst, 16);
-        src = PtrAdd(src, 16);
-        length--;
-    }
-    memcpy256(dst, src, length / 2);
+    using Lanes = __attribute__((__vector_size__(MEMORY_CHUNK))) T;
+    return byteMask(*static_cast<Lanes const*>(chunk) == Lanes{});
 }
 
-static void memcpy64(void* dst, void const* src, usize length)
+///
+/// Returns the length of a null-terminated string, but at most maxLength, checking a whole chunk of characters per
+/// step. The loads are aligned to the chunk size so that they never cross into another page, which makes it safe to
+/// read the bytes around the string (even before its start) that are in the same chunks; that is also why this opts
+/// out of AddressSanitizer.
+///
+template<typename T>
+[[clang::no_sanitize("address")]] inline usize terminatorIndex(T const* s, usize maxLength)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 8);
-        dst = PtrAdd(dst, 8);
-        src = PtrAdd(src, 8);
-        length--;
+    constexpr usize C = MEMORY_CHUNK;
+    if (maxLength == 0) {
+        return 0;
+    }
+    // Saturated, so that wcsnlen(s, SIZE_MAX) does not wrap around to a small limit
+    usize maxBytes = maxLength > ~usize(0) / sizeof(T) ? ~usize(0) : maxLength * sizeof(T);
+    usize offset = reinterpret_cast<usize>(s) & (C - 1);
+    auto* chunk = reinterpret_cast<u8 const*>(s) - offset;
+    u32 mask = zeroCharMask<T>(chunk) >> offset;
+    // Where the chunk in mask starts, in bytes from s
+    usize start = 0;
+    if (mask == 0) {
+        for (start = C - offset; start < maxBytes; start += C) {
+            chunk += C;
+            mask = zeroCharMask<T>(chunk);
+            if (mask != 0) {
+                break;
+            }
+        }
+        if (mask == 0) {
+            return maxLength;
+        }
     }
-    memcpy128(dst, src, length / 2);
+    usize index = (start + u32(__builtin_ctz(mask))) / sizeof(T);
+    return index < maxLength ? index : maxLength;
 }
 
-static void memcpy32(void* dst, void const* src, usize length)
+///
+/// Compares two null-terminated strings a chunk at a time. The two strings are rarely aligned the same way, so the
+/// loads are unaligned, and a chunk that would cross into the next page for either string is compared one character
+/// at a time instead.
+///
+[[clang::no_sanitize("address")]] inline int compareStrings(char const* s1, char const* s2)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 4);
-        dst = PtrAdd(dst, 4);
-        src = PtrAdd(src, 4);
-        length--;
+    constexpr usize C = MEMORY_CHUNK;
+    constexpr usize PAGE_SIZE = 4096;
+    auto nearPageEnd = [](char const* p) { return (reinterpret_cast<usize>(p) & (PAGE_SIZE - 1)) > PAGE_SIZE - C; };
+    while (true) {
+        if (nearPageEnd(s1) || nearPageEnd(s2)) {
+            for (usize i = 0; i < C; i++, s1++, s2++) {
+                if (*s1 != *s2 || *s1 == '\0') {
+                    return u8(*s1) - u8(*s2);
+                }
+            }
+            continue;
+        }
+        auto a = loadBytes<C>(s1);
+        auto b = loadBytes<C>(s2);
+        // Bytes that differ, or where both strings end
+        u32 mask = byteMask((a != b) | (a == MemoryChunk{}));
+        if (mask != 0) {
+            u32 i = u32(__builtin_ctz(mask));
+            return u8(s1[i]) - u8(s2[i]);
+        }
+        s1 += C;
+        s2 += C;
     }
-    memcpy64(dst, src, length / 2);
 }
 
-static void memcpy16(void* dst, void const* src, usize length)
+}  // namespace cm::impl
+
+extern "C" {
+
+constexpr void* memset(void* dst, int c, usize n)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 2);
-        dst = PtrAdd(dst, 2);
-        src = PtrAdd(src, 2);
-        length--;
+    if consteval {
+        auto* p = reinterpret_cast<u8*>(dst);
+        while (n-- != 0) {
+            *p++ = static_cast<u8>(c);
+        }
+    } else {
+        cm::impl::fill(reinterpret_cast<u8*>(dst), static_cast<u8>(c), n);
     }
-    memcpy32(dst, src, length / 2);
+    return dst;
 }
 
-static void memcpy8(void* dst, void const* src, usize length)
+constexpr void* memmove(void* pdst, void const* psrc, usize n)
 {
-    if (length % 2 != 0) {
-        __builtin_memcpy_inline(dst, src, 1);
-        dst = PtrAdd(dst, 1);
-        src = PtrAdd(src, 1);
-        length--;
+    auto dst = reinterpret_cast<u8*>(pdst);
+    auto src = reinterpret_cast<u8 const*>(psrc);
+    if consteval {
+        if (src < dst) {
+            for (dst += n, src += n; n--;) {
+                *--dst = *--src;
+            }
+        } else {
+            while (n--) {
+                *dst++ = *src++;
+            }
+        }
+    } else {
+        if (n <= 4 * cm::impl::MEMORY_CHUNK) {
+            cm::impl::copySmall(dst, src, n);
+        } else if (reinterpret_cast<usize>(dst) - reinterpret_cast<usize>(src) >= n) {
+            // dst is before src or after its end, so a copy from the front never overwrites what it is about to read
+            cm::impl::copyForward(dst, src, n);
+        } else {
+            cm::impl::copyBackward(dst, src, n);
+        }
     }
-    memcpy16(dst, src, length / 2);
+    return pdst;
 }
 
 constexpr void* memcpy(void* dst, void const* src, usize length)
@@ -143,12 +391,17 @@ constexpr void* memcpy(void* dst, void const* src, usize length)
         }
         return tmp;
     } else {
-        memcpy8(dst, src, length);
+        auto dstBytes = reinterpret_cast<u8*>(dst);
+        auto srcBytes = reinterpret_cast<u8 const*>(src);
+        if (length <= 4 * cm::impl::MEMORY_CHUNK) {
+            cm::impl::copySmall(dstBytes, srcBytes, length);
+        } else {
+            cm::impl::copyForward(dstBytes, srcBytes, length);
+        }
         return dst;
     }
 }
 
-
 ///
 ///---------------------------------------------------------------------------------------------------------------------------
 /// C STRING FUNCTIONS
@@ -157,18 +410,26 @@ constexpr void* memcpy(void* dst, void const* src, usize length)
 
 constexpr usize strlen(char const* s)
 {
-    usize len = 0;
-    while (*s++ != '\0') {
-        len++;
+    if consteval {
+        usize len = 0;
+        while (*s++ != '\0') {
+            len++;
+        }
+        return len;
+    } else {
+        return cm::impl::terminatorIndex(s, ~usize(0) / sizeof(char));
     }
-    return len;
 }
 
 constexpr int strcmp(char const* s1, char const* s2)
 {
-    for (; (*s1 != '\0') && (*s1 == *s2); s1++, s2++)
-        ;
-    return *s1 - *s2;
+    if consteval {
+        for (; (*s1 != '\0') && (*s1 == *s2); s1++, s2++)
+            ;
+        return u8(*s1) - u8(*s2);
+    } else {
+        return cm::impl::compareStrings(s1, s2);
+    }
 }
 
 //
@@ -243,24 +504,28 @@ constexpr char* strncpy(char* __restrict__ dest, char const* __restrict__ src, u
 constexpr usize wcslen(wchar_t const* start)
 {
     // NB: start is not checked for nullptr!
-    wchar_t const* end = start;
-    while (*end != L'\0')
-        ++end;
-
-    [[assume(end > start)]];
-    return usize(end - start);
+    if consteval {
+        wchar_t const* end = start;
+        while (*end != L'\0')
+            ++end;
+        return usize(end - start);
+    } else {
+        return cm::impl::terminatorIndex(start, ~usize(0) / sizeof(wchar_t));
+    }
 }
 
 constexpr usize wcsnlen(wchar_t const* start, usize n)
 {
-    wchar_t const* end = start;
-    while (*end != L'\0' && n != 0) {
-        ++end;
-        n--;
+    if consteval {
+        wchar_t const* end = start;
+        while (*end != L'\0' && n != 0) {
+            ++end;
+            n--;
+        }
+        return usize(end - start);
+    } else {
+        return cm::impl::terminatorIndex(start, n);
     }
-
-    [[assume(end > start)]];
-    return usize(end - start);
 }
 
 //
@@ -269,10 +534,14 @@ constexpr usize wcsnlen(wchar_t const* start, usize n)
 //
 constexpr usize strnlen(char const* s, __SIZE_TYPE__ len)
 {
-    usize i = 0;
-    for (; i < len && s[i] != '\0'; ++i)
-        ;
-    return i;
+    if consteval {
+        usize i = 0;
+        for (; i < len && s[i] != '\0'; ++i)
+            ;
+        return i;
+    } else {
+        return cm::impl::terminatorIndex(s, len);
+    }
 }
 
 
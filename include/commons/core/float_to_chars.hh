@@ -0,0 +1,575 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+
+namespace cm {
+
+///
+/// How toChars() lays out a floating-point number.
+///
+enum class FloatFormat : u8 {
+    /// Fixed notation if the decimal exponent is in [-4, 16), scientific notation otherwise, like Python's repr():
+    /// 0.1, 100.0, 0.0001, 1e-05, 1.5e+16. With a precision, it is the number of significant digits, and like printf's
+    /// %.*g the exponent must be in [-4, precision) for fixed notation: 123456 with a precision of 2 is 1.2e+05.
+    GENERAL,
+    /// Always fixed notation: 0.00001, 10000000000000000.0. With a precision, it is the number of digits after the
+    /// decimal point, like printf's %.*f.
+    FIXED,
+    /// Always scientific notation: 1e-05, 1.5e+16. With a precision, it is the number of digits after the decimal
+    /// point, like printf's %.*e.
+    SCIENTIFIC,
+};
+
+///
+/// The most characters toChars() writes for a float or double in the GENERAL format without a precision, e.g.
+/// "-2.2250738585072014e-308".
+///
+constexpr inline usize FLOAT_TO_CHARS_MAX_LENGTH = 24;
+
+///
+/// The largest precision toChars() honors; larger ones are clamped to it.
+///
+constexpr inline u32 MAX_FLOAT_PRECISION = 1100;
+
+namespace impl {
+
+///
+/// A decimal floating-point number: digits * 10^exponent.
+///
+struct DecimalFloat
+{
+    u64 digits;
+    i32 exponent;
+};
+
+// floor(log10(2^e)), floor(log10(3/4 * 2^e)) and floor(log2(10^e)), exact for the exponents of doubles.
+FORCEINLINE constexpr i32 floorLog10Pow2(i32 e) { return (e * 1262611) >> 22; }
+FORCEINLINE constexpr i32 floorLog10ThreeQuartersPow2(i32 e) { return ((e * 1262611) - 524031) >> 22; }
+FORCEINLINE constexpr i32 floorLog2Pow10(i32 e) { return (e * 1741647) >> 19; }
+
+///
+/// Returns floor(g * cp / 2^128) for a 128-bit g = {high, low}, with the bits shifted out folded into the lowest bit
+/// ("round to odd"), which keeps the comparisons of the result with multiples of 4 exact.
+///
+FORCEINLINE constexpr u64 roundToOdd(u64 const (&g)[2], u64 cp)
+{
+    u128 x = u128(g[1]) * cp;
+    u128 y = u128(g[0]) * cp;
+    u64 y0 = u64(y);
+    u64 z = y0 + u64(x >> 64);
+    u64 y1 = u64(y >> 64) + (z < y0 ? 1 : 0);
+    return y1 | (z > 1 ? 1 : 0);
+}
+
+///
+/// Finds the shortest decimal that reads back as c * 2^q, and among those the closest one (ties to even digits).
+/// This is Giulietti's Schubfach algorithm: the rounding interval of the value is scaled by a power of ten from a
+/// table, and at most two candidates are checked against it, without a loop or a big integer.
+/// @param lowerBoundaryIsCloser True if c is a power of two above the smallest normal number, where the gap to the
+/// next value below is half the gap to the next value above
+///
+constexpr DecimalFloat shortestDecimal(u64 c, i32 q, bool lowerBoundaryIsCloser)
+{
+    bool isEven = (c % 2) == 0;
+    u64 cbl = (4 * c) - 2 + (lowerBoundaryIsCloser ? 1 : 0);
+    u64 cb = 4 * c;
+    u64 cbr = (4 * c) + 2;
+
+    i32 k = lowerBoundaryIsCloser ? floorLog10ThreeQuartersPow2(q) : floorLog10Pow2(q);
+    i32 h = q + floorLog2Pow10(-k) + 1;
+    auto const& g = UNSAFE(Data::pow10Significands[-k - Data::POW10_SIGNIFICAND_MIN]);
+
+    u64 vbl = roundToOdd(g, cbl << h);
+    u64 vb = roundToOdd(g, cb << h);
+    u64 vbr = roundToOdd(g, cbr << h);
+    // The interval includes its boundaries only if they round to even
+    u64 lower = vbl + (isEven ? 0 : 1);
+    u64 upper = vbr - (isEven ? 0 : 1);
+
+    // One digit fewer, if exactly one of the two candidates is inside the interval
+    u64 s = vb / 4;
+    if (s >= 10) {
+        u64 sp = s / 10;
+        bool upInside = lower <= 40 * sp;
+        bool wpInside = (40 * sp) + 40 <= upper;
+        if (upInside != wpInside) {
+            return {sp + (wpInside ? 1 : 0), k + 1};
+        }
+    }
+    bool uInside = lower <= 4 * s;
+    bool wInside = (4 * s) + 4 <= upper;
+    if (uInside != wInside) {
+        return {s + (wInside ? 1 : 0), k};
+    }
+    // Both are inside: take the closer one
+    u64 mid = (4 * s) + 2;
+    bool roundUp = vb > mid || (vb == mid && (s & 1) != 0);
+    return {s + (roundUp ? 1 : 0), k};
+}
+
+FORCEINLINE constexpr DecimalFloat removeTrailingZeros(DecimalFloat d)
+{
+    while (d.digits % 100 == 0) {
+        d.digits /= 100;
+        d.exponent += 2;
+    }
+    if (d.digits % 10 == 0) {
+        d.digits /= 10;
+        d.exponent += 1;
+    }
+    return d;
+}
+
+///
+/// Splits a float or double into its sign and value = c * 2^q.
+///
+template<IsUnderlyingTypeOneOf<float, double> T>
+FORCEINLINE constexpr auto decomposeFloat(T value)
+{
+    using Bits = UintN<BITS<T>>;
+    constexpr u32 FRACTION_BITS = IsUnderlyingTypeOneOf<T, float> ? 23 : 52;
+    constexpr u32 EXPONENT_MASK = IsUnderlyingTypeOneOf<T, float> ? 0xFF : 0x7FF;
+    constexpr i32 BIAS = i32(EXPONENT_MASK >> 1) + i32(FRACTION_BITS);
+
+    auto bits = bit_cast<Bits>(value);
+    u64 fraction = u64(bits) & ((u64(1) << FRACTION_BITS) - 1);
+    u32 exponent = u32(bits >> FRACTION_BITS) & EXPONENT_MASK;
+    struct
+    {
+        u64 c;
+        i32 q;
+        bool negative;
+        bool lowerBoundaryIsCloser;
+    } result{fraction, 1 - BIAS, (bits >> (BITS<T> - 1)) != 0, false};
+    if (exponent != 0) {
+        result.c = fraction | (u64(1) << FRACTION_BITS);
+        result.q = i32(exponent) - BIAS;
+        result.lowerBoundaryIsCloser = fraction == 0 && exponent > 1;
+    }
+    return result;
+}
+
+///
+/// Just enough of an arbitrary-precision unsigned integer to compare a binary floating-point number with a decimal
+/// exactly, or to expand it into all of its digits. The largest numbers that come up are 2^53 * 5^1074 when formatting
+/// and a 768-digit decimal scaled by a power of two when parsing (parse_number.hh).
+///
+class BigUint {
+    constexpr static u32 MAX_LIMBS = 96;
+    u32 _limbs[MAX_LIMBS] = {};
+    u32 _size = 0;
+
+public:
+    constexpr explicit BigUint(u64 value)
+    {
+        for (; value != 0; value >>= 32) {
+            UNSAFE(_limbs[_size++] = u32(value));
+        }
+    }
+
+    constexpr bool isZero() const { return _size == 0; }
+
+    ///
+    /// Multiplies by factor, then adds addend.
+    ///
+    constexpr void multiply(u32 factor, u32 addend = 0)
+    {
+        UNSAFE_BEGIN;
+        u64 carry = addend;
+        for (u32 i = 0; i < _size; i++) {
+            u64 product = (u64(_limbs[i]) * factor) + carry;
+            _limbs[i] = u32(product);
+            carry = product >> 32;
+        }
+        if (carry != 0) {
+            Assert(_size < MAX_LIMBS, ASMS_BUG);
+            _limbs[_size++] = u32(carry);
+        }
+        UNSAFE_END;
+    }
+
+    constexpr void multiplyPow5(u32 e)
+    {
+        constexpr u32 POW5_13 = 1220703125;  // The largest power of 5 that fits in a limb
+        for (; e >= 13; e -= 13) {
+            multiply(POW5_13);
+        }
+        u32 factor = 1;
+        for (; e != 0; e--) {
+            factor *= 5;
+        }
+        multiply(factor);
+    }
+
+    constexpr void shiftLeft(u32 bits)
+    {
+        if (_size == 0) {
+            return;
+        }
+        UNSAFE_BEGIN;
+        u32 words = bits / 32;
+        u32 shift = bits % 32;
+        u32 size = _size + words + 1;
+        Assert(size <= MAX_LIMBS, ASMS_BUG);
+        // From the top down, so that every limb is read before it is overwritten
+        for (u32 i = size; i-- > 0;) {
+            u64 high = (i >= words && i - words < _size) ? _limbs[i - words] : 0;
+            u64 low = (i > words && i - words - 1 < _size) ? _limbs[i - words - 1] : 0;
+            _limbs[i] = shift == 0 ? u32(high) : u32((high << shift) | (low >> (32 - shift)));
+        }
+        _size = size;
+        while (_size > 0 && _limbs[_size - 1] == 0) {
+            _size--;
+        }
+        UNSAFE_END;
+    }
+
+    ///
+    /// Divides in place and returns the remainder.
+    ///
+    constexpr u32 divide(u32 divisor)
+    {
+        UNSAFE_BEGIN;
+        u64 remainder = 0;
+        for (u32 i = _size; i-- > 0;) {
+            u64 current = (remainder << 32) | _limbs[i];
+            _limbs[i] = u32(current / divisor);
+            remainder = current % divisor;
+        }
+        while (_size > 0 && _limbs[_size - 1] == 0) {
+            _size--;
+        }
+        return u32(remainder);
+        UNSAFE_END;
+    }
+
+    ///
+    /// Returns -1, 0 or 1 as a is less than, equal to or greater than b.
+    ///
+    constexpr static i32 compare(BigUint const& a, BigUint const& b)
+    {
+        if (a._size != b._size) {
+            return a._size < b._size ? -1 : 1;
+        }
+        UNSAFE_BEGIN;
+        for (u32 i = a._size; i-- > 0;) {
+            if (a._limbs[i] != b._limbs[i]) {
+                return a._limbs[i] < b._limbs[i] ? -1 : 1;
+            }
+        }
+        UNSAFE_END;
+        return 0;
+    }
+};
+
+///
+/// Returns the sign of c * 2^q - digits * 10^exponent, computed exactly.
+///
+constexpr i32 compareBinaryToDecimal(u64 c, i32 q, BigUint b, i32 exponent)
+{
+    BigUint a(c);
+    if (exponent >= 0) {
+        b.multiplyPow5(u32(exponent));
+    } else {
+        a.multiplyPow5(u32(-exponent));
+    }
+    if (q >= exponent) {
+        a.shiftLeft(u32(q - exponent));
+    } else {
+        b.shiftLeft(u32(exponent - q));
+    }
+    return BigUint::compare(a, b);
+}
+
+constexpr i32 compareBinaryToDecimal(u64 c, i32 q, u64 digits, i32 exponent)
+{
+    return compareBinaryToDecimal(c, q, BigUint(digits), exponent);
+}
+
+constexpr Optional<usize> copyChars(StringRef s, ArrayRef<char> buffer)
+{
+    if (s.length() > buffer.length()) {
+        return None;
+    }
+    for (usize i = 0; i < s.length(); i++) {
+        UNSAFE(const_cast<char*>(buffer.data())[i] = s.data()[i]);
+    }
+    return s.length();
+}
+
+///
+/// Returns how many significant digits a precision keeps.
+///
+FORCEINLINE constexpr i32 keptDigits(FloatFormat format, i32 point, i32 precision)
+{
+    switch (format) {
+    case FloatFormat::FIXED: return point + precision;
+    case FloatFormat::SCIENTIFIC: return precision + 1;
+    default: return max(precision, 1);
+    }
+}
+
+///
+/// Rounds the decimal 0.digits[0, n) * 10^point to its first `keep` digits, half to even, and drops the trailing
+/// zeros. The digits tell whether the value is above or below the midpoint between the two roundings, except when they
+/// end exactly on it (...5): then compareWithDigits() is asked for the sign of the value minus the digits.
+/// @return The new number of digits; point moves up by one if the digits carried all the way over (9.99 -> 10)
+///
+constexpr i32 roundDigits(char* digits, i32 n, i32& point, i32 keep, auto const& compareWithDigits)
+{
+    UNSAFE_BEGIN;
+    bool roundUp = false;
+    if (keep >= 0) {
+        char cut = digits[keep];
+        if (cut != '5' || keep + 1 < n) {
+            roundUp = cut >= '5';
+        } else {
+            i32 cmp = compareWithDigits();
+            roundUp = cmp > 0 || (cmp == 0 && keep > 0 && ((digits[keep - 1] - '0') & 1) != 0);
+        }
+    }
+    n = max(keep, 0);
+    if (roundUp) {
+        // The nines that carry over become trailing zeros, which are dropped below
+        i32 i = n - 1;
+        while (i >= 0 && digits[i] == '9') {
+            i--;
+        }
+        if (i >= 0) {
+            digits[i]++;
+            n = i + 1;
+        } else {
+            digits[0] = '1';
+            n = 1;
+            point++;
+        }
+    }
+    while (n > 0 && digits[n - 1] == '0') {
+        n--;
+    }
+    if (n == 0) {
+        digits[0] = '0';
+        n = 1;
+        point = 1;
+    }
+    return n;
+    UNSAFE_END;
+}
+
+///
+/// Writes the decimal 0.digits[0, n) * 10^point in a format, padding with zeros up to the precision.
+/// @param precision The precision, or -1 for as many digits as there are
+///
+constexpr Optional<usize> layoutDecimalFloat(
+    bool negative, char const* digits, i32 n, i32 point, ArrayRef<char> buffer, FloatFormat format, i32 precision)
+{
+    UNSAFE_BEGIN;
+    i32 exponent10 = point - 1;
+    // The exponent is the one after rounding to the precision, as with %g (9.99 at a precision of 2 is 10.0)
+    i32 fixedExponentLimit = precision >= 0 ? max(precision, 1) : 16;
+    bool scientific = format == FloatFormat::SCIENTIFIC ||
+                      (format == FloatFormat::GENERAL && (exponent10 < -4 || exponent10 >= fixedExponentLimit));
+    // Digits after the decimal point
+    i32 fraction;
+    if (scientific) {
+        fraction = (format == FloatFormat::SCIENTIFIC && precision >= 0) ? precision : n - 1;
+    } else {
+        fraction = (format == FloatFormat::FIXED && precision >= 0) ? precision : max(n - point, 1);
+    }
+
+    usize length = (negative ? 1 : 0) + usize(fraction > 0 ? fraction + 1 : 0);
+    if (scientific) {
+        length += 1 + 2 + ((exponent10 >= 100 || exponent10 <= -100) ? 3 : 2);
+    } else {
+        length += usize(max(point, 1));
+    }
+    if (length > buffer.length()) {
+        return None;
+    }
+
+    char* out = const_cast<char*>(buffer.data());
+    auto digitAt = [&](i32 i) { return (i >= 0 && i < n) ? digits[i] : '0'; };
+    if (negative) {
+        *out++ = '-';
+    }
+    if (scientific) {
+        *out++ = digits[0];
+        if (fraction > 0) {
+            *out++ = '.';
+            for (i32 i = 1; i <= fraction; i++) {
+                *out++ = digitAt(i);
+            }
+        }
+        *out++ = 'e';
+        *out++ = exponent10 < 0 ? '-' : '+';
+        u32 e = u32(exponent10 < 0 ? -exponent10 : exponent10);
+        if (e >= 100) {
+            *out++ = char('0' + (e / 100));
+            e %= 100;
+        }
+        *out++ = twoDigitTable[e * 2];
+        *out++ = twoDigitTable[(e * 2) + 1];
+    } else {
+        if (point <= 0) {
+            *out++ = '0';
+        }
+        for (i32 i = 0; i < point; i++) {
+            *out++ = digitAt(i);
+        }
+        if (fraction > 0) {
+            *out++ = '.';
+            for (i32 i = point; i < point + fraction; i++) {
+                *out++ = digitAt(i);
+            }
+        }
+    }
+    return length;
+    UNSAFE_END;
+}
+
+///
+/// The most significant digits the exact value of a double can have (c * 5^1074, for the subnormals).
+///
+constexpr inline i32 EXACT_DECIMAL_MAX_DIGITS = 768;
+
+///
+/// Writes every digit of the exact value of c * 2^q, without the trailing zeros, as 0.digits * 10^point.
+/// @return The number of digits
+///
+constexpr i32 exactDigits(u64 c, i32 q, char* digits, i32& point)
+{
+    UNSAFE_BEGIN;
+    // c * 2^q = m * 10^exponent
+    BigUint m(c);
+    i32 exponent = 0;
+    if (q >= 0) {
+        m.shiftLeft(u32(q));
+    } else {
+        m.multiplyPow5(u32(-q));
+        exponent = q;
+    }
+    // Nine digits at a time, least significant first
+    u32 chunks[(EXACT_DECIMAL_MAX_DIGITS / 9) + 1];
+    u32 count = 0;
+    while (!m.isZero()) {
+        chunks[count++] = m.divide(1'000'000'000);
+    }
+    i32 n = i32(digitCount<IntBaseFmt::B10>(chunks[count - 1]));
+    writeDigitsBackwards<IntBaseFmt::B10>(chunks[count - 1], digits + n);
+    for (u32 i = count - 1; i-- > 0;) {
+        memset(digits + n, '0', 9);
+        writeDigitsBackwards<IntBaseFmt::B10>(chunks[i], digits + n + 9);
+        n += 9;
+    }
+    point = n + exponent;
+    while (digits[n - 1] == '0') {
+        n--;
+    }
+    return n;
+    UNSAFE_END;
+}
+
+///
+/// The slow path of writeDecimalFloat(), for a precision that asks for more digits than the shortest representation
+/// has, which is not the exact value: the exact value is expanded in full and rounded.
+///
+[[clang::noinline]]
+constexpr Optional<usize> writeExactDecimalFloat(
+    bool negative, u64 c, i32 q, ArrayRef<char> buffer, FloatFormat format, i32 precision)
+{
+    char digits[EXACT_DECIMAL_MAX_DIGITS];
+    i32 point = 0;
+    i32 n = exactDigits(c, q, &digits[0], point);
+    i32 keep = keptDigits(format, point, precision);
+    if (keep < n) {
+        n = roundDigits(&digits[0], n, point, keep, [] { return 0; });
+    }
+    return layoutDecimalFloat(negative, &digits[0], n, point, buffer, format, precision);
+}
+
+///
+/// Writes the shortest decimal d of c * 2^q in a format.
+/// Rounding to fewer digits than the shortest starts from the shortest digits: any decimal between them and the exact
+/// value would be shorter still, so they round the same way as the exact value unless they end exactly on the midpoint,
+/// which is settled with an exact comparison. When as many digits as the shortest or more are wanted, the shortest
+/// digits are only used if they are the exact value (0.5, 3.25, integers, ...); otherwise the exact value is expanded.
+/// @param precision The precision, or -1 for the shortest digits
+///
+constexpr Optional<usize> writeDecimalFloat(
+    bool negative, DecimalFloat d, u64 c, i32 q, ArrayRef<char> buffer, FloatFormat format, i32 precision)
+{
+    UNSAFE_BEGIN;
+    char digits[20];
+    i32 n = i32(digitCount<IntBaseFmt::B10>(d.digits));
+    writeDigitsBackwards<IntBaseFmt::B10>(d.digits, digits + n);
+    // Zero is the digit "0" with the point after it
+    i32 point = n + d.exponent;
+
+    if (precision >= 0 && d.digits != 0) {
+        i32 keep = keptDigits(format, point, precision);
+        if (keep < n) {
+            n = roundDigits(digits, n, point, keep, [&] { return compareBinaryToDecimal(c, q, d.digits, d.exponent); });
+        } else if (compareBinaryToDecimal(c, q, d.digits, d.exponent) != 0) {
+            return writeExactDecimalFloat(negative, c, q, buffer, format, precision);
+        }
+    }
+    return layoutDecimalFloat(negative, digits, n, point, buffer, format, precision);
+    UNSAFE_END;
+}
+
+}  // namespace impl
+
+///
+/// Writes the text representation of a floating-point number (no null terminator) to the start of a buffer.
+/// Without a precision, the digits are the shortest that read back as exactly the same value (String::toDouble()
+/// parses them), e.g. 0.1 is written as "0.1" and not "0.1000000000000000055511151231257827". With a precision, the
+/// exact value is correctly rounded, like printf does. NaN and the infinities are written as "NaN", "inf" and "-inf".
+/// A long double is converted to double first.
+/// @param value The number
+/// @param buffer Where to write the characters; FLOAT_TO_CHARS_MAX_LENGTH is always enough in the GENERAL format
+/// without a precision
+/// @param format Fixed or scientific notation, or a choice of the two depending on the exponent
+/// @param precision The number of digits: see FloatFormat
+/// @return The number of characters written, or None if the buffer is too small (nothing is written then)
+///
+template<IsFloatingPoint T>
+constexpr Optional<usize> toChars(
+    T value, ArrayRef<char> buffer, FloatFormat format = FloatFormat::GENERAL, Optional<u32> precision = None)
+{
+    if constexpr (IsUnderlyingTypeOneOf<T, float, double>) {
+        if (__builtin_isnan(value)) {
+            return impl::copyChars("NaN", buffer);
+        }
+        if (__builtin_isinf(value)) {
+            return impl::copyChars(value < 0 ? StringRef("-inf") : StringRef("inf"), buffer);
+        }
+        auto [c, q, negative, lowerBoundaryIsCloser] = impl::decomposeFloat(value);
+        impl::DecimalFloat d{0, 0};
+        if (c != 0) {
+            d = impl::removeTrailingZeros(impl::shortestDecimal(c, q, lowerBoundaryIsCloser));
+        }
+        i32 p = precision.hasValue() ? i32(min(precision.val(), MAX_FLOAT_PRECISION)) : -1;
+        return impl::writeDecimalFloat(negative, d, c, q, buffer, format, p);
+    } else {
+        return toChars(double(value), buffer, format, precision);
+    }
+}
+
+}  // namespace cm
+#endif
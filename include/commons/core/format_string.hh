@@ -0,0 +1,184 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+
+namespace cm {
+
+namespace impl {
+// These are deliberately never defined and not constexpr: calling one while parsing a format string at compile time
+// turns the mistake into a compile error that names it.
+void moreArgumentsThanSpecifiedInFormatString();
+void fewerArgumentsThanSpecifiedInFormatString();
+}  // namespace impl
+
+///
+/// A format string literal, parsed at compile time into the literal text between its argument slots.
+/// Arguments are written where the format string has a backtick (`), and the number of backticks must match the
+/// number of arguments, which is checked at compile time:
+/// \code{.cpp}
+///     stdout.println("` + ` = `", 1, 2, 3);  // OK
+///     stdout.println("` + ` = `", 1, 2);     // Compile error: fewerArgumentsThanSpecifiedInFormatString
+/// \endcode
+/// Use FormatString<Args...> as the parameter type, so that Args is deduced from the other arguments only.
+///
+template<typename... Args>
+struct BasicFormatString
+{
+    constexpr static usize SLOTS = sizeof...(Args);
+    constexpr static char DELIMITER = '`';
+
+    template<usize N>
+    consteval BasicFormatString(char const (&str)[N])
+        : _chars(str)
+    {
+        usize slot = 0;
+        u32 begin = 0;
+        for (u32 i = 0; i + 1 < N; i++) {
+            if (str[i] == DELIMITER) {
+                if (slot == SLOTS) {
+                    impl::fewerArgumentsThanSpecifiedInFormatString();
+                }
+                _begin[slot] = begin;
+                _end[slot] = i;
+                slot++;
+                begin = i + 1;
+            }
+        }
+        if (slot != SLOTS) {
+            impl::moreArgumentsThanSpecifiedInFormatString();
+        }
+        _begin[SLOTS] = begin;
+        _end[SLOTS] = u32(N - 1);
+    }
+
+    ///
+    /// Returns the number of literal characters (everything but the slots).
+    ///
+    constexpr usize literalLength() const
+    {
+        usize n = 0;
+        for (usize i = 0; i <= SLOTS; i++) {
+            n += _end[i] - _begin[i];
+        }
+        return n;
+    }
+
+    ///
+    /// Walks the format string: calls literal(chars, length) for each run of literal text, and argument(arg) for
+    /// each argument in its slot. The loop over the slots is unrolled at compile time.
+    ///
+    template<typename... Ts>
+    FORCEINLINE constexpr void expand(auto const& literal, auto const& argument, Ts const&... args) const
+    {
+        static_assert(sizeof...(Ts) == SLOTS);
+        [[maybe_unused]] usize slot = 0;
+        _literal(literal, 0);
+        ((argument(args), _literal(literal, ++slot)), ...);
+    }
+
+private:
+    FORCEINLINE constexpr void _literal(auto const& literal, usize slot) const
+    {
+        if (_end[slot] != _begin[slot]) {
+            literal(UNSAFE(_chars + _begin[slot]), usize(_end[slot] - _begin[slot]));
+        }
+    }
+
+    char const* _chars;
+    u32 _begin[SLOTS + 1];
+    u32 _end[SLOTS + 1];
+};
+
+template<typename... Args>
+using FormatString = BasicFormatString<TypeIdentity<Args>...>;
+
+
+///
+/// Satisfied by types that can be viewed as a StringRef (StringRef itself, C strings, String).
+///
+template<typename T>
+concept IsStringLike =
+    IsUnderlyingTypeOneOf<T, StringRef, char*, char const*> || requires (T const& value) { value.operator StringRef(); };
+
+///
+/// Writes a formatted value by calling write(chars, length), without building a temporary String.
+/// Strings are written in one piece, numbers are formatted on the stack, and anything else goes through its
+/// outputString in chunks.
+///
+template<typename T>
+constexpr void writeFormatted(T const& value, auto const& write)
+{
+    if constexpr (IsUnderlyingTypeOneOf<T, char>) {
+        write(&value, 1);
+    } else if constexpr (IsInteger<T>) {
+        char buffer[TO_CHARS_MAX_LENGTH<T>];
+        write(&buffer[0], toChars(value, buffer).val());
+    } else if constexpr (IsFloatingPoint<T>) {
+        char buffer[FLOAT_TO_CHARS_MAX_LENGTH];
+        write(&buffer[0], toChars(value, ArrayRef<char>(buffer)).val());
+    } else if constexpr (IsStringLike<T>) {
+        StringRef s(value);
+        write(s.data(), s.length());
+    } else {
+        char buffer[64];
+        usize n = 0;
+        OutputString(value, [&](char c) {
+            if (n == sizeof(buffer)) {
+                write(&buffer[0], n);
+                n = 0;
+            }
+            UNSAFE(buffer[n++] = c);
+        });
+        write(&buffer[0], n);
+    }
+}
+
+template<usize N>
+constexpr void writeFormatted(char const (&str)[N], auto const& write)
+{
+    write(&str[0], N - 1);
+}
+
+///
+/// Returns a guess of how many characters writeFormatted() will write for a value, for sizing a buffer in advance.
+///
+template<typename T>
+constexpr usize formattedSizeHint(T const& value)
+{
+    if constexpr (IsUnderlyingTypeOneOf<T, char>) {
+        return 1;
+    } else if constexpr (IsInteger<T>) {
+        return toCharsLength(value);
+    } else if constexpr (IsFloatingPoint<T>) {
+        return FLOAT_TO_CHARS_MAX_LENGTH;
+    } else if constexpr (IsStringLike<T>) {
+        return StringRef(value).length();
+    } else {
+        return 0;
+    }
+}
+
+template<usize N>
+constexpr usize formattedSizeHint(char const (&)[N])
+{
+    return N - 1;
+}
+
+}  // namespace cm
+#endif
@@ -17,6 +17,8 @@
 #else
 // clang-format off
 #include HEADER(core/hashers/crc32_hasher.hh)
+#include HEADER(core/hashers/wyhash_hasher.hh)
+#include HEADER(core/hashers/xxh3_hasher.hh)
 // clang-format on
 
 
@@ -66,13 +68,13 @@ struct Hash
         }
     }
 
-    constexpr static auto hashData(void const* mem, usize sizeBytes, SeedType seed = DEFAULT_SEED) UNSAFE({
-        auto* bytes = static_cast<u8 const*>(mem);
-        for (usize i = {}; i < sizeBytes; i += usize(1)) {
-            seed = hash(bytes[size_t(i)], seed);
-        };
-        return seed;
-    });
+    ///
+    /// Hashes a buffer as a sequence of bytes.
+    ///
+    constexpr static auto hashData(void const* mem, usize sizeBytes, SeedType seed = DEFAULT_SEED)
+    {
+        return Hasher::hashBytes(static_cast<u8 const*>(mem), sizeBytes, seed);
+    }
 
 private:
     template<typename T>
@@ -84,6 +86,86 @@ private:
     });
 };
 
+///
+/// Hashes data that is given in pieces (read from a stream, or the fields of a struct) without copying it into one
+/// buffer first. The result is the same as Hash<Hasher>::hashData on all the bytes given to update(), in order, so a
+/// single integer or string given to update() also hashes the same as Hash<Hasher>::hash of it.
+///
+template<typename Hasher>
+class HashState
+{
+public:
+    using HashResult = Hasher::HashResult;
+    using SeedType = Hasher::SeedType;
+
+    constexpr explicit HashState(SeedType seed = Hasher::DEFAULT_SEED)
+        : _state(seed)
+    {}
+
+    ///
+    /// Adds a sequence of bytes.
+    ///
+    constexpr HashState& update(ArrayRef<u8> bytes)
+    {
+        _state.update(bytes.data(), bytes.length());
+        return *this;
+    }
+
+    ///
+    /// Adds a buffer as a sequence of bytes.
+    ///
+    HashState& update(void const* data, usize sizeBytes)
+    {
+        _state.update(static_cast<u8 const*>(data), sizeBytes);
+        return *this;
+    }
+
+    ///
+    /// Adds the characters of a string and its null terminator: the same bytes as StringRef::hash, so that a string
+    /// given alone hashes like Hash<Hasher>::hash of it. The terminator keeps ("ab", "c") and ("a", "bc") apart.
+    ///
+    constexpr HashState& update(StringRef str)
+    {
+        _state.update(str.data(), str.ArrayRef<char>::length());
+        return *this;
+    }
+
+    ///
+    /// Adds the little-endian bytes of a primitive value (floating point values as their bit pattern).
+    ///
+    template<typename T>
+    requires (!IsClass<T> && !IsPointer<T>)
+    constexpr HashState& update(T value)
+    {
+        u64 bits;
+        if constexpr (sizeof(T) == 1) {
+            bits = bit_cast<u8>(value);
+        } else if constexpr (sizeof(T) == 2) {
+            bits = bit_cast<u16>(value);
+        } else if constexpr (sizeof(T) == 4) {
+            bits = bit_cast<u32>(value);
+        } else if constexpr (sizeof(T) == 8) {
+            bits = bit_cast<u64>(value);
+        } else {
+            static_assert(false, "Unable to hash primitive type");
+        }
+        u8 bytes[sizeof(T)];
+        for (usize i = 0; i < sizeof(T); i++) {
+            bytes[i] = u8(bits >> (8 * i));
+        }
+        _state.update(bytes, sizeof(T));
+        return *this;
+    }
+
+    ///
+    /// Returns the hash of everything added so far. More data can still be added afterwards.
+    ///
+    NODISCARD constexpr HashResult finalize() const { return _state.finalize(); }
+
+private:
+    Hasher::State _state;
+};
+
 using DefaultHasher = Hash<Crc32>;
 
 }  // namespace cm
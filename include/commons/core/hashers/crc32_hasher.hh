@@ -43,12 +43,37 @@ struct Crc32
         return tbl;
     }
 
+    ///
+    /// The slicing-by-8 tables: slicingTables()[k][b] is the CRC of byte b followed by k zero bytes (starting from 0),
+    /// so that 8 bytes are folded into the CRC with 8 independent lookups instead of a chain of 8.
+    ///
+    constexpr static auto const& slicingTables()
+    {
+        struct Tables
+        {
+            u32 t[8][256];
+        };
+        constexpr static Tables tbl = [] {
+            Tables r{};
+            for (u32 b = 0; b < 256; b++) {
+                r.t[0][b] = table()[b];
+            }
+            for (u32 k = 1; k < 8; k++) {
+                for (u32 b = 0; b < 256; b++) {
+                    r.t[k][b] = (r.t[k - 1][b] >> 8u) ^ r.t[0][r.t[k - 1][b] & 0xffu];
+                }
+            }
+            return r;
+        }();
+        return tbl.t;
+    }
+
     ///
     /// Hashes an 8-bit input. Uses hardware features if possible.
     ///
     constexpr static u32 hash8(u8 value, u32 seed) noexcept
     {
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         if consteval
 #endif
         {
@@ -56,12 +81,12 @@ struct Crc32
             auto const hash = seed;
             return tbl[(hash ^ value) & 0xffu] ^ (hash >> 8u);
         }
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         else {
-#if __x86_64__
+#if __SSE4_2__
             return static_cast<u32>(__builtin_ia32_crc32qi(seed, value));
 
-#elif __aarch64__
+#elif __ARM_FEATURE_CRC32
             return static_cast<u32>(__crc32cb(seed, value));
 #endif
         }
@@ -73,7 +98,7 @@ struct Crc32
     ///
     constexpr static u32 hash16(u16 value, u32 seed) noexcept
     {
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         if consteval
 #endif
         {
@@ -82,11 +107,11 @@ struct Crc32
             seed = tbl[(seed ^ bit_cast<VectorU8x<2>>(value)[1]) & 0xffu] ^ (seed >> 8u);
             return seed;
         }
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         else {
-#if __x86_64__
+#if __SSE4_2__
             return static_cast<u32>(__builtin_ia32_crc32hi(seed, value));
-#elif __aarch64__
+#elif __ARM_FEATURE_CRC32
             return static_cast<u32>(__crc32ch(seed, value));
 #endif
         }
@@ -98,7 +123,7 @@ struct Crc32
     ///
     constexpr static u32 hash32(u32 value, u32 seed) noexcept
     {
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         if consteval
 #endif
         {
@@ -109,12 +134,12 @@ struct Crc32
             seed = tbl[(seed ^ bit_cast<VectorU8x<4>>(value)[3]) & 0xffu] ^ (seed >> 8u);
             return seed;
         }
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         else {
-#if __x86_64__
+#if __SSE4_2__
             return static_cast<u32>(__builtin_ia32_crc32si(seed, value));
 
-#elif __aarch64__
+#elif __ARM_FEATURE_CRC32
             return static_cast<u32>(__crc32cw(seed, value));
 #endif
         }
@@ -126,7 +151,7 @@ struct Crc32
     ///
     constexpr static u32 hash64(u64 value, u32 seed) noexcept
     {
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         if consteval
 #endif
         {
@@ -141,12 +166,12 @@ struct Crc32
             seed = tbl[(seed ^ bit_cast<VectorU8x<8>>(value)[7]) & 0xffu] ^ (seed >> 8u);
             return seed;
         }
-#if (__x86_64__ || __aarch64__)
+#if (__SSE4_2__ || __ARM_FEATURE_CRC32)
         else {
-#if __x86_64__
+#if __SSE4_2__
             return static_cast<u32>(__builtin_ia32_crc32di(seed, value));
 
-#elif __aarch64__
+#elif __ARM_FEATURE_CRC32
             return static_cast<u32>(__crc32cd(seed, value));
 #endif
         }
@@ -154,11 +179,17 @@ struct Crc32
     }
 
     ///
-    /// Hashes a char string.
+    /// Hashes a char string, including its null terminator.
     ///
     template<typename T>
     constexpr static u32 hashCString(T const* in, u32 seed)
     {
+        if constexpr (sizeof(T) == 1) {
+            if !consteval {
+                UNSAFE(return hashBytes(reinterpret_cast<u8 const*>(in), strlen(reinterpret_cast<char const*>(in)) + 1,
+                    seed));
+            }
+        }
         do {
             static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
             if constexpr (sizeof(T) == 1) {
@@ -172,13 +203,148 @@ struct Crc32
         return seed;
     }
 
-    constexpr static u32 hashBytes(u8 const* in, u32 length, u32 seed)
+    ///
+    /// Hashes a buffer. The result is the same as hashing its bytes one at a time with hash8, but long buffers are
+    /// hashed 8 bytes per instruction, in three interleaved streams when the target has carry-less multiplication.
+    /// Takes any 1-byte type, so that char strings can also be hashed in constant evaluation.
+    ///
+    template<typename T>
+    requires (sizeof(T) == 1)
+    constexpr static u32 hashBytes(T const* in, usize length, u32 seed)
+    {
+#if __SSE4_2__
+        if !consteval {
+            return _hashBytesHardware(UNSAFE(reinterpret_cast<u8 const*>(in)), length, seed);
+        }
+#endif
+        return _hashBytesPortable(in, length, seed);
+    }
+
+    ///
+    /// Hashes a buffer that is given in pieces. The CRC is its own state, so each piece just continues from it.
+    ///
+    class State
+    {
+        u32 _crc;
+
+    public:
+        constexpr explicit State(u32 seed)
+            : _crc(seed)
+        {}
+
+        template<typename T>
+        requires (sizeof(T) == 1)
+        constexpr void update(T const* in, usize length)
+        {
+            _crc = hashBytes(in, length, _crc);
+        }
+
+        constexpr u32 finalize() const { return _crc; }
+    };
+
+private:
+    UNSAFE_BEGIN;
+
+    template<typename T>
+    constexpr static u32 _hashBytesPortable(T const* in, usize length, u32 seed)
     {
-        while (length-- != 0) {
-            seed = hash8(*in, seed);
+        auto const& t = slicingTables();
+        for (; length >= 8; in += 8, length -= 8) {
+            u64 v = seed;
+            for (u32 i = 0; i < 8; i++) {
+                v ^= u64(u8(in[i])) << (8 * i);
+            }
+            seed = t[7][v & 0xffu] ^ t[6][(v >> 8) & 0xffu] ^ t[5][(v >> 16) & 0xffu] ^ t[4][(v >> 24) & 0xffu] ^
+                   t[3][(v >> 32) & 0xffu] ^ t[2][(v >> 40) & 0xffu] ^ t[1][(v >> 48) & 0xffu] ^ t[0][v >> 56];
+        }
+        for (; length != 0; in++, length--) {
+            seed = t[0][(seed ^ u8(*in)) & 0xffu] ^ (seed >> 8u);
         }
         return seed;
     }
+
+#if __SSE4_2__
+    ///
+    /// Each of the three streams of an interleaved round covers a block of this many bytes. The crc32 instruction has
+    /// a latency of 3 cycles but a throughput of 1, so three independent streams keep it busy. Long buffers use long
+    /// blocks, so the cost of combining the streams is spread over more bytes, and the rest goes through short ones.
+    ///
+    constexpr static usize LONG_BLOCK = 2048;
+    constexpr static usize SHORT_BLOCK = 256;
+
+    FORCEINLINE static u64 _load64(u8 const* p)
+    {
+        u64 v;
+        __builtin_memcpy(&v, p, 8);
+        return v;
+    }
+
+    static u32 _hashBytesHardware(u8 const* in, usize length, u32 seed)
+    {
+#if __PCLMUL__
+        _hashInterleaved<LONG_BLOCK>(in, length, seed);
+        _hashInterleaved<SHORT_BLOCK>(in, length, seed);
+#endif
+        for (; length >= 8; in += 8, length -= 8) {
+            seed = u32(__builtin_ia32_crc32di(seed, _load64(in)));
+        }
+        if (length >= 4) {
+            u32 v;
+            __builtin_memcpy(&v, in, 4);
+            seed = __builtin_ia32_crc32si(seed, v);
+            in += 4;
+            length -= 4;
+        }
+        for (; length != 0; in++, length--) {
+            seed = __builtin_ia32_crc32qi(seed, *in);
+        }
+        return seed;
+    }
+
+#if __PCLMUL__
+    ///
+    /// Returns x^(8n - 33) mod P (bit-reflected, like the CRC itself). The carry-less product of a CRC with it, reduced
+    /// by a crc32 of the product, is the CRC extended by n zero bytes: the product is one degree short of aligned, and
+    /// the crc32 multiplies by x^32, which together make up the other 33.
+    ///
+    consteval static u32 _zeroBytesMultiplier(usize n)
+    {
+        u32 r = 0x80000000u;  // x^0
+        for (usize i = 0; i < (8 * n) - 33; i++) {
+            r = (r & 1) ? (r >> 1) ^ 0x82F63B78u : r >> 1;
+        }
+        return r;
+    }
+
+    ///
+    /// Hashes rounds of 3 * BLOCK bytes, each as three independent streams. Since the CRC is linear,
+    /// crc(seed, A B C) = shift(shift(crc(seed, A)) ^ crc(0, B)) ^ crc(0, C), where shift appends BLOCK zero bytes.
+    ///
+    template<usize BLOCK>
+    static void _hashInterleaved(u8 const*& in, usize& length, u32& seed)
+    {
+        using U64x2 = __attribute__((__vector_size__(16))) long long;
+        constexpr u32 SHIFT = _zeroBytesMultiplier(BLOCK);
+        auto shift = [](u32 crc) {
+            U64x2 product = __builtin_ia32_pclmulqdq128(U64x2{i64(crc), 0}, U64x2{i64(SHIFT), 0}, 0x00);
+            return u32(__builtin_ia32_crc32di(0, u64(product[0])));
+        };
+        for (; length >= 3 * BLOCK; in += 3 * BLOCK, length -= 3 * BLOCK) {
+            u64 a = seed;
+            u64 b = 0;
+            u64 c = 0;
+            for (usize i = 0; i < BLOCK; i += 8) {
+                a = __builtin_ia32_crc32di(a, _load64(in + i));
+                b = __builtin_ia32_crc32di(b, _load64(in + BLOCK + i));
+                c = __builtin_ia32_crc32di(c, _load64(in + (2 * BLOCK) + i));
+            }
+            seed = shift(shift(u32(a)) ^ u32(b)) ^ u32(c);
+        }
+    }
+#endif
+#endif
+
+    UNSAFE_END;
 };
 
 
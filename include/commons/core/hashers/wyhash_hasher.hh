@@ -0,0 +1,277 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifdef __inline_core_header__
+
+
+namespace cm {
+
+namespace impl {
+
+///
+/// Reads N (at most 8) bytes as a little-endian integer. Written as a byte loop so that it also works in constant
+/// evaluation; at runtime the compiler turns it into a single load.
+///
+template<usize N, typename T>
+[[clang::always_inline]] constexpr u64 readLittleEndian(T const* p)
+{
+    static_assert(sizeof(T) == 1 && N <= 8);
+    u64 v = 0;
+    for (usize i = 0; i < N; i++) {
+        v |= u64(u8(UNSAFE(p[i]))) << (8 * i);
+    }
+    return v;
+}
+
+///
+/// Multiplies two 64-bit integers into their 128-bit product, returned as its low (in a) and high (in b) halves.
+///
+[[clang::always_inline]] constexpr void multiplyFull(u64& a, u64& b)
+{
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    a = u64(r);
+    b = u64(r >> 64);
+}
+
+///
+/// Returns the xor of the low and high halves of the 128-bit product of two 64-bit integers.
+///
+[[clang::always_inline]] constexpr u64 multiplyFold(u64 a, u64 b)
+{
+    multiplyFull(a, b);
+    return a ^ b;
+}
+
+}  // namespace impl
+
+
+///
+/// A 64-bit hasher after wyhash (final version 4): the input is read in 8-byte words, and each pair of words is mixed
+/// by a 64 x 64 -> 128-bit multiplication whose halves are folded together. Keys of up to 16 bytes take one such
+/// multiplication plus the finalization, which makes it the best fit for short keys (integers, identifiers, words).
+/// hash8/16/32/64 give the same result as hashBytes on the little-endian bytes of the value.
+///
+struct WyHash
+{
+    constexpr static u64 DEFAULT_SEED = 0;
+    using SeedType = u64;
+    using HashResult = u64;
+
+    constexpr static u64 SECRET[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+        0x589965cc75374cc3ull};
+
+    constexpr static u64 hash8(u8 value, u64 seed) noexcept
+    {
+        u64 a = (u64(value) << 16) | (u64(value) << 8) | value;
+        return _finish(a, 0, 1, _start(seed));
+    }
+
+    constexpr static u64 hash16(u16 value, u64 seed) noexcept
+    {
+        u64 a = (u64(value & 0xffu) << 16) | (u64(value >> 8) << 8) | (value >> 8);
+        return _finish(a, 0, 2, _start(seed));
+    }
+
+    constexpr static u64 hash32(u32 value, u64 seed) noexcept
+    {
+        u64 a = (u64(value) << 32) | value;
+        return _finish(a, a, 4, _start(seed));
+    }
+
+    constexpr static u64 hash64(u64 value, u64 seed) noexcept
+    {
+        u64 low = value & 0xffffffffu;
+        u64 high = value >> 32;
+        return _finish((low << 32) | high, (high << 32) | low, 8, _start(seed));
+    }
+
+    ///
+    /// Hashes a char string, including its null terminator. Strings of wider characters are hashed one character at a
+    /// time.
+    ///
+    template<typename T>
+    constexpr static u64 hashCString(T const* in, u64 seed)
+    {
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+        if constexpr (sizeof(T) == 1) {
+            return hashBytes(in, CArrays::stringLen(in) + 1, seed);
+        } else {
+            UNSAFE_BEGIN;
+            do {
+                seed = sizeof(T) == 2 ? hash16(u16(*in), seed) : hash32(u32(*in), seed);
+            } while (*in++);
+            return seed;
+            UNSAFE_END;
+        }
+    }
+
+    ///
+    /// Hashes a buffer of bytes (of any 1-byte type, so that char strings can also be hashed in constant evaluation).
+    ///
+    template<typename T>
+    requires (sizeof(T) == 1)
+    constexpr static u64 hashBytes(T const* p, usize length, u64 seed)
+    {
+        using impl::readLittleEndian;
+        UNSAFE_BEGIN;
+        seed = _start(seed);
+        u64 a = 0;
+        u64 b = 0;
+        if (length <= 16) [[likely]] {
+            if (length >= 4) {
+                // Two overlapping pairs of 4-byte words cover 4 to 16 bytes
+                usize middle = (length >> 3) << 2;
+                a = (readLittleEndian<4>(p) << 32) | readLittleEndian<4>(p + middle);
+                b = (readLittleEndian<4>(p + length - 4) << 32) | readLittleEndian<4>(p + length - 4 - middle);
+            } else if (length > 0) {
+                a = (u64(u8(p[0])) << 16) | (u64(u8(p[length >> 1])) << 8) | u8(p[length - 1]);
+            }
+        } else {
+            usize i = length;
+            if (i > 48) {
+                u64 seed1 = seed;
+                u64 seed2 = seed;
+                do {
+                    _mix48(p, seed, seed1, seed2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            _mixTail(p, i, a, b, seed);
+        }
+        return _finish(a, b, length, seed);
+        UNSAFE_END;
+    }
+
+    ///
+    /// Hashes a buffer that is given in pieces, with the same result as hashBytes on all the pieces put together.
+    /// The 48-byte rounds are taken as soon as it is known that more input follows them; up to 48 bytes, plus the 16
+    /// before them that the last read may overlap, are kept until finalize().
+    ///
+    class State
+    {
+        u8 _buffer[64] = {};
+        // The pending bytes start at _buffer + 16; the 16 bytes before them are the last ones of the previous round
+        usize _pending = 0;
+        usize _length = 0;
+        u64 _seedArg;
+        u64 _seed;
+        u64 _seed1;
+        u64 _seed2;
+
+    public:
+        constexpr explicit State(u64 seed)
+            : _seedArg(seed), _seed(_start(seed)), _seed1(_seed), _seed2(_seed)
+        {}
+
+        template<typename T>
+        requires (sizeof(T) == 1)
+        constexpr void update(T const* p, usize length)
+        {
+            UNSAFE_BEGIN;
+            _length += length;
+            while (length > 0) {
+                if (_pending == 48) {
+                    _mix48(_buffer + 16, _seed, _seed1, _seed2);
+                    _copy(_buffer, _buffer + 48, 16);
+                    _pending = 0;
+                }
+                if (_pending == 0 && length > 48) {
+                    do {
+                        _mix48(p, _seed, _seed1, _seed2);
+                        p += 48;
+                        length -= 48;
+                    } while (length > 48);
+                    _copy(_buffer, p - 16, 16);
+                }
+                usize n = min(48 - _pending, length);
+                _copy(_buffer + 16 + _pending, p, n);
+                _pending += n;
+                p += n;
+                length -= n;
+            }
+            UNSAFE_END;
+        }
+
+        constexpr u64 finalize() const
+        {
+            if (_length <= 48) {
+                return hashBytes(UNSAFE(_buffer + 16), _length, _seedArg);
+            }
+            u64 seed = _seed ^ _seed1 ^ _seed2;
+            u64 a, b;
+            _mixTail(UNSAFE(_buffer + 16), _pending, a, b, seed);
+            return _finish(a, b, _length, seed);
+        }
+
+    private:
+        template<typename T>
+        constexpr static void _copy(u8* to, T const* from, usize n)
+        {
+            for (usize i = 0; i < n; i++) {
+                UNSAFE(to[i] = u8(from[i]));
+            }
+        }
+    };
+
+private:
+    constexpr static u64 _start(u64 seed) { return seed ^ impl::multiplyFold(seed ^ SECRET[0], SECRET[1]); }
+
+    ///
+    /// Mixes 48 bytes into three independent lanes.
+    ///
+    template<typename T>
+    [[clang::always_inline]] constexpr static void _mix48(T const* p, u64& seed, u64& seed1, u64& seed2)
+    {
+        using impl::readLittleEndian;
+        UNSAFE_BEGIN;
+        seed = impl::multiplyFold(readLittleEndian<8>(p) ^ SECRET[1], readLittleEndian<8>(p + 8) ^ seed);
+        seed1 = impl::multiplyFold(readLittleEndian<8>(p + 16) ^ SECRET[2], readLittleEndian<8>(p + 24) ^ seed1);
+        seed2 = impl::multiplyFold(readLittleEndian<8>(p + 32) ^ SECRET[3], readLittleEndian<8>(p + 40) ^ seed2);
+        UNSAFE_END;
+    }
+
+    ///
+    /// Mixes the last 1 to 48 bytes of an input longer than 16 bytes 16 at a time, and reads its last 16 bytes into a
+    /// and b. The last read can start before p, so at least 16 bytes of the input must precede p + i.
+    ///
+    template<typename T>
+    constexpr static void _mixTail(T const* p, usize i, u64& a, u64& b, u64& seed)
+    {
+        using impl::readLittleEndian;
+        UNSAFE_BEGIN;
+        while (i > 16) {
+            seed = impl::multiplyFold(readLittleEndian<8>(p) ^ SECRET[1], readLittleEndian<8>(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = readLittleEndian<8>(p + i - 16);
+        b = readLittleEndian<8>(p + i - 8);
+        UNSAFE_END;
+    }
+
+    constexpr static u64 _finish(u64 a, u64 b, usize length, u64 seed)
+    {
+        a ^= SECRET[1];
+        b ^= seed;
+        impl::multiplyFull(a, b);
+        return impl::multiplyFold(a ^ SECRET[0] ^ length, b ^ SECRET[1]);
+    }
+};
+
+
+}  // namespace cm
+#endif
@@ -0,0 +1,280 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifdef __inline_core_header__
+
+
+namespace cm {
+
+
+///
+/// A 64-bit hasher after XXH3, for long keys (file contents, network payloads, large strings). Inputs of at least
+/// LONG_INPUT bytes are consumed in 64-byte stripes by 8 independent 64-bit accumulators, each of which adds one word
+/// of the input and the 32 x 32 -> 64-bit product of the halves of that word xor-ed with a secret; the loops have no
+/// dependency between the lanes, so the compiler turns them into SIMD. Every 1 KB, the accumulators are scrambled,
+/// and at the end they are merged with 128-bit multiplications.
+/// Shorter inputs, and hash8/16/32/64, are hashed like WyHash, which is faster for them.
+///
+/// The 192-byte secret is generated by SplitMix64 instead of being XXH3's, so the results differ from XXH3's.
+///
+struct Xxh3
+{
+    constexpr static u64 DEFAULT_SEED = 0;
+    using SeedType = u64;
+    using HashResult = u64;
+
+    constexpr static usize LONG_INPUT = 256;
+
+    constexpr static u64 hash8(u8 value, u64 seed) noexcept { return WyHash::hash8(value, seed); }
+    constexpr static u64 hash16(u16 value, u64 seed) noexcept { return WyHash::hash16(value, seed); }
+    constexpr static u64 hash32(u32 value, u64 seed) noexcept { return WyHash::hash32(value, seed); }
+    constexpr static u64 hash64(u64 value, u64 seed) noexcept { return WyHash::hash64(value, seed); }
+
+    ///
+    /// Hashes a char string, including its null terminator. Strings of wider characters are hashed one character at a
+    /// time.
+    ///
+    template<typename T>
+    constexpr static u64 hashCString(T const* in, u64 seed)
+    {
+        if constexpr (sizeof(T) == 1) {
+            return hashBytes(in, CArrays::stringLen(in) + 1, seed);
+        } else {
+            return WyHash::hashCString(in, seed);
+        }
+    }
+
+    ///
+    /// Hashes a buffer of bytes (of any 1-byte type, so that char strings can also be hashed in constant evaluation).
+    ///
+    template<typename T>
+    requires (sizeof(T) == 1)
+    constexpr static u64 hashBytes(T const* p, usize length, u64 seed)
+    {
+        if (length < LONG_INPUT) {
+            return WyHash::hashBytes(p, length, seed);
+        }
+        return _hashLong(p, length, seed);
+    }
+
+private:
+    constexpr static usize SECRET_SIZE = 192;
+    constexpr static usize STRIPE = 64;
+    constexpr static usize STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE) / 8;
+
+    constexpr static u64 PRIME32_1 = 0x9E3779B1u;
+    constexpr static u64 PRIME32_2 = 0x85EBCA77u;
+    constexpr static u64 PRIME32_3 = 0xC2B2AE3Du;
+    constexpr static u64 PRIME64_1 = 0x9E3779B185EBCA87ull;
+    constexpr static u64 PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr static u64 PRIME64_3 = 0x165667B19E3779F9ull;
+    constexpr static u64 PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+    constexpr static u64 PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+    struct Secret
+    {
+        u8 bytes[SECRET_SIZE];
+    };
+
+    constexpr static Secret SECRET = [] {
+        Secret s{};
+        u64 state = 0x243F6A8885A308D3ull;
+        for (usize i = 0; i < SECRET_SIZE; i += 8) {
+            state += 0x9E3779B97F4A7C15ull;
+            u64 z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            for (usize k = 0; k < 8; k++) {
+                s.bytes[i + k] = u8(z >> (8 * k));
+            }
+        }
+        return s;
+    }();
+
+    ///
+    /// Adds one 64-byte stripe into the accumulators.
+    ///
+    template<typename T>
+    [[clang::always_inline]] constexpr static void _accumulate(u64 (&acc)[8], T const* p, u8 const* secret)
+    {
+        using impl::readLittleEndian;
+        for (usize i = 0; i < 8; i++) {
+            u64 value = readLittleEndian<8>(UNSAFE(p + (8 * i)));
+            u64 key = value ^ readLittleEndian<8>(UNSAFE(secret + (8 * i)));
+            UNSAFE(acc[i ^ 1] += value);
+            UNSAFE(acc[i] += (key & 0xffffffffu) * (key >> 32));
+        }
+    }
+
+    ///
+    /// Writes the secret with the seed folded into it: added to the even words, subtracted from the odd ones.
+    ///
+    constexpr static void _seedSecret(u8 (&secret)[SECRET_SIZE], u64 seed)
+    {
+        for (usize i = 0; i < SECRET_SIZE; i += 8) {
+            u64 word = impl::readLittleEndian<8>(UNSAFE(SECRET.bytes + i)) + ((i % 16) == 0 ? seed : -seed);
+            for (usize k = 0; k < 8; k++) {
+                UNSAFE(secret[i + k] = u8(word >> (8 * k)));
+            }
+        }
+    }
+
+    ///
+    /// Adds the stripe with the given index into the accumulators, and scrambles them after the last stripe of a block.
+    ///
+    template<typename T>
+    [[clang::always_inline]] constexpr static void _consumeStripe(u64 (&acc)[8], T const* p, u8 const* secret,
+        usize index)
+    {
+        _accumulate(acc, p, UNSAFE(secret + ((index % STRIPES_PER_BLOCK) * 8)));
+        if ((index % STRIPES_PER_BLOCK) == STRIPES_PER_BLOCK - 1) {
+            for (usize i = 0; i < 8; i++) {
+                u64 a = UNSAFE(acc[i]);
+                a ^= a >> 47;
+                a ^= impl::readLittleEndian<8>(UNSAFE(secret + SECRET_SIZE - STRIPE + (8 * i)));
+                UNSAFE(acc[i] = a * PRIME32_1);
+            }
+        }
+    }
+
+    ///
+    /// Adds the last 64 bytes of the input (which may overlap the stripes before) and merges the accumulators.
+    ///
+    template<typename T>
+    constexpr static u64 _finishLong(u64 (&acc)[8], T const* last, u8 const* secret, usize length)
+    {
+        using impl::readLittleEndian;
+        UNSAFE_BEGIN;
+        _accumulate(acc, last, secret + SECRET_SIZE - STRIPE - 7);
+        u64 result = length * PRIME64_1;
+        for (usize i = 0; i < 4; i++) {
+            result += impl::multiplyFold(acc[2 * i] ^ readLittleEndian<8>(secret + 11 + (16 * i)),
+                acc[(2 * i) + 1] ^ readLittleEndian<8>(secret + 11 + (16 * i) + 8));
+        }
+        result ^= result >> 37;
+        result *= 0x165667919E3779F9ull;
+        return result ^ (result >> 32);
+        UNSAFE_END;
+    }
+
+    template<typename T>
+    constexpr static u64 _hashLong(T const* p, usize length, u64 seed)
+    {
+        UNSAFE_BEGIN;
+        u8 secret[SECRET_SIZE];
+        _seedSecret(secret, seed);
+        u64 acc[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+        // Every stripe that is followed by at least one more byte
+        usize stripes = (length - 1) / STRIPE;
+        for (usize s = 0; s < stripes; s++) {
+            _consumeStripe(acc, p + (s * STRIPE), secret, s);
+        }
+        return _finishLong(acc, p + length - STRIPE, secret, length);
+        UNSAFE_END;
+    }
+
+public:
+    ///
+    /// Hashes a buffer that is given in pieces, with the same result as hashBytes on all the pieces put together.
+    /// The first LONG_INPUT bytes are kept until it is known whether the input is long; after that, each stripe is
+    /// consumed as soon as more input follows it, and up to LONG_INPUT bytes, plus the 64 before them that the last
+    /// stripe may overlap, are kept until finalize().
+    ///
+    class State
+    {
+        // The pending bytes start at _buffer + STRIPE; the STRIPE bytes before them are the last ones consumed
+        u8 _buffer[STRIPE + LONG_INPUT] = {};
+        u8 _secret[SECRET_SIZE] = {};
+        u64 _acc[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+        usize _pending = 0;
+        usize _length = 0;
+        usize _stripes = 0;
+        u64 _seed;
+
+    public:
+        constexpr explicit State(u64 seed)
+            : _seed(seed)
+        {
+            _seedSecret(_secret, seed);
+        }
+
+        template<typename T>
+        requires (sizeof(T) == 1)
+        constexpr void update(T const* p, usize length)
+        {
+            UNSAFE_BEGIN;
+            _length += length;
+            while (length > 0) {
+                if (_pending == LONG_INPUT) {
+                    // More input follows, so the input is long and all the buffered stripes can be consumed
+                    for (usize s = 0; s < LONG_INPUT; s += STRIPE) {
+                        _consumeStripe(_acc, _buffer + STRIPE + s, _secret, _stripes++);
+                    }
+                    _copy(_buffer, _buffer + LONG_INPUT, STRIPE);
+                    _pending = 0;
+                }
+                if (_pending == 0 && length > STRIPE && _length > LONG_INPUT) {
+                    do {
+                        _consumeStripe(_acc, p, _secret, _stripes++);
+                        p += STRIPE;
+                        length -= STRIPE;
+                    } while (length > STRIPE);
+                    _copy(_buffer, p - STRIPE, STRIPE);
+                }
+                usize n = min(LONG_INPUT - _pending, length);
+                _copy(_buffer + STRIPE + _pending, p, n);
+                _pending += n;
+                p += n;
+                length -= n;
+            }
+            UNSAFE_END;
+        }
+
+        constexpr u64 finalize() const
+        {
+            UNSAFE_BEGIN;
+            if (_stripes == 0) {
+                return hashBytes(_buffer + STRIPE, _length, _seed);
+            }
+            u64 acc[8];
+            for (usize i = 0; i < 8; i++) {
+                acc[i] = _acc[i];
+            }
+            u8 const* p = _buffer + STRIPE;
+            usize i = _pending;
+            for (usize s = _stripes; i > STRIPE; s++) {
+                _consumeStripe(acc, p, _secret, s);
+                p += STRIPE;
+                i -= STRIPE;
+            }
+            return _finishLong(acc, p + i - STRIPE, _secret, _length);
+            UNSAFE_END;
+        }
+
+    private:
+        template<typename T>
+        constexpr static void _copy(u8* to, T const* from, usize n)
+        {
+            for (usize i = 0; i < n; i++) {
+                UNSAFE(to[i] = u8(from[i]));
+            }
+        }
+    };
+};
+
+
+}  // namespace cm
+#endif
@@ -0,0 +1,170 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+
+namespace cm {
+
+///
+/// Instrumentation of what the program allocates: live and peak bytes, the number of allocations, a histogram of
+/// allocation sizes in powers of two, and a table of the places in the library (e.g. ByteVector::_reallocate) that
+/// allocated.
+///
+/// It is opt-in: define CM_HEAP_STATS before including the library to enable it. Otherwise ENABLED is false and the
+/// hooks are never called, since every call site is guarded with `if constexpr (HeapStats::ENABLED)`.
+/// When enabled, the statistics are printed to stderr at exit; dump() prints them on demand.
+///
+struct HeapStats
+{
+#ifdef CM_HEAP_STATS
+    constexpr static bool ENABLED = true;
+#else
+    constexpr static bool ENABLED = false;
+#endif
+    constexpr static u32 HISTOGRAM_BUCKETS = 65;
+    constexpr static u32 MAX_CALL_SITES = 256;
+
+    struct CallSite
+    {
+        SourceLocation where;
+        u64 count;
+        u64 bytes;
+    };
+
+    ///
+    /// Records an allocation of sizeBytes.
+    ///
+    static void recordAllocation(usize sizeBytes)
+    {
+        __atomic_fetch_add(&_count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&UNSAFE(_histogram[bucketOf(sizeBytes)]), 1, __ATOMIC_RELAXED);
+        auto live = __atomic_add_fetch(&_liveBytes, sizeBytes, __ATOMIC_RELAXED);
+        auto peak = __atomic_load_n(&_peakBytes, __ATOMIC_RELAXED);
+        while (live > peak &&
+               !__atomic_compare_exchange_n(&_peakBytes, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    ///
+    /// Records that a block of sizeBytes was freed.
+    ///
+    static void recordDeallocation(usize sizeBytes)
+    {
+        __atomic_fetch_add(&_frees, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&_liveBytes, sizeBytes, __ATOMIC_RELAXED);
+    }
+
+    ///
+    /// Attributes an allocation of sizeBytes to a place in the source code.
+    ///
+    static void recordCallSite(usize sizeBytes, SourceLocation where = SourceLocation::current())
+    {
+        auto hash = (usize(where.file()) >> 3) ^ (usize(where.line()) * 0x9E3779B97F4A7C15ull);
+        _sitesLock.lock();
+        for (u32 i = 0; i < MAX_CALL_SITES; i++) {
+            auto& site = UNSAFE(_sites[(hash + i) % MAX_CALL_SITES]);
+            if (site.count == 0) {
+                site.where = where;
+            } else if (site.where.file() != where.file() || site.where.line() != where.line()) {
+                continue;
+            }
+            site.count++;
+            site.bytes += sizeBytes;
+            break;
+        }
+        _sitesLock.unlock();
+    }
+
+    ///
+    /// Returns the histogram bucket for an allocation size: bucket k holds sizes in [2^(k-1), 2^k).
+    ///
+    FORCEINLINE constexpr static u32 bucketOf(usize sizeBytes)
+    {
+        return sizeBytes == 0 ? 0 : u32(64 - __builtin_clzll(sizeBytes));
+    }
+
+    static u64 liveBytes() { return __atomic_load_n(&_liveBytes, __ATOMIC_RELAXED); }
+    static u64 peakBytes() { return __atomic_load_n(&_peakBytes, __ATOMIC_RELAXED); }
+    static u64 allocationCount() { return __atomic_load_n(&_count, __ATOMIC_RELAXED); }
+    static u64 freeCount() { return __atomic_load_n(&_frees, __ATOMIC_RELAXED); }
+
+    ///
+    /// Returns the number of allocations recorded in a histogram bucket (see bucketOf()).
+    ///
+    static u64 bucketCount(u32 bucket) { return __atomic_load_n(&UNSAFE(_histogram[bucket]), __ATOMIC_RELAXED); }
+
+    ///
+    /// Copies the call sites that have allocated to the start of `sites`, and returns how many there are.
+    /// The table is only locked while it is copied, so the caller may allocate while it goes through the copy.
+    ///
+    static u32 callSites(CallSite (&sites)[MAX_CALL_SITES])
+    {
+        u32 n = 0;
+        _sitesLock.lock();
+        for (auto const& site : _sites) {
+            if (site.count != 0) {
+                UNSAFE(sites[n++] = site);
+            }
+        }
+        _sitesLock.unlock();
+        return n;
+    }
+
+    ///
+    /// Prints the statistics to an output stream (e.g. stderr). The call sites are copied first, so that an output
+    /// stream that allocates (and so records a call site) does not wait on the lock of the table.
+    ///
+    static void dump(auto const& out)
+    {
+        out.println("Heap statistics:");
+        out.println("  allocations: `, frees: `", allocationCount(), freeCount());
+        out.println("  live bytes: `, peak bytes: `", liveBytes(), peakBytes());
+        out.println("  allocation sizes:");
+        for (u32 k = 0; k < HISTOGRAM_BUCKETS; k++) {
+            if (auto n = bucketCount(k); n != 0) {
+                if (k == HISTOGRAM_BUCKETS - 1) {
+                    // 2^64 does not fit in a u64
+                    out.println("    [`, 2^64) : `", u64(1) << (k - 1), n);
+                } else {
+                    out.println("    [`, `) : `", k == 0 ? 0 : (u64(1) << (k - 1)), u64(1) << k, n);
+                }
+            }
+        }
+        out.println("  call sites:");
+        CallSite sites[MAX_CALL_SITES];
+        auto n = callSites(sites);
+        for (u32 i = 0; i < n; i++) {
+            auto const& site = UNSAFE(sites[i]);
+            out.println(
+                "    `:` (`) : ` allocations, ` bytes", site.where.file(), site.where.line(), site.where.function(),
+                site.count, site.bytes);
+        }
+    }
+
+private:
+    inline static u64 _liveBytes;
+    inline static u64 _peakBytes;
+    inline static u64 _count;
+    inline static u64 _frees;
+    inline static u64 _histogram[HISTOGRAM_BUCKETS];
+    inline static CallSite _sites[MAX_CALL_SITES];
+    inline static SpinLock _sitesLock;
+};
+
+}  // namespace cm
+#endif
@@ -289,8 +289,10 @@ constexpr auto stringLen(T const* str)
         }
         return len;
     } else {
-        if constexpr (IsUnderlyingTypeOneOf<T, char*, char8_t*>) {
-            return strlen(str);
+        if constexpr (IsUnderlyingTypeOneOf<T, char, char8_t>) {
+            return strlen(reinterpret_cast<char const*>(str));
+        } else if constexpr (IsUnderlyingTypeOneOf<T, wchar_t>) {
+            return wcslen(str);
         } else {
             auto len = 0uz;
             while (*str++ != T{}) {
@@ -253,27 +253,21 @@ struct Iterable
     }
 
     ///
-    /// Finds the first occurence of a contiguous
+    /// Finds the first occurence of a contiguous sequence of elements, starting at baseIndex
     ///
     inline Optional<usize> find(this Iterable const& self, Derived const& str, usize baseIndex = 0)
     {
-        auto _self = DerivedRef(self);
-        if (_self.length() < str.length()) {
-            return None;
-        } else if (_self.length() == str.length() && _self.equals(str)) {
-            return 0uz;
-        } else {
-            for (usize i = baseIndex; i < _self.length() - str.length(); i++) {
-                UNSAFE_BEGIN;
-                auto s1 = _self.slice(i, str.length());
-                UNSAFE_END;
-                auto s2 = str.slice(0, str.length());
-                if (s1.equals(s2)) {
-                    return i;
-                }
+        DerivedRef _self = DerivedRef(self);
+        for (usize i = baseIndex; i + str.length() <= _self.length(); i++) {
+            UNSAFE_BEGIN;
+            auto s1 = _self.slice(i, i + str.length());
+            UNSAFE_END;
+            auto s2 = str.slice(0, str.length());
+            if (s1.equals(s2)) {
+                return i;
             }
-            return None;
         }
+        return None;
     }
 
 
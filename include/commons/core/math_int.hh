@@ -84,9 +84,16 @@ constexpr inline auto intBaseTables = []() {
     } charSets[128] = {
         [int(IntBaseFmt::B2)] = {"0123456789abcdef"},                                                          //
         [int(IntBaseFmt::B3)] = {"0123456789abcdef"},                                                          //
+        [int(IntBaseFmt::B4)] = {"0123456789abcdef"},                                                          //
+        [int(IntBaseFmt::B5)] = {"0123456789abcdef"},                                                          //
+        [int(IntBaseFmt::B6)] = {"0123456789abcdef"},                                                          //
+        [int(IntBaseFmt::B7)] = {"0123456789abcdef"},                                                          //
         [int(IntBaseFmt::B8)] = {"0123456789abcdef"},                                                          //
+        [int(IntBaseFmt::B9)] = {"0123456789abcdef"},                                                          //
         [int(IntBaseFmt::B10)] = {"0123456789abcdef"},                                                         //
         [int(IntBaseFmt::B16)] = {"0123456789abcdef"},                                                         //
+        [int(IntBaseFmt::B64)] = {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"},         //
+        [int(IntBaseFmt::B64_URL)] = {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"},     //
         [int(IntBaseFmt::B64_crypt)] = {"./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"},   //
         [int(IntBaseFmt::B64_bcrypt)] = {"./ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"},  //
         [int(IntBaseFmt::B64_Bash)] = {"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ@_"},
@@ -482,10 +489,11 @@ constexpr static u8 log(IsInteger auto x)
     } else if constexpr (Base == 16) {
         return log<2>(x) / 4;
     } else if constexpr (Base == 10) {
-        constexpr u8 UNSAFE(guess[33]) = {0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
-                                          5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9};
-        u8 UNSAFE(digits) = guess[log<2>(x)];
-        return u8(digits + ((x / 10) >= pow<10>(digits).val()));
+        // 1233 / 4096 is just below log10(2), so t is either floor(log10(x)) or one more than it. This works for every
+        // width (the old 33-entry guess table only covered 32-bit values), and 10^t always fits in the type of x.
+        using T = CVRefRemoved<decltype(x)>;
+        auto t = u8(((unsigned(log<2>(x)) + 1) * 1233) >> 12);
+        return u8(t - (x < pow<10>(T(t)).val()));
     } else {
         static_assert(false, "Not implemented");
     }
@@ -512,6 +520,156 @@ constexpr static auto msd(IsInteger auto x) -> decltype(x)
 }
 
 
+///
+/// Returns the radix of a base (e.g. 64 for all of the base 64 alphabets).
+///
+constexpr u32 radixOf(IntBaseFmt base)
+{
+    return u32(base) <= u32(IntBaseFmt::B16) ? u32(base) : 64;
+}
+
+namespace impl {
+
+///
+/// "00", "01", ... "99": the decimal conversion produces two digits per division.
+///
+constexpr inline char twoDigitTable[201] = "0001020304050607080910111213141516171819"
+                                           "2021222324252627282930313233343536373839"
+                                           "4041424344454647484950515253545556575859"
+                                           "6061626364656667686970717273747576777879"
+                                           "8081828384858687888990919293949596979899";
+
+///
+/// Splits an integer into its magnitude, as the unsigned type of the same width, and its sign.
+///
+template<IsInteger T>
+FORCEINLINE constexpr auto splitSign(T value)
+{
+    using U = UintN<BITS<T>>;
+    struct
+    {
+        U magnitude;
+        bool negative;
+    } result{U(value), false};
+    if constexpr (IsIntegerSigned<T>) {
+        if (value < T(0)) {
+            result.magnitude = U(0) - U(value);
+            result.negative = true;
+        }
+    }
+    return result;
+}
+
+///
+/// Returns the number of digits of an unsigned integer in a base.
+///
+template<IntBaseFmt Base>
+constexpr usize digitCount(IsInteger auto u)
+{
+    constexpr u32 RADIX = radixOf(Base);
+    if (u == 0) {
+        return 1;
+    }
+    if constexpr (RADIX == 10) {
+        return usize(log<10>(u)) + 1;
+    } else if constexpr ((RADIX & (RADIX - 1)) == 0) {
+        constexpr u32 SHIFT = u32(__builtin_ctz(RADIX));
+        return (usize(log<2>(u)) + SHIFT) / SHIFT;
+    } else {
+        usize n = 0;
+        for (; u != 0; u /= RADIX) {
+            n++;
+        }
+        return n;
+    }
+}
+
+///
+/// Writes the digits of an unsigned integer so that they end just before `end`.
+///
+template<IntBaseFmt Base>
+FORCEINLINE constexpr void writeDigitsBackwards(IsInteger auto u, char* end)
+{
+    constexpr u32 RADIX = radixOf(Base);
+    UNSAFE_BEGIN;
+    char* p = end;
+    if constexpr (RADIX == 10) {
+        while (u >= 100) {
+            auto r = usize(u % 100);
+            u /= 100;
+            p -= 2;
+            p[0] = twoDigitTable[r * 2];
+            p[1] = twoDigitTable[(r * 2) + 1];
+        }
+        if (u >= 10) {
+            p -= 2;
+            p[0] = twoDigitTable[usize(u) * 2];
+            p[1] = twoDigitTable[(usize(u) * 2) + 1];
+        } else {
+            *--p = char('0' + char(u));
+        }
+    } else {
+        char const* charSet = intBaseTables[u32(Base)].charSet.data();
+        if constexpr ((RADIX & (RADIX - 1)) == 0) {
+            constexpr u32 SHIFT = u32(__builtin_ctz(RADIX));
+            do {
+                *--p = charSet[usize(u & (RADIX - 1))];
+                u >>= SHIFT;
+            } while (u != 0);
+        } else {
+            do {
+                *--p = charSet[usize(u % RADIX)];
+                u /= RADIX;
+            } while (u != 0);
+        }
+    }
+    UNSAFE_END;
+}
+
+}  // namespace impl
+
+///
+/// The most characters toChars() can write for an integer type in a base.
+///
+template<typename T, IntBaseFmt Base = IntBaseFmt::B10>
+constexpr inline usize TO_CHARS_MAX_LENGTH = impl::digitCount<Base>(MAX_VALUE<UintN<BITS<T>>>) + 1;
+
+///
+/// Returns the number of characters toChars() writes for a value, including the minus sign.
+///
+template<IntBaseFmt Base = IntBaseFmt::B10>
+constexpr usize toCharsLength(IsInteger auto value)
+{
+    auto [magnitude, negative] = impl::splitSign(value);
+    return impl::digitCount<Base>(magnitude) + (negative ? 1 : 0);
+}
+
+///
+/// Writes the text representation of an integer (digits only, with a leading '-' if it is negative; no prefix and no
+/// null terminator) to the start of a buffer.
+/// The length is computed up front, and the digits are written backwards from the end, two at a time in base 10.
+/// @param value The integer
+/// @param buffer Where to write the characters; TO_CHARS_MAX_LENGTH<T, Base> characters is always enough
+/// @return The number of characters written, or None if the buffer is too small (nothing is written then)
+///
+template<IntBaseFmt Base = IntBaseFmt::B10>
+constexpr Optional<usize> toChars(IsInteger auto value, ArrayRef<char> buffer)
+{
+    static_assert(radixOf(Base) >= 2, "Not a base");
+    auto [magnitude, negative] = impl::splitSign(value);
+    usize length = impl::digitCount<Base>(magnitude) + (negative ? 1 : 0);
+    if (length > buffer.length()) {
+        return None;
+    }
+    char* p = const_cast<char*>(buffer.data());
+    if (negative) {
+        *p = '-';
+    }
+    impl::writeDigitsBackwards<Base>(magnitude, UNSAFE(p + length));
+    return length;
+}
+
+
 // #if __clang__
 // #define U128(str) \
 //     ([]<bool C>(auto const& s) constexpr -> u128 { \
@@ -549,12 +707,9 @@ constexpr void ::cm::impl::outputStringForPrimitiveType(auto const& value, auto
         if constexpr (S == IntegerParsingScheme::JSON) {
             static_assert(Base == IntBaseFmt::B10, "JSON only supports base 10");
         }
-        auto num = value;
-        if constexpr (IsIntegerSigned<T>) {
-            if (num < 0) {
-                out('-');
-                num = static_cast<T>(-value);
-            }
+        auto [num, negative] = impl::splitSign(value);
+        if (negative) {
+            out('-');
         }
         // Handle prefixes
         if constexpr (Base == IntBaseFmt::B2) {
@@ -570,62 +725,18 @@ constexpr void ::cm::impl::outputStringForPrimitiveType(auto const& value, auto
                 out("0x");
             }
         }
-        if (num == 0) {
-            out(intBaseTables[uint(Base)].charSet[0]);
-            return;
+        char buffer[TO_CHARS_MAX_LENGTH<T, Base>];
+        auto n = toChars<Base>(num, buffer).val();
+        for (usize i = 0; i < n; i++) {
+            out(UNSAFE(buffer[i]));
         }
-        do {
-            out(intBaseTables[uint(Base)].charSet[msd<uint(Base)>(num)]);
-            num /= uint(Base);
-        } while (num != 0);
 
     } else if constexpr (IsFloatingPoint<T>) {
-
-        // double or float
-        auto val = double(value);
-        i64 integer;
-        int zero_threshold = 16;
-        int zero_seq_len = 0;
-
-        if (__builtin_isnan(val)) {
-            out('N'), out('a'), out('N');
-            return;
-        } else if (__builtin_isinf(val)) {
-            if (__builtin_signbit(val)) {
-                out('-'), out('i'), out('n'), out('f');
-                return;
-            } else {
-                out('i'), out('n'), out('f');
-                return;
-            }
-        }
-        if (val < 0) {
-            out('-');
-            val = -val;
-        }
-        integer = i64(val);
-        if (integer == 0) {
-            out('0');
-            return;
-        }
-        OutputString(integer, out);
-        out('.');
-
-        while (true) {
-            val = val - static_cast<double>(i64(val));
-            val *= 10;
-            integer = i64(val);
-            if (integer == 0) {
-                zero_seq_len++;
-                out('0');
-                if (zero_seq_len >= zero_threshold) {
-                    return;
-                }
-            } else {
-                zero_seq_len = 0;
-                OutputString(integer, out);
-            }
-            zero_threshold--;
+        // Shortest representation that reads back as the same value (see float_to_chars.hh)
+        char buffer[FLOAT_TO_CHARS_MAX_LENGTH];
+        auto n = toChars(value, ArrayRef<char>(buffer)).val();
+        for (usize i = 0; i < n; i++) {
+            out(UNSAFE(buffer[i]));
         }
     }
 }
@@ -0,0 +1,681 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+
+namespace cm {
+
+///
+/// Why a string could not be parsed as a number:
+/// - Overflow: The magnitude of the number in the string cannot be represented by the type.
+/// - BadFormat: The string is not a valid number. If the string is a negative number but the type is unsigned, the
+///   error is BadFormat, and so is "-0".
+///
+using ParseError = Union<Errors::Overflow, Errors::BadFormat>;
+
+namespace impl {
+
+enum class ParseStatus : u8 {
+    OK,
+    BAD_FORMAT,
+    OVERFLOW,
+};
+
+///
+/// Reads 8 characters as a little-endian u64.
+///
+FORCEINLINE constexpr u64 loadEightChars(char const* p)
+{
+    u64 chunk = 0;
+    if consteval {
+        for (u32 i = 0; i < 8; i++) {
+            chunk |= u64(u8(UNSAFE(p[i]))) << (i * 8);
+        }
+    } else {
+        __builtin_memcpy(&chunk, p, 8);
+    }
+    return chunk;
+}
+
+///
+/// Returns true if all 8 characters in a chunk are decimal digits: adding 6 to a digit leaves the high nibble at 3,
+/// and anything else ends up with a different high nibble either before or after the addition.
+///
+FORCEINLINE constexpr bool isEightDigits(u64 chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
+}
+
+///
+/// Converts 8 decimal digits to their value with three multiplications (SWAR: the digits are combined pairwise into
+/// 2-digit, then 4-digit, then the 8-digit value, all lanes at once), instead of 8 dependent multiply-adds.
+///
+FORCEINLINE constexpr u32 eightDigitsValue(u64 chunk)
+{
+    constexpr u64 MASK = 0x000000FF000000FF;
+    constexpr u64 MUL1 = 100 + (1000000ull << 32);
+    constexpr u64 MUL2 = 1 + (10000ull << 32);
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & MASK) * MUL1) + (((chunk >> 16) & MASK) * MUL2)) >> 32;
+    return u32(chunk);
+}
+
+///
+/// Maps every character to its digit value in a base, or 0xFF if it is not a digit. Bases up to 16 accept upper case
+/// letters too.
+///
+template<IntBaseFmt Base>
+constexpr inline auto digitValues = [] {
+    struct
+    {
+        u8 values[256];
+    } table{};
+    for (auto& v : table.values) {
+        v = 0xFF;
+    }
+    auto charSet = intBaseTables[u32(Base)].charSet;
+    UNSAFE_BEGIN;
+    for (u32 i = 0; i < radixOf(Base); i++) {
+        auto c = u8(charSet[i]);
+        table.values[c] = u8(i);
+        if (radixOf(Base) <= 16 && c >= 'a' && c <= 'z') {
+            table.values[c - 'a' + 'A'] = u8(i);
+        }
+    }
+    UNSAFE_END;
+    return table;
+}();
+
+///
+/// Parses a run of digits in any base, one digit at a time. There must be at least one digit.
+/// @param hadDigits Whether digits were already parsed before p
+///
+template<IntBaseFmt Base, bool UNDERSCORES, typename U>
+constexpr ParseStatus parseDigits(char const* p, char const* end, U& value, bool hadDigits = false)
+{
+    constexpr u32 RADIX = radixOf(Base);
+    UNSAFE_BEGIN;
+    for (; p != end; p++) {
+        if (UNDERSCORES && *p == '_') {
+            continue;
+        }
+        u8 digit = digitValues<Base>.values[u8(*p)];
+        if (digit == 0xFF) {
+            return ParseStatus::BAD_FORMAT;
+        }
+        if (mulOverflow(value, U(RADIX), value) || addOverflow(value, U(digit), value)) {
+            return ParseStatus::OVERFLOW;
+        }
+        hadDigits = true;
+    }
+    return hadDigits ? ParseStatus::OK : ParseStatus::BAD_FORMAT;
+    UNSAFE_END;
+}
+
+///
+/// Parses a non-empty run of decimal digits into value, 8 digits at a time while they last.
+/// @tparam UNDERSCORES Whether underscores between digits are ignored (YAML)
+///
+template<bool UNDERSCORES, typename U>
+constexpr ParseStatus parseDecimalDigits(char const* p, char const* end, U& value)
+{
+    UNSAFE_BEGIN;
+    [[maybe_unused]] char const* start = p;
+    while (end - p >= 8) {
+        u64 chunk = loadEightChars(p);
+        if (!isEightDigits(chunk)) {
+            break;
+        }
+        if (mulOverflow(value, U(100'000'000), value) || addOverflow(value, U(eightDigitsValue(chunk)), value)) {
+            return ParseStatus::OVERFLOW;
+        }
+        p += 8;
+    }
+    if constexpr (UNDERSCORES) {
+        return parseDigits<IntBaseFmt::B10, true>(p, end, value, start != p);
+    } else {
+        // Fewer than 8 digits are left before the end or before a character that is not a digit, so they fit in a u32
+        // and take a single multiplication to append
+        u32 tail = 0;
+        u32 n = 0;
+        for (; p != end; p++, n++) {
+            auto digit = u32(u8(*p) - u8('0'));
+            if (digit > 9) {
+                return ParseStatus::BAD_FORMAT;
+            }
+            tail = (tail * 10) + digit;
+        }
+        if (n != 0 && (mulOverflow(value, pow<10>(U(n)).val(), value) || addOverflow(value, U(tail), value))) {
+            return ParseStatus::OVERFLOW;
+        }
+    }
+    return ParseStatus::OK;
+    UNSAFE_END;
+}
+
+///
+/// Turns a parsed magnitude and sign into the result, checking that it is in the range of T.
+///
+template<IsInteger T, typename U>
+constexpr Result<T, ParseError> finishInteger(ParseStatus status, U magnitude, bool negative)
+{
+    if (status == ParseStatus::BAD_FORMAT) {
+        return Err(Errors::BadFormat());
+    }
+    if (status == ParseStatus::OVERFLOW) {
+        return Err(Errors::Overflow());
+    }
+    if (negative) {
+        if constexpr (IsIntegerSigned<T>) {
+            // |MIN_VALUE| is one more than MAX_VALUE
+            if (magnitude > U(MAX_VALUE<T>) + 1) {
+                return Err(Errors::Overflow());
+            }
+            return Ok(T(U(0) - magnitude));
+        } else {
+            return Err(Errors::BadFormat());
+        }
+    }
+    if (magnitude > U(MAX_VALUE<T>)) {
+        return Err(Errors::Overflow());
+    }
+    return Ok(T(magnitude));
+}
+
+///
+/// The type digits are accumulated in: at least 64 bits, so that the overflow checks happen once at the end for
+/// narrower types.
+///
+template<typename T>
+using ParseAccumulator = UintN<(BITS<T> > 64 ? BITS<T> : 64)>;
+
+}  // namespace impl
+
+///
+/// Parses a string as an integer according to an IntegerParsingScheme. The whole string must be the number (no
+/// spaces around it).
+/// Long runs of decimal digits are converted 8 at a time with SWAR arithmetic on 64-bit words.
+/// \code{.cpp}
+///     parse<i32>("-42").unwrap();                          // -42
+///     parse<u8>("256").error().is<Errors::Overflow>();      // true
+///     parse<u16, IntegerParsingScheme::YAML>("0x_ff_ff");  // 65535
+/// \endcode
+/// @return The integer, or the reason it could not be parsed (see ParseError)
+///
+template<IsInteger T, IntegerParsingScheme S = IntegerParsingScheme::DEFAULT>
+constexpr Result<T, ParseError> parse(StringRef s)
+{
+    using U = impl::ParseAccumulator<T>;
+    UNSAFE_BEGIN;
+    char const* p = s.data();
+    char const* end = p + s.length();
+    U magnitude = 0;
+    bool negative = false;
+    impl::ParseStatus status = impl::ParseStatus::BAD_FORMAT;
+
+    if constexpr (S == IntegerParsingScheme::JSON) {
+        if (p != end && *p == '-') {
+            negative = true;
+            p++;
+        }
+        // No leading zeros, except for the number 0 itself
+        if (p != end && !(*p == '0' && end - p > 1)) {
+            status = impl::parseDecimalDigits<false>(p, end, magnitude);
+        }
+    } else if constexpr (S == IntegerParsingScheme::YAML) {
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        // 0x, 0o and 0b prefixes, or a leading 0 for octal
+        u32 radix = 10;
+        if (end - p > 1 && *p == '0') {
+            char c = p[1];
+            radix = (c == 'x' || c == 'X') ? 16 : (c == 'b' || c == 'B') ? 2 : 8;
+            p += (radix == 8 && c != 'o') ? 1 : 2;
+        }
+        if (p != end) {
+            if (radix == 16) {
+                status = impl::parseDigits<IntBaseFmt::B16, true>(p, end, magnitude);
+            } else if (radix == 8) {
+                status = impl::parseDigits<IntBaseFmt::B8, true>(p, end, magnitude);
+            } else if (radix == 2) {
+                status = impl::parseDigits<IntBaseFmt::B2, true>(p, end, magnitude);
+            } else if (*p != '_') {
+                // Underscores go between digits, a decimal number cannot start with one
+                status = impl::parseDecimalDigits<true>(p, end, magnitude);
+            }
+        }
+    } else {
+        static_assert(false, "Invalid IntegerParsingScheme");
+    }
+    return impl::finishInteger<T>(status, magnitude, negative);
+    UNSAFE_END;
+}
+
+///
+/// Parses a string of digits in a base, with an optional leading '-' or '+' in bases up to 16 (the base 64 alphabets
+/// use those characters as digits). There is no prefix.
+/// \code{.cpp}
+///     parse<u32, IntBaseFmt::B16>("DeadBeef").unwrap();  // 0xdeadbeef
+/// \endcode
+/// @return The integer, or the reason it could not be parsed (see ParseError)
+///
+template<IsInteger T, IntBaseFmt Base>
+constexpr Result<T, ParseError> parse(StringRef s)
+{
+    static_assert(radixOf(Base) >= 2, "Not a base");
+    using U = impl::ParseAccumulator<T>;
+    UNSAFE_BEGIN;
+    char const* p = s.data();
+    char const* end = p + s.length();
+    U magnitude = 0;
+    bool negative = false;
+    impl::ParseStatus status = impl::ParseStatus::BAD_FORMAT;
+
+    if (radixOf(Base) <= 16 && p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p != end) {
+        if constexpr (Base == IntBaseFmt::B10) {
+            status = impl::parseDecimalDigits<false>(p, end, magnitude);
+        } else {
+            status = impl::parseDigits<Base, false>(p, end, magnitude);
+        }
+    }
+    return impl::finishInteger<T>(status, magnitude, negative);
+    UNSAFE_END;
+}
+
+namespace impl {
+///
+/// A decimal number as written in a string: its first (up to) 19 significant digits as an integer, and where all of
+/// its digits are, for the rare numbers that need more of them to be rounded correctly.
+///
+struct DecimalString
+{
+    u64 mantissa = 0;
+    // The value is about mantissa * 10^exponent
+    i64 exponent = 0;
+    // The exponent of the last digit, i.e. the value is exactly (all the digits) * 10^lastDigitExponent
+    i64 lastDigitExponent = 0;
+    // The digits, with the decimal point if there is one
+    char const* digits = nullptr;
+    char const* digitsEnd = nullptr;
+    // More than 19 significant digits, so mantissa is not exact
+    bool truncated = false;
+};
+
+///
+/// Appends a run of decimal digits to value (wrapping around on overflow), 8 at a time while they last.
+/// @return Where the digits end
+///
+FORCEINLINE constexpr char const* appendDecimalDigits(char const* p, char const* end, u64& value)
+{
+    UNSAFE_BEGIN;
+    while (end - p >= 8 && isEightDigits(loadEightChars(p))) {
+        value = (value * 100'000'000) + eightDigitsValue(loadEightChars(p));
+        p += 8;
+    }
+    for (; p != end && u8(*p - '0') <= 9; p++) {
+        value = (value * 10) + u8(*p - '0');
+    }
+    return p;
+    UNSAFE_END;
+}
+
+///
+/// Reads digits[.digits][(e|E)[+|-]digits] (the sign has already been read), which must be the whole of [p, end).
+/// There must be at least one digit before or after the point.
+///
+constexpr ParseStatus scanDecimalString(char const* p, char const* end, DecimalString& d)
+{
+    UNSAFE_BEGIN;
+    char const* start = p;
+    u64 mantissa = 0;
+    p = appendDecimalDigits(p, end, mantissa);
+    i64 digitCount = p - start;
+    i64 fractionLength = 0;
+    if (p != end && *p == '.') {
+        char const* fraction = ++p;
+        p = appendDecimalDigits(p, end, mantissa);
+        fractionLength = p - fraction;
+        digitCount += fractionLength;
+    }
+    if (digitCount == 0) {
+        return ParseStatus::BAD_FORMAT;
+    }
+    d.digits = start;
+    d.digitsEnd = p;
+
+    i64 explicitExponent = 0;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        bool negativeExponent = false;
+        if (++p != end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p++ == '-';
+        }
+        if (p == end) {
+            return ParseStatus::BAD_FORMAT;
+        }
+        for (; p != end; p++) {
+            auto digit = u8(*p - '0');
+            if (digit > 9) {
+                return ParseStatus::BAD_FORMAT;
+            }
+            // Anything this large is 0 or infinite anyway, so stop before it overflows
+            if (explicitExponent < 0x10000) {
+                explicitExponent = (explicitExponent * 10) + digit;
+            }
+        }
+        explicitExponent = negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (p != end) {
+        return ParseStatus::BAD_FORMAT;
+    }
+    d.mantissa = mantissa;
+    d.lastDigitExponent = explicitExponent - fractionLength;
+    d.exponent = d.lastDigitExponent;
+
+    if (digitCount > 19) {
+        // Leading zeros are not significant
+        char const* q = start;
+        for (; q != d.digitsEnd && (*q == '0' || *q == '.'); q++) {
+            digitCount -= (*q == '0') ? 1 : 0;
+        }
+        if (digitCount > 19) {
+            d.truncated = true;
+            d.mantissa = 0;
+            for (u32 n = 0; n < 19; q++) {
+                if (*q != '.') {
+                    d.mantissa = (d.mantissa * 10) + u8(*q - '0');
+                    n++;
+                }
+            }
+            d.exponent += digitCount - 19;
+        }
+    }
+    return ParseStatus::OK;
+    UNSAFE_END;
+}
+
+///
+/// A float or double under construction: the fraction bits (without the implicit bit) and the biased exponent, which
+/// is 0 for zero and the subnormals, and all ones for infinity.
+///
+struct BinaryFloat
+{
+    u64 fraction;
+    i32 exponent;
+
+    constexpr bool operator==(BinaryFloat const&) const = default;
+};
+
+template<IsUnderlyingTypeOneOf<float, double> T>
+struct BinaryFloatFormat
+{
+    constexpr static bool IS_FLOAT = IsUnderlyingTypeOneOf<T, float>;
+    constexpr static i32 FRACTION_BITS = IS_FLOAT ? 23 : 52;
+    constexpr static i32 INFINITE_EXPONENT = IS_FLOAT ? 0xFF : 0x7FF;
+    constexpr static i32 BIAS = INFINITE_EXPONENT >> 1;
+    // Any mantissa times a smaller power of ten rounds to 0, and times a larger one is infinite
+    constexpr static i64 SMALLEST_POWER_OF_TEN = IS_FLOAT ? -64 : -342;
+    constexpr static i64 LARGEST_POWER_OF_TEN = IS_FLOAT ? 38 : 308;
+    // The powers of ten for which a product can be exactly halfway between two values
+    constexpr static i64 MIN_ROUND_TO_EVEN_POWER = IS_FLOAT ? -17 : -4;
+    constexpr static i64 MAX_ROUND_TO_EVEN_POWER = IS_FLOAT ? 10 : 23;
+    // Mantissas and powers of ten that are exact in T, so that a single multiplication or division is correctly rounded
+    constexpr static u64 MAX_EXACT_MANTISSA = u64(1) << (FRACTION_BITS + 1);
+    constexpr static i64 MAX_EXACT_POWER_OF_TEN = IS_FLOAT ? 10 : 22;
+
+    constexpr static T toFloat(BinaryFloat f)
+    {
+        return bit_cast<T>(UintN<BITS<T>>(f.fraction | (u64(f.exponent) << FRACTION_BITS)));
+    }
+};
+
+///
+/// Returns the truncated 128-bit significand of 5^q (the same as that of 10^q) that the Eisel-Lemire algorithm is
+/// proven correct with. It comes from the table float_to_chars.hh uses, which has it plus 1, except for -27 <= q < 0,
+/// where both round up the exact quotient 2^b / 5^-q.
+///
+FORCEINLINE constexpr u128 pow5Significand(i64 q)
+{
+    auto const& g = UNSAFE(Data::pow10Significands[q - Data::POW10_SIGNIFICAND_MIN]);
+    u128 significand = (u128(g[0]) << 64) | g[1];
+    return (q >= -27 && q < 0) ? significand : significand - 1;
+}
+
+///
+/// Rounds w * 10^q to the nearest float or double with the Eisel-Lemire algorithm: w is normalized and multiplied by
+/// the 128-bit significand of 10^q, and the top bits of the product are the result. For an exact w, that is always
+/// correctly rounded (Mushtak & Lemire, "Fast number parsing without fallback").
+///
+template<IsUnderlyingTypeOneOf<float, double> T>
+constexpr BinaryFloat eiselLemire(i64 q, u64 w)
+{
+    using Format = BinaryFloatFormat<T>;
+    if (w == 0 || q < Format::SMALLEST_POWER_OF_TEN) {
+        return {0, 0};
+    }
+    if (q > Format::LARGEST_POWER_OF_TEN) {
+        return {0, Format::INFINITE_EXPONENT};
+    }
+    i32 leadingZeros = __builtin_clzll(w);
+    w <<= leadingZeros;
+
+    u128 pow5 = pow5Significand(q);
+    u128 product = u128(w) * u64(pow5 >> 64);
+    // Only if the bits below the ones that are kept are all ones can the low half of the significand carry into them
+    constexpr u64 PRECISION_MASK = ~u64(0) >> (Format::FRACTION_BITS + 3);
+    if ((u64(product >> 64) & PRECISION_MASK) == PRECISION_MASK) {
+        product += (u128(w) * u64(pow5)) >> 64;
+    }
+    u64 high = u64(product >> 64);
+    u64 low = u64(product);
+
+    // One bit more than the fraction (with the implicit bit), to round with
+    i32 upperBit = i32(high >> 63);
+    i32 shift = upperBit + 64 - Format::FRACTION_BITS - 3;
+    u64 fraction = high >> shift;
+    // floor(log2(10^q)) + 63 is the exponent of the product if its top bit is set
+    i32 exponent = i32(((217706 * q) >> 16) + 63) + upperBit - leadingZeros + Format::BIAS;
+
+    if (exponent <= 0) {
+        // Subnormal: shift down to the smallest exponent and round, which may carry into the smallest normal number
+        if (-exponent + 1 >= 64) {
+            return {0, 0};
+        }
+        fraction >>= -exponent + 1;
+        fraction += fraction & 1;
+        fraction >>= 1;
+        bool normal = fraction >= (u64(1) << Format::FRACTION_BITS);
+        return {fraction & ((u64(1) << Format::FRACTION_BITS) - 1), normal ? 1 : 0};
+    }
+    // Exactly halfway between two values (only possible for a few small powers of ten): round to even, not up
+    if (low <= 1 && q >= Format::MIN_ROUND_TO_EVEN_POWER && q <= Format::MAX_ROUND_TO_EVEN_POWER &&
+        (fraction & 3) == 1 && (fraction << shift) == high) {
+        fraction &= ~u64(1);
+    }
+    fraction += fraction & 1;
+    fraction >>= 1;
+    if (fraction >= (u64(2) << Format::FRACTION_BITS)) {
+        fraction >>= 1;
+        exponent++;
+    }
+    if (exponent >= Format::INFINITE_EXPONENT) {
+        return {0, Format::INFINITE_EXPONENT};
+    }
+    return {fraction & ((u64(1) << Format::FRACTION_BITS) - 1), exponent};
+}
+
+///
+/// Rounds a number with more than 19 significant digits, when the first 19 are not enough to decide between a value
+/// and the next one up: the number is compared exactly with the point halfway between the two. Only the first
+/// EXACT_DECIMAL_MAX_DIGITS digits are needed for that, and whether any of the others is not 0.
+///
+template<IsUnderlyingTypeOneOf<float, double> T>
+[[clang::noinline]] constexpr BinaryFloat roundLongDecimalString(DecimalString const& d, BinaryFloat lower)
+{
+    using Format = BinaryFloatFormat<T>;
+    UNSAFE_BEGIN;
+    char const* p = d.digits;
+    while (*p == '0' || *p == '.') {
+        p++;
+    }
+    BigUint digits(0);
+    i32 count = 0;
+    i64 droppedCount = 0;
+    bool droppedNonZero = false;
+    u32 chunk = 0;
+    u32 chunkLength = 0;
+    for (; p != d.digitsEnd; p++) {
+        if (*p == '.') {
+            continue;
+        }
+        if (count == EXACT_DECIMAL_MAX_DIGITS) {
+            droppedCount++;
+            droppedNonZero |= *p != '0';
+            continue;
+        }
+        chunk = (chunk * 10) + u8(*p - '0');
+        count++;
+        if (++chunkLength == 9) {
+            digits.multiply(1'000'000'000, chunk);
+            chunk = 0;
+            chunkLength = 0;
+        }
+    }
+    digits.multiply(pow<10>(chunkLength).val(), chunk);
+
+    // lower = c * 2^q, and the halfway point is (2c + 1) * 2^(q - 1)
+    auto [c, q, negative, lowerBoundaryIsCloser] = decomposeFloat(Format::toFloat(lower));
+    i32 order = compareBinaryToDecimal((2 * c) + 1, q - 1, digits, i32(d.lastDigitExponent + droppedCount));
+    bool roundUp = order < 0 || (order == 0 && (droppedNonZero || (c & 1) != 0));
+    if (!roundUp) {
+        return lower;
+    }
+    // The next value up, which may be the next exponent or infinity
+    u64 bits = (lower.fraction | (u64(lower.exponent) << Format::FRACTION_BITS)) + 1;
+    return {bits & ((u64(1) << Format::FRACTION_BITS) - 1), i32(bits >> Format::FRACTION_BITS)};
+    UNSAFE_END;
+}
+
+///
+/// Parses "inf", "infinity" or "nan" in any case.
+///
+template<IsUnderlyingTypeOneOf<float, double> T>
+constexpr Optional<T> parseNonFiniteFloat(StringRef s, bool negative)
+{
+    auto equalsIgnoringCase = [&](StringRef lowerCase) {
+        if (s.length() != lowerCase.length()) {
+            return false;
+        }
+        for (usize i = 0; i < s.length(); i++) {
+            if ((UNSAFE(s.data()[i]) | 0x20) != UNSAFE(lowerCase.data()[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (equalsIgnoringCase("inf") || equalsIgnoringCase("infinity")) {
+        return T(negative ? -__builtin_inf() : __builtin_inf());
+    }
+    if (equalsIgnoringCase("nan")) {
+        return T(__builtin_nan(""));
+    }
+    return None;
+}
+
+}  // namespace impl
+
+///
+/// Parses a string as a float or double, correctly rounded (to the nearest value, ties to even) whatever the number
+/// of digits. The syntax is [+|-]digits[.digits][(e|E)[+|-]digits], with digits before or after the point or both,
+/// or "inf", "infinity" or "nan" in any case, with an optional sign. The whole string must be the number (no spaces
+/// around it).
+/// Numbers of up to 19 significant digits take the Eisel-Lemire algorithm (one or two 64x64-bit multiplications by a
+/// power of ten from a table); longer ones are compared exactly with a big integer on the stack in the rare cases
+/// that the first 19 digits leave a doubt. Nothing is allocated.
+/// \code{.cpp}
+///     parse<double>("0.1").unwrap();                           // 0.1
+///     parse<float>("-1.5e3").unwrap();                         // -1500.0f
+///     parse<double>("1e400").error().is<Errors::Overflow>();  // true
+/// \endcode
+/// @return The number, or the reason it could not be parsed: BadFormat, or Overflow if it is too large for T (a number
+/// that is too small is rounded to 0)
+///
+template<IsFloatingPoint T>
+constexpr Result<T, ParseError> parse(StringRef s)
+{
+    if constexpr (IsUnderlyingTypeOneOf<T, float, double>) {
+        using Format = impl::BinaryFloatFormat<T>;
+        UNSAFE_BEGIN;
+        char const* p = s.data();
+        char const* end = p + s.length();
+        bool negative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+        impl::DecimalString d;
+        if (impl::scanDecimalString(p, end, d) != impl::ParseStatus::OK) {
+            if (auto nonFinite = impl::parseNonFiniteFloat<T>(StringRef(p, usize(end - p)), negative);
+                nonFinite.hasValue()) {
+                return Ok(nonFinite.val());
+            }
+            return Err(Errors::BadFormat());
+        }
+        UNSAFE_END;
+
+        T value;
+        if (!d.truncated && d.mantissa <= Format::MAX_EXACT_MANTISSA && d.exponent >= -Format::MAX_EXACT_POWER_OF_TEN &&
+            d.exponent <= Format::MAX_EXACT_POWER_OF_TEN) {
+            // Both the mantissa and the power of ten are exact, so one correctly rounded operation is enough (Clinger)
+            constexpr T POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            value = T(d.mantissa);
+            if (d.exponent < 0) {
+                value /= UNSAFE(POWERS_OF_TEN[-d.exponent]);
+            } else {
+                value *= UNSAFE(POWERS_OF_TEN[d.exponent]);
+            }
+        } else {
+            auto f = impl::eiselLemire<T>(d.exponent, d.mantissa);
+            // The digits after the 19th can only change the result if w + 1 rounds differently than w
+            if (d.truncated && f != impl::eiselLemire<T>(d.exponent, d.mantissa + 1)) {
+                f = impl::roundLongDecimalString<T>(d, f);
+            }
+            if (f.exponent == Format::INFINITE_EXPONENT) {
+                return Err(Errors::Overflow());
+            }
+            value = Format::toFloat(f);
+        }
+        return Ok(negative ? -value : value);
+    } else {
+        auto result = parse<double>(s);
+        if (result.isErr()) {
+            return Err(result.error());
+        }
+        return Ok(T(result.unwrap()));
+    }
+}
+
+}  // namespace cm
+#endif
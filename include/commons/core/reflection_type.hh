@@ -127,6 +127,15 @@ using RefOrPointerRemoved = typename TRefRemoved<typename TPointerRemoved<T>::Ty
 template<typename T>
 using RValueRefRemoved = typename TRValueRefRemoved<T>::Type;
 
+template<typename T>
+struct TTypeIdentity { using Type = T; };
+
+///
+/// Evaluates to T, but keeps a function parameter of this type from taking part in template argument deduction.
+///
+template<typename T>
+using TypeIdentity = typename TTypeIdentity<T>::Type;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -62,7 +62,18 @@ public:
         if (isErr()) {
             CPU.trap();
         }
-        return _u.success;
+        return _u.template ref<SuccessWrapper>().success;
+    }
+
+    ///
+    /// Returns the error value. A trap occurs if the result is not an error.
+    ///
+    FORCEINLINE constexpr ErrorType const& error() const noexcept
+    {
+        if (isOk()) {
+            CPU.trap();
+        }
+        return _u.template ref<ErrorWrapper>().error;
     }
 
     FORCEINLINE constexpr auto then(auto func)
@@ -0,0 +1,43 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+
+namespace cm {
+
+///
+/// A spinning lock for short critical sections, such as popping a free list.
+/// It is zero-initialized, so it can be a member of a global without needing a constructor to run.
+///
+struct SpinLock
+{
+    bool _locked;
+
+    FORCEINLINE void lock()
+    {
+        while (__atomic_exchange_n(&_locked, true, __ATOMIC_ACQUIRE)) {
+            while (__atomic_load_n(&_locked, __ATOMIC_RELAXED)) {
+                __builtin_ia32_pause();
+            }
+        }
+    }
+
+    FORCEINLINE void unlock() { __atomic_store_n(&_locked, false, __ATOMIC_RELEASE); }
+};
+
+}  // namespace cm
+#endif
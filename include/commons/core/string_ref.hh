@@ -34,6 +34,13 @@ public:
     using IEquatable<StringRef>::operator==;
     using IEquatable<StringRef>::operator!=;
 
+    ///
+    /// Constructs an empty string.
+    ///
+    constexpr StringRef()
+        : Base("", 1)
+    {}
+
     ///
     /// Constructs a StringRef from a C-style null terminated string. Be careful that the string is actually null
     /// terminated
@@ -80,18 +87,67 @@ public:
     ///
     constexpr char const* cstr() const noexcept { return this->data(); }
 
+    ///
+    /// Returns the index of the first occurrence of a substring that starts at or after `from`, or None.
+    /// Takes linear time: short substrings are looked for with SIMD compares and long ones with Two-Way (see
+    /// core/string_search.hh).
+    ///
+    constexpr Optional<usize> find(StringRef substr, usize from = 0) const
+    {
+        if (from > length()) {
+            return None;
+        }
+        UNSAFE(usize i = impl::findSubstring(data() + from, length() - from, substr.data(), substr.length()));
+        if (i == impl::NOT_FOUND) {
+            return None;
+        }
+        return from + i;
+    }
+
+    ///
+    /// Returns the index of the last occurrence of a substring, or None.
+    ///
+    constexpr Optional<usize> rfind(StringRef substr) const
+    {
+        usize i = impl::rfindSubstring(data(), length(), substr.data(), substr.length());
+        if (i == impl::NOT_FOUND) {
+            return None;
+        }
+        return i;
+    }
+
+    ///
+    /// Calls func(index) for every occurrence of a substring, from left to right, skipping the ones that overlap the
+    /// previous occurrence. Nothing is found for an empty substring.
+    ///
+    constexpr void findAll(StringRef substr, auto const& func) const
+    {
+        impl::forEachSubstring(data(), length(), substr.data(), substr.length(), func);
+    }
+
+    ///
+    /// Returns the number of non-overlapping occurrences of a substring (0 for an empty substring).
+    ///
+    constexpr usize count(StringRef substr) const
+    {
+        usize n = 0;
+        findAll(substr, [&](usize) { n++; });
+        return n;
+    }
+
     ///
     /// Compare two strings, ignoring case.
     ///
 
     ///
-    /// The hash
+    /// The hash. Covers the same characters as equals() does (including the null terminator), and gives the same result
+    /// as hashing the string as a C string, without having to find its length again.
     ///
     template<typename Hasher>
-    constexpr auto hash(auto seed)
+    constexpr auto hash(auto seed) const
     {
         // (do not use memory address for seed -- otherwise equivalent strings could produce different hash values!!
-        return Hasher::hashCString(this->data(), seed);
+        return Hasher::hashBytes(this->data(), Base::length(), seed);
     }
 };
 
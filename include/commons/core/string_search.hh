@@ -0,0 +1,271 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "core.hh" instead
+#else
+UNSAFE_BEGIN;
+
+
+namespace cm::impl {
+
+constexpr inline usize NOT_FOUND = ~usize(0);
+
+///
+/// Needles at least this long are searched for with Two-Way. Shorter ones go through the SIMD filter, whose worst case
+/// is proportional to the needle length for every position (text that repeats the needle's first and last characters
+/// everywhere), which only stays cheap while the needle is short.
+///
+constexpr inline usize TWO_WAY_MIN_NEEDLE = 32;
+
+///
+/// Finds the first occurrence of a needle with the first/last character filter: a chunk of positions is checked at
+/// once by comparing the chunk at each position with the first character of the needle and the chunk m - 1 further
+/// on with the last character, and only positions where both match are compared in full.
+///
+inline usize findShort(char const* hay, usize n, char const* needle, usize m)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    auto first = MemoryChunk{} + u8(needle[0]);
+    auto last = MemoryChunk{} + u8(needle[m - 1]);
+    usize i = 0;
+    for (; i + m - 1 + C <= n; i += C) {
+        auto a = loadBytes<C>(hay + i);
+        auto b = loadBytes<C>(hay + i + m - 1);
+        for (u32 mask = byteMask((a == first) & (b == last)); mask != 0; mask &= mask - 1) {
+            usize candidate = i + u32(__builtin_ctz(mask));
+            if (__builtin_memcmp(hay + candidate, needle, m) == 0) {
+                return candidate;
+            }
+        }
+    }
+    for (; i + m <= n; i++) {
+        if (hay[i] == needle[0] && __builtin_memcmp(hay + i, needle, m) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+///
+/// Finds the last occurrence of a needle with the same filter as findShort, walking the chunks backwards.
+///
+inline usize rfindShort(char const* hay, usize n, char const* needle, usize m)
+{
+    constexpr usize C = MEMORY_CHUNK;
+    auto first = MemoryChunk{} + u8(needle[0]);
+    auto last = MemoryChunk{} + u8(needle[m - 1]);
+    // Positions [0, end) have not been checked yet
+    usize end = n - m + 1;
+    for (; end >= C; end -= C) {
+        auto a = loadBytes<C>(hay + end - C);
+        auto b = loadBytes<C>(hay + end - C + m - 1);
+        for (u32 mask = byteMask((a == first) & (b == last)); mask != 0;) {
+            u32 bit = 31 - u32(__builtin_clz(mask));
+            usize candidate = end - C + bit;
+            if (__builtin_memcmp(hay + candidate, needle, m) == 0) {
+                return candidate;
+            }
+            mask &= ~(u32(1) << bit);
+        }
+    }
+    while (end-- != 0) {
+        if (hay[end] == needle[0] && __builtin_memcmp(hay + end, needle, m) == 0) {
+            return end;
+        }
+    }
+    return NOT_FOUND;
+}
+
+///
+/// The Two-Way string matching algorithm (Crochemore & Perrin): the needle is split at a critical factorization into
+/// a left and a right part, the right part is matched left to right and then the left part right to left, and after a
+/// mismatch the search shifts by an amount that never skips a match. That takes linear time and constant space.
+/// With REVERSE, the needle and the haystack are both read back to front, which finds the last occurrence.
+///
+template<bool REVERSE>
+class TwoWaySearcher
+{
+    char const* _needle;
+    isize _m;
+    // The last index of the left part of the factorization (-1 if it is empty)
+    isize _split;
+    isize _period;
+    // The needle is periodic (the left part is a suffix of the right part's period), which lets the search remember
+    // how much of the needle already matched after a shift by the period
+    bool _periodic;
+
+    constexpr u8 needleAt(isize i) const { return u8(_needle[REVERSE ? _m - 1 - i : i]); }
+
+    ///
+    /// Computes the maximal suffix of the needle for one of the two orderings of the alphabet, and its period.
+    ///
+    constexpr void maximalSuffix(bool invertOrder, isize& suffix, isize& period) const
+    {
+        isize ms = -1;
+        isize j = 0;
+        isize k = 1;
+        isize p = 1;
+        while (j + k < _m) {
+            u8 a = needleAt(j + k);
+            u8 b = needleAt(ms + k);
+            if (invertOrder ? a > b : a < b) {
+                j += k;
+                k = 1;
+                p = j - ms;
+            } else if (a == b) {
+                if (k != p) {
+                    k++;
+                } else {
+                    j += p;
+                    k = 1;
+                }
+            } else {
+                ms = j;
+                j = ms + 1;
+                k = p = 1;
+            }
+        }
+        suffix = ms;
+        period = p;
+    }
+
+public:
+    constexpr TwoWaySearcher(char const* needle, usize m)
+        : _needle(needle), _m(isize(m))
+    {
+        isize suffix1, period1, suffix2, period2;
+        maximalSuffix(false, suffix1, period1);
+        maximalSuffix(true, suffix2, period2);
+        _split = suffix1 > suffix2 ? suffix1 : suffix2;
+        _period = suffix1 > suffix2 ? period1 : period2;
+        _periodic = true;
+        for (isize i = 0; i <= _split; i++) {
+            if (needleAt(i) != needleAt(i + _period)) {
+                _periodic = false;
+                break;
+            }
+        }
+        if (!_periodic) {
+            // Any shift up to the longer part is safe
+            isize longer = _split + 1 > _m - _split - 1 ? _split + 1 : _m - _split - 1;
+            _period = longer + 1;
+        }
+    }
+
+    ///
+    /// Returns the index of the first occurrence of the needle in the n characters of hay (counting from the end with
+    /// REVERSE, i.e. the match is at hay[n - m - index]), or NOT_FOUND.
+    ///
+    constexpr usize search(char const* hay, usize n) const
+    {
+        auto hayAt = [&](isize i) { return u8(hay[REVERSE ? isize(n) - 1 - i : i]); };
+        // The needle characters [0, memory] are known to match at position j, after a shift by the period
+        isize memory = -1;
+        for (isize j = 0; j <= isize(n) - _m;) {
+            isize i = (_split > memory ? _split : memory) + 1;
+            while (i < _m && needleAt(i) == hayAt(i + j)) {
+                i++;
+            }
+            if (i < _m) {
+                j += i - _split;
+                memory = -1;
+                continue;
+            }
+            i = _split;
+            while (i > memory && needleAt(i) == hayAt(i + j)) {
+                i--;
+            }
+            if (i <= memory) {
+                return usize(j);
+            }
+            j += _period;
+            memory = _periodic ? _m - _period - 1 : -1;
+        }
+        return NOT_FOUND;
+    }
+};
+
+///
+/// Returns the index of the first occurrence of a needle in hay, or NOT_FOUND. An empty needle is found at 0.
+///
+constexpr usize findSubstring(char const* hay, usize n, char const* needle, usize m)
+{
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return NOT_FOUND;
+    }
+    if !consteval {
+        if (m < TWO_WAY_MIN_NEEDLE) {
+            return findShort(hay, n, needle, m);
+        }
+    }
+    return TwoWaySearcher<false>(needle, m).search(hay, n);
+}
+
+///
+/// Returns the index of the last occurrence of a needle in hay, or NOT_FOUND. An empty needle is found at n.
+///
+constexpr usize rfindSubstring(char const* hay, usize n, char const* needle, usize m)
+{
+    if (m == 0) {
+        return n;
+    }
+    if (m > n) {
+        return NOT_FOUND;
+    }
+    if !consteval {
+        if (m < TWO_WAY_MIN_NEEDLE) {
+            return rfindShort(hay, n, needle, m);
+        }
+    }
+    usize index = TwoWaySearcher<true>(needle, m).search(hay, n);
+    return index == NOT_FOUND ? NOT_FOUND : n - m - index;
+}
+
+///
+/// Calls func(index) for every occurrence of a non-empty needle in hay that does not overlap the previous one, from
+/// left to right. The needle is factorized once for the whole scan.
+///
+constexpr void forEachSubstring(char const* hay, usize n, char const* needle, usize m, auto const& func)
+{
+    if (m == 0 || m > n) {
+        return;
+    }
+    TwoWaySearcher<false> twoWay(needle, m);
+    auto search = [&](usize from) -> usize {
+        if !consteval {
+            if (m < TWO_WAY_MIN_NEEDLE) {
+                return findShort(hay + from, n - from, needle, m);
+            }
+        }
+        return twoWay.search(hay + from, n - from);
+    };
+    for (usize from = 0; from + m <= n;) {
+        usize index = search(from);
+        if (index == NOT_FOUND) {
+            return;
+        }
+        func(from + index);
+        from += index + m;
+    }
+}
+
+}  // namespace cm::impl
+
+UNSAFE_END;
+#endif
@@ -49,6 +49,34 @@ struct ArrayBase<T, ARRAY_LENGTH_UNSPECIFIED>
 {
     T* _data = nullptr;
     usize _length = 0;
+    Allocator _alloc;
+
+    ///
+    /// Allocates storage for len value-initialized elements from the array's allocator.
+    ///
+    void _allocate(usize len)
+    {
+        _data = _alloc.template allocateArray<T>(len);
+        _length = len;
+        for (usize i = 0; i < len; i++) {
+            new (&_data[i]) T{};
+        }
+    }
+
+    ///
+    /// Destroys the elements and gives the storage back to the array's allocator.
+    ///
+    void _free()
+    {
+        if (_data) {
+            for (usize i = 0; i < _length; i++) {
+                _data[i].~T();
+            }
+            _alloc.deallocateArray(_data, _length);
+        }
+        _data = nullptr;
+        _length = 0;
+    }
 };
 
 ///
@@ -77,9 +105,7 @@ public:
     ~Array()
     {
         if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
-            if (Base::_data) {
-                delete[] Base::_data;
-            }
+            Base::_free();
         }
     }
 
@@ -88,9 +114,16 @@ public:
     ///
     Array(Index const& len) requires ((L == ARRAY_LENGTH_UNSPECIFIED))
     {
-        usize len_ = len.assertPositive();
-        Base::_data = new T[len_]{};
-        Base::_length = len_;
+        Base::_allocate(len.assertPositive());
+    }
+
+    ///
+    /// Initialize an array with a predetermined variable length, taking its storage from the given allocator
+    ///
+    Array(Index const& len, Allocator const& alloc) requires ((L == ARRAY_LENGTH_UNSPECIFIED))
+    {
+        Base::_alloc = alloc;
+        Base::_allocate(len.assertPositive());
     }
 
     ///
@@ -99,8 +132,7 @@ public:
     Array(T* ptr, usize len)
     {
         if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
-            Base::_data = new T[len];
-            Base::_length = len;
+            Base::_allocate(len);
             for (usize i = 0; i < len; i++)
                 Base::_data[i] = ptr[i];
 
@@ -116,8 +148,7 @@ public:
     Array(::std::initializer_list<T> const& v)
     {
         if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
-            Base::_data = new T[v.size()];
-            Base::_length = v.size();
+            Base::_allocate(v.size());
         } else {
             Assert(v.size() <= L, ASMS_INVALID(v));
         }
@@ -132,8 +163,7 @@ public:
     Array(T const (&values)[N])
     {
         if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
-            Base::_data = new T[N];
-            Base::_length = N;
+            Base::_allocate(N);
         } else {
             static_assert(N <= L, "Too large");
         }
@@ -147,8 +177,7 @@ public:
     Array(Array<T, L> const& other)
     {
         if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
-            Base::_data = new T[other.length()];
-            Base::_length = other.length();
+            Base::_allocate(other.length());
         }
         for (usize i = 0; i < other.length(); i++) {
             Base::_data[i] = other._data[i];
@@ -160,10 +189,17 @@ public:
     ///
     constexpr Array(Array<T, L>&& other) noexcept
     {
-        Base::_data = other._data;
-        Base::_length = other._length;
-        other._data = nullptr;
-        other._length = 0;
+        if constexpr (L == ARRAY_LENGTH_UNSPECIFIED) {
+            Base::_data = other._data;
+            Base::_length = other._length;
+            Base::_alloc = other._alloc;
+            other._data = nullptr;
+            other._length = 0;
+        } else {
+            for (usize i = 0; i < L; i++) {
+                Base::_data[i] = static_cast<T&&>(other._data[i]);
+            }
+        }
     }
 
     ///
@@ -182,7 +218,7 @@ public:
     constexpr Array& operator=(Array<T, L>&& other)
     {
         this->~Array<T, L>();
-        new (this) Array<T, L>(other);
+        new (this) Array<T, L>(static_cast<Array<T, L>&&>(other));
         return *this;
     }
 
@@ -20,151 +20,365 @@
 
 namespace cm {
 
+namespace impl {
+///
+/// The words of a ByteVector whose contents are not stored inline. The inline contents are stored over them.
+///
+struct ByteVectorWords
+{
+    u8* data;
+    usize length;
+    usize capacity;
+};
+
+///
+/// Returns the size of the storage of a ByteVector with N bytes of inline capacity: the inline bytes and a tag byte,
+/// and at least as much as the words they are stored over.
+///
+template<usize N>
+consteval usize byteVectorStorageSize()
+{
+    return alignUp(max(sizeof(ByteVectorWords), N + 1), alignof(ByteVectorWords));
+}
+}  // namespace impl
+
+
 ///
 /// A structure that functions similarly to a std::vector<unsigned char>.
 /// Its purpose is to implement a "growable" piece of contiguous memory.
 /// For a typed equivalent (the closest thing to std::vector<T>), see StructVector<T> below.
 ///
-struct ByteVector : IEquatable<ByteVector>
+/// @tparam InlineCapacity The number of bytes that are stored inside the object itself. As long as the contents fit,
+/// nothing is allocated; the buffer only moves to the allocator once it grows past that. Use ByteVector for no inline
+/// storage and SmallByteVector<N> for N bytes of it.
+///
+/// The inline bytes are stored over the pointer, length and capacity words, the way small-string optimizations do, so
+/// they take no room of their own up to 23 bytes. The last byte of the storage is the tag: for inline contents it is
+/// INLINE_TAG plus the length, otherwise it holds the NEEDHEAP_TAG and SHARED_TAG flags. With 23 bytes or fewer of
+/// inline capacity, the tag is the top byte of the capacity word, which limits capacities to 56 bits.
+///
+/// A heap buffer can also be made shared with share(): it is then reference counted, copies of the vector point to the
+/// same buffer, and the buffer is only cloned when one of the copies is modified (just like NEEDHEAP_TAG does for data
+/// in .rodata).
+///
+template<usize InlineCapacity>
+struct BasicByteVector : IEquatable<BasicByteVector<InlineCapacity>>
 {
+    static_assert(InlineCapacity < 128, "The length of inline contents must fit in the 7 low bits of the tag");
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The tag must be the top byte of the capacity word");
+
 private:
-    u8* _data;
-    usize _length;
-    usize _capacity;
-    bool _needheap;
+    constexpr static u8 INLINE_TAG = 0x80;
+    constexpr static u8 NEEDHEAP_TAG = 0x01;  // The buffer is in .rodata, and is copied before it is modified
+    constexpr static u8 SHARED_TAG = 0x02;    // The buffer is reference counted (see share())
+    constexpr static usize STORAGE_SIZE = impl::byteVectorStorageSize<InlineCapacity>();
+    constexpr static usize CAPACITY_MASK = (usize(1) << 56) - 1;
+
+    union
+    {
+        impl::ByteVectorWords _words;
+        u8 _bytes[STORAGE_SIZE] = {};
+    };
+    Allocator _alloc;
+
+    ///
+    /// Placed in front of the data of a shared buffer. It records the allocator the buffer came from, since the copies
+    /// sharing it may each have a different one.
+    ///
+    struct alignas(16) SharedHeader
+    {
+        usize refcount;
+        usize capacity;
+        Allocator alloc;
+    };
+
+    FORCEINLINE static SharedHeader* _sharedHeader(u8* data)
+    {
+        return UNSAFE(reinterpret_cast<SharedHeader*>(data - sizeof(SharedHeader)));
+    }
+
+    ///
+    /// Drops a reference to a shared buffer, freeing the buffer if it was the last one.
+    ///
+    static void _releaseShared(u8* data)
+    {
+        auto* header = _sharedHeader(data);
+        if (__atomic_sub_fetch(&header->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+            auto alloc = header->alloc;
+            alloc.deallocate(header, sizeof(SharedHeader) + header->capacity, alignof(SharedHeader));
+        }
+    }
+
+    FORCEINLINE u8 _tag() const { return UNSAFE(_bytes[STORAGE_SIZE - 1]); }
+    FORCEINLINE void _setTag(u8 tag) { UNSAFE(_bytes[STORAGE_SIZE - 1] = tag); }
+
+    FORCEINLINE bool _isInline() const
+    {
+        if constexpr (InlineCapacity > 0) {
+            return (_tag() & INLINE_TAG) != 0;
+        } else {
+            return false;
+        }
+    }
+
+    FORCEINLINE bool _needsHeap() const { return (_tag() & (INLINE_TAG | NEEDHEAP_TAG)) == NEEDHEAP_TAG; }
+    FORCEINLINE bool _isShared() const { return (_tag() & (INLINE_TAG | SHARED_TAG)) == SHARED_TAG; }
+
+    FORCEINLINE u8* _ptr() { return _isInline() ? &_bytes[0] : _words.data; }
+    FORCEINLINE u8 const* _ptr() const { return _isInline() ? &_bytes[0] : _words.data; }
+    FORCEINLINE usize _len() const { return _isInline() ? usize(_tag() & ~INLINE_TAG) : _words.length; }
+    FORCEINLINE usize _cap() const { return _isInline() ? InlineCapacity : _words.capacity & CAPACITY_MASK; }
+
+    FORCEINLINE void _setLength(usize length)
+    {
+        if (_isInline()) {
+            _setTag(u8(INLINE_TAG | length));
+        } else {
+            _words.length = length;
+        }
+    }
+
+    ///
+    /// Points the vector at a buffer that is not stored inline. The tag is set after the words, since with a small
+    /// inline capacity it is part of them.
+    ///
+    FORCEINLINE void _setWords(u8* data, usize length, usize capacity, u8 tag)
+    {
+        _words = {data, length, capacity};
+        _setTag(tag);
+    }
+
+    ///
+    /// Returns true if the buffer came from the allocator (as opposed to .rodata or the inline storage).
+    ///
+    FORCEINLINE bool _ownsBuffer() const
+    {
+        return !_isInline() && _words.data != nullptr && (_tag() & (NEEDHEAP_TAG | SHARED_TAG)) == 0;
+    }
+
+    ///
+    /// Gives this vector its own copy of a shared buffer, before it is modified.
+    ///
+    [[clang::noinline]]
+    void _unshare()
+    {
+        auto* shared = _words.data;
+        auto capacity = _cap();
+        auto* data = _alloc.allocateArray<u8>(capacity);
+        if constexpr (HeapStats::ENABLED) {
+            HeapStats::recordCallSite(capacity);
+        }
+        UNSAFE(memcpy(data, shared, _words.length));
+        _setWords(data, _words.length, capacity, 0);
+        _releaseShared(shared);
+    }
 
     UNSAFE_BEGIN void _ensureDataOnHeap()
     {
-        if (!_needheap)
+        if (_isShared()) [[unlikely]] {
+            _unshare();
             return;
-        Assert(Ptr::isRomData(_data), ASMS_BAD_CIRCUMSTANCE);
-        auto old = _data;
-        _data = new u8[_capacity];
-        memmove(_data, old, _capacity);
-        _needheap = false;
+        }
+        if (!_needsHeap())
+            return;
+        Assert(Ptr::isRomData(_words.data), ASMS_BAD_CIRCUMSTANCE);
+        auto* old = _words.data;
+        auto length = _words.length;
+        if (length <= InlineCapacity) {
+            memcpy(&_bytes[0], old, length);
+            _setTag(u8(INLINE_TAG | length));
+        } else {
+            auto capacity = _cap();
+            auto* data = _alloc.allocateArray<u8>(capacity);
+            if constexpr (HeapStats::ENABLED) {
+                HeapStats::recordCallSite(capacity);
+            }
+            memcpy(data, old, length);
+            _setWords(data, length, capacity, 0);
+        }
         UNSAFE_END;
     }
 
-    UNSAFE_BEGIN void _reallocate()
+    UNSAFE_BEGIN void _reallocate(usize newCapacity)
     {
-        Assert(_capacity > 0, ASMS_BUG);
-        auto old = _data;
-        _data = new u8[size_t(_capacity)];
-        memmove(_data, old, _length);
-        delete[] old;
+        Assert(newCapacity > 0 && newCapacity <= CAPACITY_MASK, ASMS_BUG);
+        auto* old = _ptr();
+        auto length = _len();
+        auto oldCapacity = _cap();
+        auto ownedOld = _ownsBuffer();
+        if (newCapacity <= InlineCapacity) {
+            if (_isInline()) {
+                return;
+            }
+            if (old != nullptr) {
+                memmove(&_bytes[0], old, length);
+            }
+            _setTag(u8(INLINE_TAG | length));
+        } else {
+            auto* data = _alloc.allocateArray<u8>(newCapacity);
+            if constexpr (HeapStats::ENABLED) {
+                HeapStats::recordCallSite(newCapacity);
+            }
+            if (old != nullptr) {
+                memcpy(data, old, length);
+            }
+            _setWords(data, length, newCapacity, 0);
+        }
+        if (ownedOld) {
+            _alloc.deallocateArray(old, oldCapacity);
+        }
         UNSAFE_END;
     }
 
+    ///
+    /// Makes room for nBytes more bytes, growing the capacity by at least 1.5x so that appends are amortized O(1).
+    /// Contents that fit the inline capacity are stored inline, without the slack (an empty vector is not inline yet).
+    ///
+    FORCEINLINE void _growFor(usize nBytes)
+    {
+        auto capacity = _cap();
+        if (_len() + nBytes > capacity) [[unlikely]] {
+            auto newCapacity = capacity + (capacity / 2);
+            if (newCapacity < capacity + nBytes) {
+                newCapacity += nBytes + 2;
+            }
+            if (_len() + nBytes <= InlineCapacity) {
+                newCapacity = InlineCapacity;
+            }
+            _reallocate(newCapacity);
+        }
+    }
+
 public:
-    constexpr ByteVector() = default;
+    constexpr BasicByteVector() = default;
+
+    ///
+    /// Creates an empty vector whose buffer is taken from the given allocator.
+    ///
+    constexpr explicit BasicByteVector(Allocator const& alloc)
+        : _alloc(alloc)
+    {}
 
     ///
     /// Initialize from region of memory
     ///
-    inline ByteVector(void const* ptr, usize len) noexcept
+    inline BasicByteVector(void const* ptr, usize len, Allocator const& alloc = {}) noexcept
+        : _alloc(alloc)
     {
         Assert(ptr, ASMS_INVALID(ptr));
         Assert(len, ASMS_INVALID(len));
         if (Ptr::isRomData(ptr)) {
             // This optimization (checking if the pointer has infinite lifetime) means it is unnecessary to make a copy
             // of the data (until it gets modified, then make a copy)
-            _data = static_cast<u8*>(const_cast<void*>(ptr));
-            _length = _capacity = len;
-            _needheap = true;
+            _setWords(static_cast<u8*>(const_cast<void*>(ptr)), len, len, NEEDHEAP_TAG);
         } else {
             insert(0, ptr, len);
         }
     }
 
     ///
-    /// Copy constructor
+    /// Copy constructor. The copy uses the given allocator (by default the heap), not the allocator of the original,
+    /// since the original's allocator may not live as long as the copy.
     ///
-    inline ByteVector(ByteVector const& other) noexcept
+    inline BasicByteVector(BasicByteVector const& other, Allocator const& alloc = {}) noexcept
+        : _alloc(alloc)
     {
-        if (other._data) {
-            if (Ptr::isRomData(other._data)) {
-                _data = const_cast<u8*>(other._data);
-                _length = _capacity = other._length;
-                _needheap = true;
-            } else {
-                insert(0, other._data, other._length);
-            }
+        if (other._isShared()) {
+            __atomic_add_fetch(&_sharedHeader(other._words.data)->refcount, 1, __ATOMIC_RELAXED);
+            _setWords(other._words.data, other._words.length, other._cap(), SHARED_TAG);
+        } else if (auto* data = other._ptr(); data != nullptr && Ptr::isRomData(data)) {
+            _setWords(const_cast<u8*>(data), other._len(), other._len(), NEEDHEAP_TAG);
+        } else if (data != nullptr) {
+            insert(0, data, other._len());
         }
     }
 
     ///
-    /// Move constructor
+    /// Move constructor. The buffer is taken over together with the allocator it came from. Since nothing points into
+    /// the object itself, inline contents move with a copy of the storage.
     ///
-    inline ByteVector(ByteVector&& other) noexcept
+    inline BasicByteVector(BasicByteVector&& other) noexcept
+        : _alloc(other._alloc)
     {
-        _data = other._data;
-        _length = other._length;
-        _capacity = other._capacity;
-        _needheap = other._needheap;
-        other._data = nullptr;
+        UNSAFE(memcpy(&_bytes[0], &other._bytes[0], STORAGE_SIZE));
+        other._setWords(nullptr, 0, 0, 0);
     }
 
     ///
     /// Copy assignment
     ///
-    inline ByteVector& operator=(ByteVector const& other) noexcept
+    inline BasicByteVector& operator=(BasicByteVector const& other) noexcept
     {
-        clear();
-        new (this) ByteVector(other);
+        if (this != &other) {
+            auto alloc = _alloc;
+            clear();
+            new (this) BasicByteVector(other, alloc);
+        }
         return *this;
     }
 
     ///
     /// Move assignment
     ///
-    inline ByteVector& operator=(ByteVector&& other) noexcept
+    inline BasicByteVector& operator=(BasicByteVector&& other) noexcept
     {
-        clear();
-        new (this) ByteVector(other);
+        if (this != &other) {
+            clear();
+            new (this) BasicByteVector(static_cast<BasicByteVector&&>(other));
+        }
         return *this;
     }
 
     ///
     /// Destructor
     ///
-    inline ~ByteVector() { clear(); }
+    inline ~BasicByteVector() { clear(); }
 
     ///
     ///
     ///
-    inline bool equals(ByteVector const& other) const
+    inline bool equals(BasicByteVector const& other) const
     {
         if (this == &other)
             return true;
         if (length() != other.length())
             return false;
-        return ArrayRef<u8>(this->_data, this->length()).equals(ArrayRef<u8>(other._data, other.length()));
+        return ArrayRef<u8>(_ptr(), length()).equals(ArrayRef<u8>(other._ptr(), other.length()));
     }
 
     void append(u8 byte);
-    void append(ByteVector const& other);
+    void append(BasicByteVector const& other);
 
     UNSAFE_BEGIN void insert(size_t index, void const* bytes, size_t nBytes)
     {
-        Assert(index <= _length, ASMS_INVALID(index));
+        Assert(index <= _len(), ASMS_INVALID(index));
         Assert(bytes, ASMS_INVALID(bytes));
         if (nBytes == 0) {
             return;
         }
         _ensureDataOnHeap();
-        if (_length + nBytes >= _capacity) {
-            auto prevCapacity = _capacity;
-            _capacity = _capacity + (_capacity / 2);
-            if (_capacity < prevCapacity + nBytes) {
-                _capacity += nBytes + 2;
-            }
-            _reallocate();
-        }
-        _length += nBytes;
+        _growFor(nBytes);
+        auto length = _len() + nBytes;
+        _setLength(length);
+        auto* data = _ptr();
         // Shift elements after index forward to make room for the new elements
-        memmove(&_data[index + nBytes], &_data[index], (_length - (index + nBytes)));
+        memmove(&data[index + nBytes], &data[index], (length - (index + nBytes)));
         // Copy values into array buffer
-        memmove(&_data[index], bytes, nBytes);
+        memmove(&data[index], bytes, nBytes);
+        UNSAFE_END;
+    }
+
+    ///
+    /// Lengthens the vector by nBytes and returns a pointer to the new bytes, which are left uninitialized for the
+    /// caller to write into.
+    ///
+    UNSAFE_BEGIN u8* extend(usize nBytes)
+    {
+        _ensureDataOnHeap();
+        _growFor(nBytes);
+        auto length = _len();
+        _setLength(length + nBytes);
+        return _ptr() + length;
         UNSAFE_END;
     }
 
@@ -172,33 +386,97 @@ public:
     {
         Assert(size_t((index + nBytes)) <= length());
         _ensureDataOnHeap();
+        auto* data = _ptr();
+        auto length = _len();
         // Shift elements backwards into the space erased from
-        memmove(&_data[index], &_data[index + nBytes], _length - (index + nBytes));
+        memmove(&data[index], &data[index + nBytes], length - (index + nBytes));
         // Refill the new space created at the end of the buffer with zeros
-        memset(&_data[_length - nBytes], 0, nBytes);
-        _length -= nBytes;
-        if (_length > 16 && _length < (_capacity / 4)) {
-            _capacity = max(16u, _capacity / 2);
-            _reallocate();
+        memset(&data[length - nBytes], 0, nBytes);
+        _setLength(length - nBytes);
+        if (length - nBytes > 16 && length - nBytes < (_cap() / 4)) {
+            _reallocate(max(usize(16), _cap() / 2));
+        }
+        UNSAFE_END;
+    }
+
+    ///
+    /// Makes sure that the buffer can hold at least `capacity` bytes without reallocating.
+    ///
+    void reserve(usize capacity)
+    {
+        _ensureDataOnHeap();
+        if (capacity > _cap()) {
+            _reallocate(capacity);
+        }
+    }
+
+    ///
+    /// Moves the contents into a reference-counted buffer, so that copying this vector (and copying the copies) takes
+    /// constant time until one of them is modified. Does nothing for contents that are in .rodata or stored inline.
+    ///
+    void share()
+    {
+        if (!_ownsBuffer()) {
+            return;
         }
+        UNSAFE_BEGIN;
+        auto capacity = _cap();
+        auto* header =
+            static_cast<SharedHeader*>(_alloc.allocate(sizeof(SharedHeader) + capacity, alignof(SharedHeader)));
+        header->refcount = 1;
+        header->capacity = capacity;
+        header->alloc = _alloc;
+        auto* data = reinterpret_cast<u8*>(header) + sizeof(SharedHeader);
+        memcpy(data, _words.data, _words.length);
+        _alloc.deallocateArray(_words.data, capacity);
+        _setWords(data, _words.length, capacity, SHARED_TAG);
         UNSAFE_END;
     }
 
+    ///
+    /// Returns true if the buffer is shared with other vectors (see share()).
+    ///
+    FORCEINLINE bool isShared() const { return _isShared(); }
+
     void clear()
     {
-        if (!_needheap && _data)
-            delete[] _data;
-        _capacity = 0;
-        _length = 0;
-        _data = nullptr;
+        if (_isShared())
+            _releaseShared(_words.data);
+        else if (_ownsBuffer())
+            _alloc.deallocateArray(_words.data, _cap());
+        _setWords(nullptr, 0, 0, 0);
     }
 
-    FORCEINLINE size_t length() const { return _length; }
-    FORCEINLINE bool empty() const { return _length == 0; }
-    FORCEINLINE u8 const* data() const { return _data; }
-    FORCEINLINE u8* data() { return _data; }
+    FORCEINLINE size_t length() const { return _len(); }
+    FORCEINLINE bool empty() const { return _len() == 0; }
+    FORCEINLINE u8 const* data() const { return _ptr(); }
+    ///
+    /// Returns the buffer for modification, first making a private copy if it is shared or in .rodata.
+    ///
+    FORCEINLINE u8* data()
+    {
+        _ensureDataOnHeap();
+        return _ptr();
+    }
+    FORCEINLINE size_t capacity() const { return _cap(); }
+    FORCEINLINE bool isInline() const { return _isInline(); }
+    FORCEINLINE Allocator const& allocator() const { return _alloc; }
 };
 
+static_assert(sizeof(BasicByteVector<0>) == sizeof(impl::ByteVectorWords) + sizeof(Allocator));
+static_assert(sizeof(BasicByteVector<23>) == sizeof(impl::ByteVectorWords) + sizeof(Allocator));
+
+///
+/// A ByteVector without inline storage.
+///
+using ByteVector = BasicByteVector<0>;
+
+///
+/// A ByteVector that stores up to N bytes inside the object before it allocates.
+///
+template<usize N>
+using SmallByteVector = BasicByteVector<N>;
+
 
 ///
 /// @brief StructVector is a "growable" piece of contiguous memory like ByteVector, except it is specialized to hold
@@ -132,16 +132,39 @@ struct Join
     auto join(auto const& delim) const
     {
         ElementType result;
-        auto derived = static_cast<Derived<ElementType> const&>(*this);
+        auto const& derived = static_cast<Derived<ElementType> const&>(*this);
         auto i = 0ull;
 
-        derived.forEach([&](ElementType const& e) {
-            result += e;
-            if (i < derived.length() - 1) {
-                result += delim;
+        // Strings (and anything else that can reserve capacity) are sized up front, so that the result is allocated
+        // once instead of growing with every element
+        if constexpr (requires(ElementType& r, ElementType const& e) {
+                          r.reserve(e.length());
+                          r.append(e);
+                          r.append(delim);
+                          StringRef(delim);
+                      }) {
+            usize total = 0;
+            derived.forEach([&](ElementType const& e) { total += e.length(); });
+            if (derived.length() > 1) {
+                total += (derived.length() - 1) * StringRef(delim).length();
             }
-            i++;
-        });
+            result.reserve(total);
+            derived.forEach([&](ElementType const& e) {
+                result.append(e);
+                if (i < derived.length() - 1) {
+                    result.append(delim);
+                }
+                i++;
+            });
+        } else {
+            derived.forEach([&](ElementType const& e) {
+                result += e;
+                if (i < derived.length() - 1) {
+                    result += delim;
+                }
+                i++;
+            });
+        }
         // if (static_cast<Derived<ElementType> const&>(*this).length() != 0) {
         //     auto last = static_cast<Derived<ElementType> const&>(*this).end();
         //     auto it = static_cast<Derived<ElementType> const&>(*this).begin();
@@ -62,61 +62,79 @@ struct FixGotchaType<char const (&)[N]>
 template<typename T>
 using FixGotchaType = typename ::cm::impl::FixGotchaType<T>::Type;
 
+UNSAFE_BEGIN;
+
 /**
  * A fixed-capacity container of key value pairs.
- * Keys are mapped to values with a provided hash function, and uses open addressing to resolve hash collisions.
+ * Keys are mapped to values with a provided hash function. A map that is built in a constant expression, e.g.
+ *
+ *     constexpr auto map = FixedMap("hello", 1, "bob", 2);
+ *
+ * finds a minimal perfect hash for its keys while it is compiled, so that a lookup is one hash, one index and one key
+ * comparison. A map built at runtime (or given a key after it was built) uses open addressing to resolve hash
+ * collisions instead.
  * @tparam K The type of key
  * @tparam V The type of value
  * @tparam N The capacity (maximum number of key value pairs that can be stored)
+ * @tparam Hasher The hasher the keys are hashed with through Hash<Hasher> (e.g. Crc32, WyHash or Xxh3)
  */
-template<typename K, typename V, unsigned N>
+template<typename K, typename V, unsigned N, typename Hasher = Crc32>
 struct FixedMap
 {
 private:
-    Array<Optional<Tuple<K, V>>, N> _table;
+    // The displacement table has a bucket for about every two keys
+    constexpr static unsigned BUCKETS = (N + 1) / 2;
 
+    Pair<K, V> _entries[N]{};
+    bool _full[N]{};
+    u16 _pilots[BUCKETS]{};
+    bool _perfect = false;
 
 public:
-    using HashFunction = CFunction<u32(K const&)>;
-    constexpr static u32 defaultHashFunction(K const& k) { return Hash<Crc32>::hash(k); };
+    using HashResult = Hash<Hasher>::HashResult;
+    using HashFunction = CFunction<HashResult(K const&)>;
+    constexpr static HashResult defaultHashFunction(K const& k) { return Hash<Hasher>::hash(k); };
     constexpr static HashFunction _hashFunc = defaultHashFunction;
 
     ///
     /// Initialize a FixedMap from an argument list of key-value pairs.
     /// The order of the arguments goes like this: (key, value, key, value, key, value, ...)
     /// If the template parameter N is not specified in the type signature, the capacity of the map will be equal to
-    /// however many key-value pairs were listed.
+    /// however many key-value pairs were listed. If a key is listed more than once, the last value listed is kept.
     ///
     template<typename... Args>
     requires ((sizeof...(Args) % 2) == 0)
-    FixedMap(Args&&... keysValues)
+    constexpr FixedMap(Args&&... keysValues)
     {
-        auto f = [&]<int I>(this auto&& self) {
-            if constexpr (I < sizeof...(Args)) {
-                add(Tuple<K, V>(keysValues...[I], keysValues...[I + 1]));
-                self.template operator()<I + 2>();
-            }
-        };
-        f.template operator()<0>();
-    }
-
-    FixedMap(ArrayRef<Tuple<K, V>> const& tuples)
-    {
-        for (auto const& tuple : tuples) {
-            add(tuple);
+        if constexpr (sizeof...(Args) > 0) {
+            [&]<unsigned... I>(IntegerSequence<unsigned, I...>) {
+                Tuple<K, V> const tuples[] = {Tuple<K, V>(keysValues...[I * 2], keysValues...[I * 2 + 1])...};
+                _build(tuples, unsigned(sizeof...(I)));
+            }(MakeIntegerSequence<unsigned, sizeof...(Args) / 2>{});
         }
     }
 
+    constexpr FixedMap(ArrayRef<Tuple<K, V>> const& tuples) { _build(tuples.data(), unsigned(tuples.length())); }
+
     ///
     /// Access a value associated with the given key. If there is no such key-value pair, returns None
     ///
-    constexpr Optional<V> operator[](K const& key)
+    constexpr Optional<V> operator[](K const& key) const
     {
-        auto i = _hashFunc(key) % N;
-        if (!_table[i].hasValue()) {
+        auto hash = _hashFunc(key);
+        if (_perfect) {
+            auto spread = _spread(hash);
+            auto i = _slotOf(spread, _pilots[_bucketOf(spread)]);
+            if (_full[i] && _entries[i].first == key) {
+                return _entries[i].second;
+            }
             return None;
-        } else if (auto const& ref = _table[i].ref(); ref.template get<0>() == key) {
-            return ref.template get<1>();
+        }
+        auto i = unsigned(hash % N);
+        if (!_full[i]) {
+            return None;
+        } else if (_entries[i].first == key) {
+            return _entries[i].second;
         }
         auto j = i;
         auto c = 0u;
@@ -128,28 +146,36 @@ public:
             if (c == N) {
                 break;
             }
-            if (_table[j].hasValue() && _table[j].ref().template get<0>() == key) {
-                return _table[j].val().template get<1>();
+            if (_full[j] && _entries[j].first == key) {
+                return _entries[j].second;
             }
             ++c;
-        } while (_table[j].hasValue());
+        } while (_full[j]);
         return None;
     }
 
     constexpr void add(Tuple<K, V> const& tuple)
     {
         auto const& key = tuple.template get<0>();
-        auto i = _hashFunc(key) % N;
-        if (!_table[i].hasValue()) {
-            _table[i] = tuple;
+        if (_perfect) {
+            auto spread = _spread(_hashFunc(key));
+            if (auto i = _slotOf(spread, _pilots[_bucketOf(spread)]); _full[i] && _entries[i].first == key) {
+                _entries[i].second = tuple.template get<1>();
+                return;
+            }
+            _dropPerfectHash();
+        }
+        auto i = unsigned(_hashFunc(key) % N);
+        if (!_full[i]) {
+            _put(i, tuple);
             return;
         }
         // find another spot using open addressing
         auto j = i;
         auto c = 0u;
         do {
-            if (_table[j].hasValue() && key == _table[j].ref().template get<0>()) {  // Replace duplicate
-                _table[j] = tuple;
+            if (_full[j] && key == _entries[j].first) {  // Replace duplicate
+                _put(j, tuple);
                 return;
             }
             j++;
@@ -159,21 +185,163 @@ public:
             if (c == N) {
                 break;
             }
-            if (!_table[j].hasValue()) {
-                _table[j] = tuple;
+            if (!_full[j]) {
+                _put(j, tuple);
                 return;
             }
             ++c;
-        } while (_table[j].hasValue());
+        } while (_full[j]);
         // table is full
         Assert(false);
     }
 
-    constexpr auto capacity() { return N; }
+    constexpr auto capacity() const { return N; }
+
+    ///
+    /// Returns true if lookups use the perfect hash found for the keys in a constant expression, false if they use
+    /// open addressing.
+    ///
+    constexpr bool usesPerfectHash() const { return _perfect; }
 
     constexpr void add(K const& key, V const& value) { add(Tuple<K, V>(key, value)); }
+
+private:
+    constexpr void _put(unsigned i, Tuple<K, V> const& tuple)
+    {
+        _entries[i] = Pair<K, V>(tuple.template get<0>(), tuple.template get<1>());
+        _full[i] = true;
+    }
+
+    constexpr void _build(Tuple<K, V> const* tuples, unsigned count)
+    {
+        if consteval {
+            if (_buildPerfect(tuples, count)) {
+                return;
+            }
+        }
+        for (unsigned i = 0; i < count; i++) {
+            add(tuples[i]);
+        }
+    }
+
+    ///
+    /// Finds a minimal perfect hash for the keys, like PTHash does: the hash of a key picks one of the buckets, and the
+    /// pilot stored for the bucket moves the hash to a slot. The largest buckets are given pilots first, while most of
+    /// the slots are free, and each gets the first pilot that sends all of its keys to free slots. Returns false,
+    /// leaving the map empty, if the keys do not fit (e.g. two different keys with the same hash), in which case they
+    /// are added with open addressing instead.
+    ///
+    consteval bool _buildPerfect(Tuple<K, V> const* tuples, unsigned count)
+    {
+        if (count > N) {
+            return false;
+        }
+        // Sort the keys by bucket; the keys of bucket b are members[start[b]] to members[start[b] + size[b] - 1]
+        u64 spread[N]{};
+        unsigned start[BUCKETS + 1]{};
+        unsigned size[BUCKETS]{};
+        unsigned members[N]{};
+        for (unsigned i = 0; i < count; i++) {
+            spread[i] = _spread(_hashFunc(tuples[i].template get<0>()));
+            start[_bucketOf(spread[i]) + 1]++;
+        }
+        for (unsigned b = 0; b < BUCKETS; b++) {
+            start[b + 1] += start[b];
+        }
+        for (unsigned i = 0; i < count; i++) {
+            auto b = _bucketOf(spread[i]);
+            members[start[b] + size[b]++] = i;
+        }
+
+        // A key listed again is in the same bucket, later on; keep only the last one
+        unsigned largest = 0;
+        for (unsigned b = 0; b < BUCKETS; b++) {
+            size[b] = 0;
+            for (unsigned k = start[b]; k < start[b + 1]; k++) {
+                auto i = members[k];
+                auto replaced = false;
+                for (unsigned l = k + 1; l < start[b + 1] && !replaced; l++) {
+                    if (auto j = members[l]; spread[i] == spread[j]) {
+                        if (!(tuples[i].template get<0>() == tuples[j].template get<0>())) {
+                            return false;  // No pilot can send these two keys to different slots
+                        }
+                        replaced = true;
+                    }
+                }
+                if (!replaced) {
+                    members[start[b] + size[b]++] = i;
+                }
+            }
+            largest = max(largest, size[b]);
+        }
+
+        for (unsigned s = largest; s > 0; s--) {
+            for (unsigned b = 0; b < BUCKETS; b++) {
+                if (size[b] != s) {
+                    continue;
+                }
+                auto const* keys = &members[start[b]];
+                unsigned pilot = 0;
+                for (;; pilot++) {
+                    if (pilot > MAX_VALUE<u16>) {
+                        for (unsigned i = 0; i < N; i++) {
+                            _full[i] = false;
+                        }
+                        return false;
+                    }
+                    auto fits = true;
+                    for (unsigned k = 0; k < s && fits; k++) {
+                        auto slot = _slotOf(spread[keys[k]], pilot);
+                        fits = !_full[slot];
+                        for (unsigned l = 0; l < k && fits; l++) {
+                            fits = slot != _slotOf(spread[keys[l]], pilot);
+                        }
+                    }
+                    if (fits) {
+                        break;
+                    }
+                }
+                _pilots[b] = u16(pilot);
+                for (unsigned k = 0; k < s; k++) {
+                    _put(_slotOf(spread[keys[k]], pilot), tuples[keys[k]]);
+                }
+            }
+        }
+        _perfect = true;
+        return true;
+    }
+
+    ///
+    /// Lays the entries out again for open addressing, for a key that the perfect hash was not built for.
+    ///
+    constexpr void _dropPerfectHash()
+    {
+        Pair<K, V> entries[N]{};
+        unsigned count = 0;
+        for (unsigned i = 0; i < N; i++) {
+            if (_full[i]) {
+                entries[count++] = _entries[i];
+                _full[i] = false;
+            }
+        }
+        _perfect = false;
+        for (unsigned i = 0; i < count; i++) {
+            add(entries[i].first, entries[i].second);
+        }
+    }
+
+    // Spreads the hash over 64 bits, so that a 32-bit hash picks its bucket with the high bits as well as a 64-bit one
+    constexpr static u64 _spread(HashResult hash) { return u64(hash) * 0x9E3779B97F4A7C15ull; }
+
+    constexpr static unsigned _bucketOf(u64 spread) { return unsigned((spread >> 32) % BUCKETS); }
+
+    constexpr static unsigned _slotOf(u64 spread, unsigned pilot)
+    {
+        return unsigned((((spread ^ (pilot * 0xC2B2AE3D27D4EB4Full)) * 0x165667B19E3779F9ull) >> 32) % N);
+    }
 };
 
+UNSAFE_END;
 
 // template<typename T>
 // FixedMap(T&& tuple) -> FixedMap<TupleElement<T, 0>, TupleElement<T, 1>, 1>;
@@ -41,6 +41,19 @@ protected:
             Node* prev;
         };
 
+        ///
+        /// Nodes are carved out of chunks owned by the list, so that inserting and removing usually does not go to the
+        /// allocator at all. Removed nodes are kept on a free list for reuse, and the chunks are freed with the list.
+        ///
+        struct Chunk
+        {
+            Chunk* next;
+            usize sizeBytes;
+        };
+
+        constexpr static u32 FIRST_CHUNK_NODES = 8;
+        constexpr static u32 MAX_CHUNK_NODES = 1024;
+
         struct Iterator
         {
             Container* _list;
@@ -56,19 +69,41 @@ protected:
             Iterator _prev() const { return {_list, _curr->prev}; }
         };
 
+        Container(ClassRef objclass, Allocator const& alloc)
+            : _objclass(objclass), _alloc(alloc)
+        {}
+        Container(Container const&) = delete;
+        Container& operator=(Container const&) = delete;
         ~Container();
         friend struct Iterator;
 
         void clear();
+        Node* _allocateNode();
+        void _freeNode(Node* n);
+        void _growPool();
         Iterator _begin();
         Iterator _begin() const;
         Iterator _end();
         Iterator _end() const;
 
-        Node* _head;
-        Node* _tail;
+        ///
+        /// The element is stored after the node header, at an offset that respects its alignment.
+        ///
+        usize _payloadOffset() const { return alignUp(sizeof(Node), _objclass.alignBytes); }
+        usize _nodeAlignment() const { return max(usize(alignof(Node)), usize(_objclass.alignBytes)); }
+        usize _nodeStride() const { return alignUp(_payloadOffset() + _objclass.sizeBytes, _nodeAlignment()); }
+        u8* _payload(Node* n) const { return UNSAFE(reinterpret_cast<u8*>(n) + _payloadOffset()); }
+
+        Node* _head = nullptr;
+        Node* _tail = nullptr;
         ClassRef _objclass;
-        u32 _length;
+        u32 _length = 0;
+        u32 _chunkNodes = 0;          // The number of nodes in the newest chunk; each chunk is twice the previous one
+        Node* _freeNodes = nullptr;   // Removed nodes, linked through Node::next
+        Chunk* _chunks = nullptr;
+        u8* _bump = nullptr;          // Space in the newest chunk that has not been handed out yet
+        u8* _bumpEnd = nullptr;
+        Allocator _alloc;
     };
 };
 }  // namespace impl
@@ -103,7 +138,14 @@ struct DLList : protected impl::DLList::Container
     };
 
     DLList()
-        : impl::DLList::Container{{}, {}, ClassOf<T>, {}}
+        : impl::DLList::Container(ClassOf<T>, {})
+    {}
+
+    ///
+    /// Creates an empty list whose nodes are allocated from the given allocator.
+    ///
+    explicit DLList(Allocator const& alloc)
+        : impl::DLList::Container(ClassOf<T>, alloc)
     {}
 
     using impl::DLList::Container::clear;
@@ -115,9 +157,9 @@ struct DLList : protected impl::DLList::Container
     constexpr auto end() const { return Iterator(this, nullptr); }
 
     constexpr auto const& first() const { return *begin(); }
-    constexpr auto const& last() const { return *end().prev(); }
+    constexpr auto const& last() const { return *Iterator(this, _tail); }
     constexpr auto& first() { return *begin(); }
-    constexpr auto& last() { return *end().prev(); }
+    constexpr auto& last() { return *Iterator(this, _tail); }
 
     constexpr auto forEach(auto func)
     {
@@ -134,7 +176,15 @@ namespace cm::impl {
 
 /*
  */
-inline DLList::Container::~Container() { clear(); }
+inline DLList::Container::~Container()
+{
+    clear();
+    for (auto c = _chunks; c != nullptr;) {
+        auto tmp = c->next;
+        _alloc.deallocate(c, c->sizeBytes, max(usize(alignof(Chunk)), _nodeAlignment()));
+        c = tmp;
+    }
+}
 
 /*
  */
@@ -144,14 +194,14 @@ inline void DLList::Container::clear()
     if (_objclass.destructor) {  // avoid evaluating the if statement inside the loop repeatedly
         for (auto n = _head; n != nullptr;) {
             auto tmp = n->next;
-            UNSAFE(_objclass.destructor(reinterpret_cast<u8*>(n) + sizeof(Node)));
-            delete[] n;
+            _objclass.destructor(_payload(n));
+            _freeNode(n);
             n = tmp;
         }
     } else {
         for (auto n = _head; n != nullptr;) {
             auto tmp = n->next;
-            delete[] n;
+            _freeNode(n);
             n = tmp;
         }
     }
@@ -159,21 +209,67 @@ inline void DLList::Container::clear()
     _length = 0;
 }
 
+/*
+ */
+inline auto DLList::Container::_allocateNode() -> Node*
+{
+    if (auto n = _freeNodes; n != nullptr) {
+        _freeNodes = n->next;
+        return n;
+    }
+    auto stride = _nodeStride();
+    if (_bump == nullptr || UNSAFE(_bump + stride) > _bumpEnd) [[unlikely]] {
+        _growPool();
+    }
+    auto* n = reinterpret_cast<Node*>(_bump);
+    UNSAFE(_bump += stride);
+    return n;
+}
+
+/*
+ */
+inline void DLList::Container::_freeNode(Node* n)
+{
+    n->next = _freeNodes;
+    _freeNodes = n;
+}
+
+/*
+ */
+[[clang::noinline]]
+inline void DLList::Container::_growPool()
+{
+    UNSAFE_BEGIN;
+    _chunkNodes = (_chunkNodes == 0) ? FIRST_CHUNK_NODES : min(_chunkNodes * 2, MAX_CHUNK_NODES);
+    auto alignment = max(usize(alignof(Chunk)), _nodeAlignment());
+    auto dataOffset = alignUp(sizeof(Chunk), alignment);
+    auto sizeBytes = dataOffset + _chunkNodes * _nodeStride();
+
+    auto* chunk = static_cast<Chunk*>(_alloc.allocate(sizeBytes, alignment));
+    if constexpr (HeapStats::ENABLED) {
+        HeapStats::recordCallSite(sizeBytes);
+    }
+    chunk->next = _chunks;
+    chunk->sizeBytes = sizeBytes;
+    _chunks = chunk;
+    _bump = reinterpret_cast<u8*>(chunk) + dataOffset;
+    _bumpEnd = reinterpret_cast<u8*>(chunk) + sizeBytes;
+    UNSAFE_END;
+}
+
 /*
  */
 [[clang::noinline]]
 inline void DLList::Container::Iterator::_insert(void const* mem)
 {
     Assert(mem);
-    Node* newNode;
+    Node* newNode = _list->_allocateNode();
 
-    UNSAFE_BEGIN;
-    {
-        auto* newNodeBytes = new u8[sizeof(Node) + _list->_objclass.sizeBytes];  // TODO: alignment
-        memcpy(newNodeBytes + sizeof(Node), mem, _list->_objclass.sizeBytes);
-        newNode = reinterpret_cast<Node*>(newNodeBytes);
+    if (_list->_objclass.copyConstructor) {
+        _list->_objclass.copyConstructor(_list->_payload(newNode), mem);
+    } else {
+        memcpy(_list->_payload(newNode), mem, _list->_objclass.sizeBytes);
     }
-    UNSAFE_END;
 
     if (_curr == nullptr) {  // iterator is at end
         newNode->prev = _list->_tail;
@@ -221,20 +317,21 @@ inline void DLList::Container::Iterator::_remove()
     }
     _list->_length--;
     tmp = _curr->next;
-    delete[] _curr;
+    _list->_objclass.destructor(_list->_payload(_curr));
+    _list->_freeNode(_curr);
     _curr = tmp;
 }
 
 inline auto DLList::Container::Iterator::_get() const -> void const*
 {
     Assert(_curr);
-    return UNSAFE(reinterpret_cast<u8 const*>(_curr) + sizeof(Node));
+    return _list->_payload(_curr);
 }
 
 inline auto DLList::Container::Iterator::_get() -> void*
 {
     Assert(_curr);
-    return UNSAFE(reinterpret_cast<u8*>(_curr) + sizeof(Node));
+    return _list->_payload(_curr);
 }
 
 }  // namespace cm::impl
@@ -16,71 +16,497 @@
 #ifndef __inline_core_header__
 #warning Do not include this file directly; include "datastructs.hh" instead
 #else
+UNSAFE_BEGIN;
 
 namespace cm {
 
+namespace impl {
 
 ///
-/// One implementation of a dictionary
+/// The 16 control bytes of a group of Map slots: one per slot, and a counter in the last byte. The byte of a full slot
+/// holds 7 bits of the hash of its key; an empty slot has the high bit set. All of them are compared with one SIMD
+/// compare, which gives a bitmask of the slots whose byte matches.
 ///
-/// 1) Based on a sparse array. The result of the hash function on a key is used as an index into the sparse array.
-/// This naturally makes sense given that the hash function return integers that are "far apart"
-/// Now since the sparse array takes a 64-bit index, a form of open addressing is used to resolve hash collisions:
-/// The upper 32 bits of the index are the key hash
-/// The lower 32 bits of the index are used to store each value that has the same key hash
-/// This allows 2^32 objects to have the same key hash
+struct MapGroup
+{
+    constexpr static usize WIDTH = 16;
+    constexpr static usize SLOTS = WIDTH - 1;
+    constexpr static u8 EMPTY = 0x80;
+    constexpr static u32 SLOT_MASK = (u32(1) << SLOTS) - 1;
+    // The control bytes of a map that has not allocated anything yet, so that lookups need no special case
+    alignas(WIDTH) constexpr static u8 EMPTY_CONTROL[WIDTH] = {EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+        EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, 0};
+
+    MemoryBytes<WIDTH> control;
+
+    FORCEINLINE explicit MapGroup(u8 const* p)
+        : control(loadBytes<WIDTH>(p))
+    {}
+
+    ///
+    /// Returns the slots whose control byte is the given 7-bit hash.
+    ///
+    FORCEINLINE u32 match(u8 hash) const { return _mask(control == (MemoryBytes<WIDTH>{} + hash)) & SLOT_MASK; }
+
+    FORCEINLINE u32 matchEmpty() const { return _mask(control) & SLOT_MASK; }
+
+    FORCEINLINE u32 matchFull() const { return ~_mask(control) & SLOT_MASK; }
+
+private:
+    ///
+    /// Gathers the high bit of each byte.
+    ///
+    FORCEINLINE static u32 _mask(auto bytes)
+    {
+#if __SSE2__
+        using Bytes = __attribute__((__vector_size__(WIDTH))) char;
+        return u32(__builtin_ia32_pmovmskb128(__builtin_bit_cast(Bytes, bytes)));
+#else
+        u32 mask = 0;
+        for (usize i = 0; i < WIDTH; i++) {
+            mask |= u32(u8(bytes[i]) >> 7) << i;
+        }
+        return mask;
+#endif
+    }
+};
+
+}  // namespace impl
+
+
+///
+/// A hash map with open addressing, after SwissTable and F14. The entries live in one flat array of slots, in groups
+/// of 15, and each group has 16 control bytes: a byte per slot with 7 bits of the hash of its key (or a mark that the
+/// slot is empty), and a counter of the keys that were placed past the group because it was full. The rest of the
+/// hash picks the first group to look in, and the groups after it are visited in triangular steps.
+///
+/// A lookup compares the control bytes of a whole group with the key's 7 bits at once, and only compares keys for the
+/// slots that match (about 1 in 128 of the others), so it usually costs one key comparison. It stops at the first
+/// group whose counter is zero, which is usually the first group visited. Since the counters say how far a lookup has
+/// to go, removing an entry only empties its slot and decrements the counters on its key's path: there are no
+/// tombstones, and lookups do not get slower after many removals. A counter that reaches 255 stops counting, since it
+/// can no longer tell how many keys went past; the next put() then rehashes the table, which recounts them. A lookup
+/// visits each group at most once, however many counters are stuck.
 ///
-template<typename K, typename V>
-struct Map
+/// The table grows by doubling when it is 7/8 full, which invalidates pointers to the entries.
+/// Keys are hashed with Hash<Hasher>, or their hash<Hasher>() method. Lookups can use any type that hashes and
+/// compares like the key type, e.g. a StringRef (or a string literal) for String keys.
+/// \code{.cpp}
+///     Map<String, u32> counts;
+///     counts.put("apples", 3);
+///     if (auto n = counts.get("apples"); n.hasValue()) {
+///         *n.val() += 1;
+///     }
+///     for (auto& [fruit, count] : counts) { ... }
+/// \endcode
+///
+template<typename K, typename V, typename Hasher = WyHash>
+class Map
 {
-    using HashFunction = CFunction<u32(K const&)>;
-    constexpr static u32 defaultHashFunction(K const& k) { return Hash<Crc32>::hash(k); };
+public:
+    using Entry = Pair<K, V>;
+
+private:
+    using Group = impl::MapGroup;
+    constexpr static usize WIDTH = Group::WIDTH;
+    constexpr static usize SLOTS = Group::SLOTS;
+
+    Allocator _alloc;
+    u8* _control = const_cast<u8*>(Group::EMPTY_CONTROL);
+    Entry* _slots = nullptr;
+    usize _groupMask = 0;
+    usize _capacity = 0;
+    usize _length = 0;
+    usize _growthLeft = 0;
+    // Some overflow counter reached 255 and is stuck there until the table is rehashed
+    bool _saturated = false;
 
+public:
+    template<typename E>
+    struct BasicIterator
+    {
+        E& operator*() const noexcept { return _map->_slots[_map->_slotIndex(_position)]; }
+        E* operator->() const noexcept { return &**this; }
+        BasicIterator& operator++() { return (_position = _map->_nextFull(_position + 1), *this); }
+        bool operator==(BasicIterator const& i) const { return _position == i._position; }
+
+    private:
+        friend class Map;
+        BasicIterator(Map const* map, usize position)
+            : _map(map), _position(position)
+        {}
+
+        Map const* _map;
+        // The index of the slot's control byte
+        usize _position;
+    };
+
+    using Iterator = BasicIterator<Entry>;
+    using ConstIterator = BasicIterator<Entry const>;
 
-    Map(HashFunction const& hashFunc = defaultHashFunction)
-        : _array(), _hashFunc(hashFunc)
+    ///
+    /// Creates an empty map, which allocates nothing until the first entry is added.
+    ///
+    explicit Map(Allocator const& alloc = {})
+        : _alloc(alloc)
     {}
 
+    ///
+    /// Copy constructor. The copy has the same layout as the original, so nothing is rehashed.
+    ///
+    Map(Map const& other, Allocator const& alloc = {})
+        : _alloc(alloc)
+    {
+        if (other._capacity == 0) {
+            return;
+        }
+        _allocate(other._capacity / SLOTS);
+        memcpy(_control, other._control, _controlBytes());
+        for (usize i = other._nextFull(0); i < _controlBytes(); i = other._nextFull(i + 1)) {
+            new (_slots + _slotIndex(i)) Entry(other._slots[_slotIndex(i)]);
+        }
+        _length = other._length;
+        _growthLeft = other._growthLeft;
+        _saturated = other._saturated;
+    }
+
+    ///
+    /// Move constructor. The table is taken over together with the allocator it came from.
+    ///
+    Map(Map&& other)
+    {
+        memcpy(static_cast<void*>(this), &other, sizeof(Map));
+        new (&other) Map(_alloc);
+    }
+
+    Map& operator=(Map const& other)
+    {
+        if (this != &other) {
+            Allocator alloc = _alloc;
+            this->~Map();
+            new (this) Map(other, alloc);
+        }
+        return *this;
+    }
 
-    void put(K const& key, V const& value)
+    Map& operator=(Map&& other)
     {
-        u64 keyHash = u64(u32(_hashFunc(key)));
-        u64 index = u64(keyHash) << 32;
+        if (this != &other) {
+            this->~Map();
+            new (this) Map(static_cast<Map&&>(other));
+        }
+        return *this;
+    }
 
-        for (u32 j = 0; j < MAX_VALUE<u32>; j++) {
-            u64 offset = index + j;
-            Optional<Pair<K, V>> entry = _array.get(offset);
+    ~Map()
+    {
+        if (_capacity != 0) {
+            _destroyEntries();
+            _alloc.deallocate(_control, _controlBytes(), WIDTH);
+            _alloc.deallocateArray(_slots, _capacity);
+        }
+    }
 
-            if (!entry.hasValue()) {
-                _array.set(offset, Pair<K, V>(key, value));
-                break;
-            }
+    ///
+    /// Associates a value with a key, replacing the value the key had. Returns true if the key was not in the map.
+    ///
+    bool put(K const& key, V const& value)
+    {
+        u64 hash = _hashOf(key);
+        if (Entry* entry = _find(key, hash); entry != nullptr) {
+            entry->second = value;
+            return false;
+        }
+        if (_growthLeft == 0) {
+            _resize(_capacity == 0 ? 1 : (_groupMask + 1) * 2);
+        } else if (_saturated) {
+            _resize(_groupMask + 1);
+        }
+        new (_slots + _place(hash)) Entry(key, value);
+        _length++;
+        _growthLeft--;
+        return true;
+    }
+
+    ///
+    /// Returns a pointer to the value associated with a key, or None.
+    ///
+    template<typename L>
+    Optional<V*> get(L const& key)
+    {
+        Entry* entry = _find(_lookupKey(key), _hashOf(_lookupKey(key)));
+        if (entry == nullptr) {
+            return None;
         }
+        return &entry->second;
     }
 
-    Optional<V*> get(K const& key)
+    template<typename L>
+    Optional<V const*> get(L const& key) const
     {
-        u32 keyHash = _hashFunc(key);
-        u64 index = u64(keyHash) << 32;
+        Entry const* entry = _find(_lookupKey(key), _hashOf(_lookupKey(key)));
+        if (entry == nullptr) {
+            return None;
+        }
+        return &entry->second;
+    }
 
-        for (u32 j = 0; j < MAX_VALUE<u32>; j++) {
-            u64 offset = index + j;
-            Optional<Pair<K, V>> entry = _array.get(offset);
+    ///
+    /// Returns true if there is a value associated with a key.
+    ///
+    template<typename L>
+    bool contains(L const& key) const
+    {
+        return _find(_lookupKey(key), _hashOf(_lookupKey(key))) != nullptr;
+    }
 
-            if (!entry.hasValue()) {
-                return None;
-            } else if (entry.hasValue() && key == entry.ref().first) {
-                return const_cast<V*>(&entry.ref().second);
+    ///
+    /// Removes a key and its value. Returns true if the key was in the map.
+    ///
+    template<typename L>
+    bool remove(L const& key)
+    {
+        u64 hash = _hashOf(_lookupKey(key));
+        Entry* entry = _find(_lookupKey(key), hash);
+        if (entry == nullptr) {
+            return false;
+        }
+        usize slot = usize(entry - _slots);
+        usize group = slot / SLOTS;
+        entry->~Entry();
+        _control[(group * WIDTH) + (slot % SLOTS)] = Group::EMPTY;
+        // The key went past every group on its path before its own, and counted itself in them
+        usize g = _homeGroup(hash);
+        for (usize step = 1; g != group; step++) {
+            u8& overflow = _control[(g * WIDTH) + SLOTS];
+            if (overflow != MAX_VALUE<u8>) {
+                overflow--;
             }
+            g = (g + step) & _groupMask;
+        }
+        _length--;
+        _growthLeft++;
+        return true;
+    }
+
+    ///
+    /// Makes room for at least n entries, so that adding up to n entries does not grow the table.
+    ///
+    void reserve(usize n)
+    {
+        if (n <= _length + _growthLeft) {
+            return;
+        }
+        usize groups = 1;
+        while (_maxLoad(groups * SLOTS) < n) {
+            groups *= 2;
+        }
+        _resize(groups);
+    }
+
+    ///
+    /// Removes all the entries. The memory is kept for the entries added after.
+    ///
+    void clear()
+    {
+        if (_capacity == 0) {
+            return;
         }
-        return None;
+        _destroyEntries();
+        _clearControl();
+        _length = 0;
+        _growthLeft = _maxLoad(_capacity);
     }
 
+    NODISCARD constexpr usize length() const { return _length; }
+
+    NODISCARD constexpr bool empty() const { return _length == 0; }
+
+    ///
+    /// Returns the number of slots. The table grows when 7/8 of them are full.
+    ///
+    NODISCARD constexpr usize capacity() const { return _capacity; }
+
+    ///
+    /// Iterates over the entries in no particular order. The keys must not be modified.
+    ///
+    Iterator begin() { return Iterator(this, _nextFull(0)); }
+    Iterator end() { return Iterator(this, _controlBytes()); }
+    ConstIterator begin() const { return ConstIterator(this, _nextFull(0)); }
+    ConstIterator end() const { return ConstIterator(this, _controlBytes()); }
+
 private:
-    SparseArray<Pair<K, V>> _array;
-    HashFunction _hashFunc;
+    FORCEINLINE constexpr static usize _maxLoad(usize capacity) { return capacity - (capacity / 8); }
+
+    FORCEINLINE constexpr usize _controlBytes() const { return _capacity == 0 ? 0 : (_groupMask + 1) * WIDTH; }
+
+    FORCEINLINE constexpr static usize _slotIndex(usize position)
+    {
+        return ((position / WIDTH) * SLOTS) + (position % WIDTH);
+    }
+
+    FORCEINLINE usize _homeGroup(u64 hash) const { return usize(hash >> 7) & _groupMask; }
+
+    FORCEINLINE static u8 _controlByte(u64 hash) { return u8(hash & 0x7f); }
+
+    template<typename L>
+    FORCEINLINE static u64 _hashOf(L const& key)
+    {
+        using SeedType = Hasher::SeedType;
+        if constexpr (IsClass<L>) {
+            return u64(key.template hash<Hasher>(SeedType(Hasher::DEFAULT_SEED)));
+        } else {
+            return u64(Hash<Hasher>::hash(key, SeedType(Hasher::DEFAULT_SEED)));
+        }
+    }
+
+    ///
+    /// When the keys are objects (such as Strings), string literals and C strings are looked up as StringRefs, since
+    /// Hash hashes a char const* as a pointer. Everything else, including the keys of a map of char const*, which
+    /// compares the pointers themselves, is looked up as itself.
+    ///
+    template<typename L>
+    FORCEINLINE static L const& _lookupKey(L const& key)
+    {
+        return key;
+    }
+
+    template<usize N>
+    FORCEINLINE static StringRef _lookupKey(char const (&key)[N]) requires (IsClass<K>)
+    {
+        return StringRef(key);
+    }
+
+    FORCEINLINE static StringRef _lookupKey(char const* key) requires (IsClass<K>)
+    {
+        return StringRef(key);
+    }
+
+    template<typename L>
+    FORCEINLINE static bool _keyEquals(K const& a, L const& b)
+    {
+        if constexpr (requires { a.equals(b); }) {
+            return a.equals(b);
+        } else {
+            return a == b;
+        }
+    }
+
+    template<typename L>
+    Entry* _find(L const& key, u64 hash) const
+    {
+        u8 controlByte = _controlByte(hash);
+        usize g = _homeGroup(hash);
+        // The triangular steps visit every group once in _groupMask + 1 steps, after which nothing is left to look at
+        for (usize step = 1; step <= _groupMask + 1; step++) {
+            Group group(_control + (g * WIDTH));
+            for (u32 m = group.match(controlByte); m != 0; m &= m - 1) {
+                Entry* entry = _slots + (g * SLOTS) + u32(__builtin_ctz(m));
+                if (_keyEquals(entry->first, key)) [[likely]] {
+                    return entry;
+                }
+            }
+            if (_control[(g * WIDTH) + SLOTS] == 0) [[likely]] {
+                return nullptr;
+            }
+            g = (g + step) & _groupMask;
+        }
+        return nullptr;
+    }
+
+    ///
+    /// Claims an empty slot for a key that is not in the map, counting it in each full group it goes past, and returns
+    /// the slot's index. There must be an empty slot.
+    ///
+    usize _place(u64 hash)
+    {
+        usize g = _homeGroup(hash);
+        for (usize step = 1;; step++) {
+            if (u32 empty = Group(_control + (g * WIDTH)).matchEmpty(); empty != 0) [[likely]] {
+                u32 i = u32(__builtin_ctz(empty));
+                _control[(g * WIDTH) + i] = _controlByte(hash);
+                return (g * SLOTS) + i;
+            }
+            u8& overflow = _control[(g * WIDTH) + SLOTS];
+            if (overflow != MAX_VALUE<u8> && ++overflow == MAX_VALUE<u8>) {
+                _saturated = true;
+            }
+            g = (g + step) & _groupMask;
+        }
+    }
+
+    ///
+    /// Returns the control byte index of the first full slot at or after a position, or _controlBytes().
+    ///
+    usize _nextFull(usize position) const
+    {
+        usize end = _controlBytes();
+        while (position < end) {
+            usize g = position / WIDTH;
+            u32 full = Group(_control + (g * WIDTH)).matchFull() & (~u32(0) << (position % WIDTH));
+            if (full != 0) {
+                return (g * WIDTH) + u32(__builtin_ctz(full));
+            }
+            position = (g + 1) * WIDTH;
+        }
+        return end;
+    }
+
+    void _allocate(usize groups)
+    {
+        _capacity = groups * SLOTS;
+        _groupMask = groups - 1;
+        _control = static_cast<u8*>(_alloc.allocate(groups * WIDTH, WIDTH));
+        _slots = _alloc.allocateArray<Entry>(_capacity);
+        _clearControl();
+        _growthLeft = _maxLoad(_capacity);
+    }
+
+    void _clearControl()
+    {
+        memset(_control, Group::EMPTY, _controlBytes());
+        for (usize g = 0; g <= _groupMask; g++) {
+            _control[(g * WIDTH) + SLOTS] = 0;
+        }
+        _saturated = false;
+    }
+
+    void _destroyEntries()
+    {
+        for (usize i = _nextFull(0); i < _controlBytes(); i = _nextFull(i + 1)) {
+            _slots[_slotIndex(i)].~Entry();
+        }
+    }
+
+    ///
+    /// Moves the entries into a new table with the given number of groups (possibly as many as before, which recounts
+    /// the overflow counters).
+    ///
+    void _resize(usize groups)
+    {
+        u8* oldControl = _control;
+        Entry* oldSlots = _slots;
+        usize oldCapacity = _capacity;
+        usize oldControlBytes = _controlBytes();
+        _allocate(groups);
+        if (oldCapacity == 0) {
+            return;
+        }
+        for (usize g = 0; g < oldControlBytes; g += WIDTH) {
+            for (u32 full = Group(oldControl + g).matchFull(); full != 0; full &= full - 1) {
+                Entry& entry = oldSlots[_slotIndex(g + u32(__builtin_ctz(full)))];
+                new (_slots + _place(_hashOf(entry.first))) Entry(move(entry));
+                entry.~Entry();
+            }
+        }
+        _growthLeft -= _length;
+        _alloc.deallocate(oldControl, oldControlBytes, WIDTH);
+        _alloc.deallocateArray(oldSlots, oldCapacity);
+    }
 };
 
 
 }  // namespace cm
+
+UNSAFE_END;
 #endif
@@ -0,0 +1,474 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "datastructs.hh" instead
+#else
+
+namespace cm {
+
+///
+/// Finds every occurrence of any of a set of patterns in one pass over the text, e.g. hundreds of keywords in each
+/// line of a log. The patterns are copied and compiled once, when the matcher is constructed:
+///
+/// - Up to TEDDY_MAX_PATTERNS patterns are looked for with a SIMD prefilter ("Teddy"): the patterns are spread over 8
+///   buckets, and for each of the first (up to 3) characters of the patterns, two 16-entry tables give the buckets
+///   whose patterns have a character with that low / high nibble at that position. A byte shuffle looks up a whole
+///   chunk of text in the tables at once, and only the positions that pass for every character are compared with the
+///   patterns of the buckets they passed for.
+/// - More patterns than that (or a target without SSSE3) use an Aho-Corasick automaton, compiled into a DFA whose
+///   rows are indexed by byte class rather than by byte (the bytes that occur in no pattern share a class), so the
+///   table stays small enough to live in cache. Each step of the scan is then one table lookup; the entries are
+///   premultiplied by the row length, and have a flag bit for the states where some pattern ends.
+///
+/// Matches are reported with the index of the pattern (in the list the matcher was built from) and the index in the
+/// text where it starts. Overlapping matches and matches of different patterns at the same place are all reported, in
+/// the order the scan finds them, which is by start position with the prefilter and by end position with the
+/// automaton. Empty patterns never match.
+/// \code{.cpp}
+///     MultiMatcher keywords({"timeout", "refused", "reset by peer"});
+///     keywords.forEachMatch(line, [&](MultiMatcher::Match m) { stdout.println("` at `", keywords.pattern(m.pattern),
+///         m.position); });
+///     bool interesting = keywords.matchesAny(line);
+/// \endcode
+///
+class MultiMatcher
+{
+public:
+    struct Match
+    {
+        usize position;
+        u32 pattern;
+    };
+
+#if __SSSE3__
+    constexpr static usize TEDDY_MAX_PATTERNS = 32;
+#else
+    constexpr static usize TEDDY_MAX_PATTERNS = 0;
+#endif
+
+private:
+    constexpr static u32 NONE = ~u32(0);
+    // Set in a transition to a state where some pattern ends
+    constexpr static u32 MATCH_FLAG = u32(1) << 31;
+    constexpr static usize TEDDY_BUCKETS = 8;
+    constexpr static usize TEDDY_MAX_FINGERPRINT = 3;
+
+    struct Pattern
+    {
+        u32 offset;  // In _chars
+        u32 length;
+        // The next pattern in the same Teddy bucket, or the next pattern that ends in the same automaton state (i.e.
+        // a duplicate); NONE at the end of the list
+        u32 next;
+    };
+
+    Allocator _alloc;
+    char* _chars = nullptr;
+    Pattern* _patterns = nullptr;
+    u32 _patternCount = 0;
+    u32 _charCount = 0;
+    bool _teddy = false;
+
+    // Teddy: the first pattern of each bucket, and the nibble tables for each fingerprint position (repeated to fill a
+    // chunk, since AVX2 shuffles each 16-byte half separately)
+    u32 _fingerprintLength = 0;
+    u32 _shortestLength = 0;
+    u32 _bucketFirst[TEDDY_BUCKETS] = {};
+    impl::MemoryChunk _lowNibbles[TEDDY_MAX_FINGERPRINT] = {};
+    impl::MemoryChunk _highNibbles[TEDDY_MAX_FINGERPRINT] = {};
+
+    // Aho-Corasick: the byte classes, the transitions (_stateCount rows of _classCount entries), and for each state
+    // the first pattern ending there and the nearest state on its failure chain where a pattern ends
+    u8 _classOf[256] = {};
+    u32 _classCount = 0;
+    u32 _stateCount = 0;
+    u32* _transitions = nullptr;
+    u32* _firstPattern = nullptr;
+    u32* _outputLink = nullptr;
+
+public:
+    ///
+    /// Compiles a set of patterns. Pattern i is reported as Match::pattern == i.
+    ///
+    explicit MultiMatcher(ArrayRef<StringRef> patterns, Allocator const& alloc = {})
+        : _alloc(alloc)
+    {
+        UNSAFE_BEGIN;
+        usize charCount = 0;
+        for (usize i = 0; i < patterns.length(); i++) {
+            charCount += patterns[i].length();
+        }
+        Assert(charCount < MATCH_FLAG && patterns.length() < NONE, ASMS_PARAMETER);
+        _patternCount = u32(patterns.length());
+        _charCount = u32(charCount);
+        _chars = _alloc.allocateArray<char>(max(charCount, usize(1)));
+        _patterns = _alloc.allocateArray<Pattern>(max(usize(_patternCount), usize(1)));
+        u32 offset = 0;
+        for (u32 i = 0; i < _patternCount; i++) {
+            StringRef p = patterns[usize(i)];
+            memcpy(_chars + offset, p.data(), p.length());
+            _patterns[i] = Pattern{offset, u32(p.length()), NONE};
+            offset += u32(p.length());
+        }
+        UNSAFE_END;
+        if (TEDDY_MAX_PATTERNS != 0 && _patternCount <= TEDDY_MAX_PATTERNS) {
+            _buildTeddy();
+        } else {
+            _buildAutomaton();
+        }
+    }
+
+    MultiMatcher(MultiMatcher const&) = delete;
+    MultiMatcher& operator=(MultiMatcher const&) = delete;
+
+    MultiMatcher(MultiMatcher&& other)
+    {
+        __builtin_memcpy(static_cast<void*>(this), &other, sizeof(MultiMatcher));
+        other._chars = nullptr;
+        other._patterns = nullptr;
+        other._transitions = nullptr;
+        other._firstPattern = nullptr;
+        other._outputLink = nullptr;
+    }
+
+    MultiMatcher& operator=(MultiMatcher&& other)
+    {
+        if (this != &other) {
+            this->~MultiMatcher();
+            new (this) MultiMatcher(static_cast<MultiMatcher&&>(other));
+        }
+        return *this;
+    }
+
+    ~MultiMatcher()
+    {
+        if (_chars != nullptr) {
+            _alloc.deallocateArray(_chars, max(usize(_charCount), usize(1)));
+            _alloc.deallocateArray(_patterns, max(usize(_patternCount), usize(1)));
+        }
+        if (_transitions != nullptr) {
+            _alloc.deallocateArray(_transitions, usize(_stateCount) * _classCount);
+            _alloc.deallocateArray(_firstPattern, usize(_stateCount));
+            _alloc.deallocateArray(_outputLink, usize(_stateCount));
+        }
+    }
+
+    ///
+    /// Returns the number of patterns the matcher was built from.
+    ///
+    NODISCARD FORCEINLINE usize patternCount() const { return _patternCount; }
+
+    ///
+    /// Returns a pattern by its index.
+    ///
+    NODISCARD StringRef pattern(u32 index) const
+    {
+        Assert(index < _patternCount, ASMS_BOUNDS);
+        UNSAFE(Pattern p = _patterns[index]);
+        return StringRef(UNSAFE(_chars + p.offset), p.length);
+    }
+
+    ///
+    /// Returns true if the set uses the SIMD prefilter rather than the automaton.
+    ///
+    NODISCARD FORCEINLINE bool usesPrefilter() const { return _teddy; }
+
+    ///
+    /// Calls func(Match) for every occurrence of every pattern in the text.
+    ///
+    void forEachMatch(StringRef text, auto const& func) const
+    {
+        _scan(text, [&](Match m) {
+            func(m);
+            return false;
+        });
+    }
+
+    ///
+    /// Returns true if any of the patterns occurs in the text. Stops at the first match found.
+    ///
+    NODISCARD bool matchesAny(StringRef text) const
+    {
+        return _scan(text, [](Match) { return true; });
+    }
+
+    ///
+    /// Returns the number of occurrences of the patterns in the text (overlapping ones included).
+    ///
+    NODISCARD usize countMatches(StringRef text) const
+    {
+        usize n = 0;
+        forEachMatch(text, [&](Match) { n++; });
+        return n;
+    }
+
+private:
+    ///
+    /// Calls stop(Match) for the matches until it returns true, and returns whether it did.
+    ///
+    bool _scan(StringRef text, auto const& stop) const
+    {
+#if __SSSE3__
+        if (_teddy) {
+            return _scanTeddy(text.data(), text.length(), stop);
+        }
+#endif
+        return _scanAutomaton(text.data(), text.length(), stop);
+    }
+
+    void _buildTeddy()
+    {
+        UNSAFE_BEGIN;
+        _teddy = true;
+        _shortestLength = NONE;
+        for (u32 b = 0; b < TEDDY_BUCKETS; b++) {
+            _bucketFirst[b] = NONE;
+        }
+        for (u32 i = 0; i < _patternCount; i++) {
+            if (_patterns[i].length != 0) {
+                _shortestLength = min(_shortestLength, _patterns[i].length);
+            }
+        }
+        if (_shortestLength == NONE) {
+            // Nothing but empty patterns, so there is nothing to find; no bucket is ever set in the tables
+            _fingerprintLength = 1;
+            return;
+        }
+        _fingerprintLength = min(_shortestLength, u32(TEDDY_MAX_FINGERPRINT));
+
+        u8 lowNibbles[TEDDY_MAX_FINGERPRINT][16] = {};
+        u8 highNibbles[TEDDY_MAX_FINGERPRINT][16] = {};
+        // Adding the patterns in reverse keeps each bucket's list in pattern order
+        for (u32 i = _patternCount; i-- != 0;) {
+            Pattern& p = _patterns[i];
+            if (p.length == 0) {
+                continue;
+            }
+            u32 bucket = i % TEDDY_BUCKETS;
+            p.next = _bucketFirst[bucket];
+            _bucketFirst[bucket] = i;
+            for (u32 j = 0; j < _fingerprintLength; j++) {
+                u8 c = u8(_chars[p.offset + j]);
+                lowNibbles[j][c & 15] |= u8(1 << bucket);
+                highNibbles[j][c >> 4] |= u8(1 << bucket);
+            }
+        }
+        for (u32 j = 0; j < _fingerprintLength; j++) {
+            for (usize k = 0; k < impl::MEMORY_CHUNK; k++) {
+                _lowNibbles[j][k] = lowNibbles[j][k % 16];
+                _highNibbles[j][k] = highNibbles[j][k % 16];
+            }
+        }
+        UNSAFE_END;
+    }
+
+#if __SSSE3__
+    ///
+    /// Looks up each byte of indices (which must be < 16) in a 16-byte table, repeated in each half with AVX2.
+    ///
+    [[clang::always_inline]] static impl::MemoryChunk _lookup(impl::MemoryChunk table, impl::MemoryChunk indices)
+    {
+        using Bytes = __attribute__((__vector_size__(impl::MEMORY_CHUNK))) char;
+#if __AVX2__
+        auto result = __builtin_ia32_pshufb256(__builtin_bit_cast(Bytes, table), __builtin_bit_cast(Bytes, indices));
+#else
+        auto result = __builtin_ia32_pshufb128(__builtin_bit_cast(Bytes, table), __builtin_bit_cast(Bytes, indices));
+#endif
+        return __builtin_bit_cast(impl::MemoryChunk, result);
+    }
+
+    ///
+    /// Compares the patterns of the given buckets with the text at a position.
+    ///
+    bool _verify(char const* s, usize n, usize position, u32 buckets, auto const& stop) const
+    {
+        UNSAFE_BEGIN;
+        for (; buckets != 0; buckets &= buckets - 1) {
+            for (u32 i = _bucketFirst[__builtin_ctz(buckets)]; i != NONE; i = _patterns[i].next) {
+                Pattern p = _patterns[i];
+                if (p.length <= n - position && __builtin_memcmp(s + position, _chars + p.offset, p.length) == 0 &&
+                    stop(Match{position, i})) {
+                    return true;
+                }
+            }
+        }
+        return false;
+        UNSAFE_END;
+    }
+
+    bool _scanTeddy(char const* s, usize n, auto const& stop) const
+    {
+        UNSAFE_BEGIN;
+        constexpr usize C = impl::MEMORY_CHUNK;
+        if (n < _shortestLength || _shortestLength == NONE) {
+            return false;
+        }
+        usize k = _fingerprintLength;
+        usize i = 0;
+        for (; i + k - 1 + C <= n; i += C) {
+            auto candidates = ~impl::MemoryChunk{};
+            for (usize j = 0; j < k; j++) {
+                auto bytes = impl::loadBytes<C>(s + i + j);
+                candidates &= _lookup(_lowNibbles[j], bytes & 15) & _lookup(_highNibbles[j], bytes >> 4);
+            }
+            for (u32 mask = impl::byteMask(candidates != impl::MemoryChunk{}); mask != 0; mask &= mask - 1) {
+                u32 lane = u32(__builtin_ctz(mask));
+                if (_verify(s, n, i + lane, candidates[lane], stop)) {
+                    return true;
+                }
+            }
+        }
+        for (; i + k <= n; i++) {
+            u32 buckets = 0xFF;
+            for (usize j = 0; j < k; j++) {
+                u8 c = u8(s[i + j]);
+                buckets &= u32(_lowNibbles[j][c & 15] & _highNibbles[j][c >> 4]);
+            }
+            if (buckets != 0 && _verify(s, n, i, buckets, stop)) {
+                return true;
+            }
+        }
+        return false;
+        UNSAFE_END;
+    }
+#endif
+
+    void _buildAutomaton()
+    {
+        UNSAFE_BEGIN;
+        // Every byte that occurs in a pattern gets a class of its own, and class 0 is everything else
+        bool used[256] = {};
+        for (u32 i = 0; i < _charCount; i++) {
+            used[u8(_chars[i])] = true;
+        }
+        _classCount = 1;
+        for (usize c = 0; c < 256; c++) {
+            _classOf[c] = used[c] ? u8(_classCount++) : 0;
+        }
+        // A byte class count of 257 does not fit in a u8, but then class 0 is never used
+        if (_classCount == 257) {
+            for (usize c = 0; c < 256; c++) {
+                _classOf[c] = u8(c);
+            }
+            _classCount = 256;
+        }
+        usize classes = _classCount;
+
+        // Build the trie in a table big enough for one state per pattern character. A transition of 0 means there is
+        // none yet, since no trie edge leads back to the root.
+        usize maxStates = usize(_charCount) + 1;
+        u32* trie = _alloc.allocateArray<u32>(maxStates * classes);
+        u32* firstPattern = _alloc.allocateArray<u32>(maxStates);
+        memset(trie, 0, maxStates * classes * sizeof(u32));
+        memset(firstPattern, 0xFF, maxStates * sizeof(u32));
+        u32 states = 1;
+        for (u32 i = _patternCount; i-- != 0;) {
+            Pattern& p = _patterns[i];
+            if (p.length == 0) {
+                continue;
+            }
+            u32 state = 0;
+            for (u32 j = 0; j < p.length; j++) {
+                u32& next = trie[(state * classes) + _classOf[u8(_chars[p.offset + j])]];
+                if (next == 0) {
+                    next = states++;
+                }
+                state = next;
+            }
+            p.next = firstPattern[state];
+            firstPattern[state] = i;
+        }
+        Assert(usize(states) * classes < MATCH_FLAG, ASMS_PARAMETER);
+
+        // Move the states into tables of their final size
+        _stateCount = states;
+        _transitions = _alloc.allocateArray<u32>(usize(states) * classes);
+        _firstPattern = _alloc.allocateArray<u32>(states);
+        _outputLink = _alloc.allocateArray<u32>(states);
+        memcpy(_transitions, trie, usize(states) * classes * sizeof(u32));
+        memcpy(_firstPattern, firstPattern, states * sizeof(u32));
+        _alloc.deallocateArray(trie, maxStates * classes);
+        _alloc.deallocateArray(firstPattern, maxStates);
+
+        // Visit the states in breadth-first order, so that the failure state of each one (the longest proper suffix
+        // of its string that is in the trie) is finished before it. Its missing transitions are the failure state's
+        // transitions, which turns the trie into a DFA.
+        u32* fail = _alloc.allocateArray<u32>(states);
+        u32* queue = _alloc.allocateArray<u32>(states);
+        usize head = 0;
+        usize tail = 0;
+        fail[0] = 0;
+        _outputLink[0] = NONE;
+        queue[tail++] = 0;
+        while (head != tail) {
+            u32 state = queue[head++];
+            u32* row = _transitions + (state * classes);
+            u32 const* failRow = _transitions + (fail[state] * classes);
+            for (usize c = 0; c < classes; c++) {
+                u32 child = row[c];
+                if (child == 0) {
+                    row[c] = state == 0 ? 0 : failRow[c];
+                    continue;
+                }
+                u32 childFail = state == 0 ? 0 : failRow[c];
+                fail[child] = childFail;
+                _outputLink[child] = _firstPattern[childFail] != NONE ? childFail : _outputLink[childFail];
+                queue[tail++] = child;
+            }
+        }
+        _alloc.deallocateArray(fail, states);
+        _alloc.deallocateArray(queue, states);
+
+        for (usize t = 0; t < usize(states) * classes; t++) {
+            u32 next = _transitions[t];
+            bool output = _firstPattern[next] != NONE || _outputLink[next] != NONE;
+            _transitions[t] = (next * u32(classes)) | (output ? MATCH_FLAG : 0);
+        }
+        UNSAFE_END;
+    }
+
+    bool _scanAutomaton(char const* s, usize n, auto const& stop) const
+    {
+        UNSAFE_BEGIN;
+        if (_transitions == nullptr) {
+            return false;
+        }
+        u32 row = 0;
+        for (usize i = 0; i < n; i++) {
+            u32 next = _transitions[row + _classOf[u8(s[i])]];
+            row = next & ~MATCH_FLAG;
+            if ((next & MATCH_FLAG) == 0) [[likely]] {
+                continue;
+            }
+            u32 state = row / _classCount;
+            if (_firstPattern[state] == NONE) {
+                state = _outputLink[state];
+            }
+            for (; state != NONE; state = _outputLink[state]) {
+                for (u32 p = _firstPattern[state]; p != NONE; p = _patterns[p].next) {
+                    if (stop(Match{i + 1 - _patterns[p].length, p})) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+        UNSAFE_END;
+    }
+};
+
+}  // namespace cm
+#endif
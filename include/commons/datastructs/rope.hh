@@ -0,0 +1,429 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifndef __inline_core_header__
+#warning Do not include this file directly; include "datastructs.hh" instead
+#else
+
+namespace cm {
+
+///
+/// A string for edit-heavy workloads (e.g. a text editor buffer, or building a large document by splicing).
+/// String keeps its characters contiguous, so inserting or erasing in the middle moves the whole tail, and a long
+/// series of edits is quadratic. A Rope instead stores the text as a sequence of chunks of up to CHUNK_CAPACITY
+/// characters, kept in a balanced tree (a treap ordered by position) so that insert(), erase() and charAt() take
+/// O(log n) time, and slice() takes O(log n) plus the length of the slice.
+///
+/// The text is read back either chunk by chunk with forEachChunk(), or flattened into a String with toString().
+/// \code{.cpp}
+///     Rope text("hello world");
+///     text.insert(5, ",");
+///     text.erase(0, 1);
+///     text.insert(0, "H");
+///     String s = text.toString();  // "Hello, world"
+/// \endcode
+///
+class Rope {
+    struct Node
+    {
+        Node* left;
+        Node* right;
+        usize total;  // Number of characters in this subtree
+        u32 length;   // Number of characters in this node's chunk
+        u32 priority;
+        // Followed by CHUNK_CAPACITY + 1 characters, the chunk is kept null terminated
+    };
+
+    Node* _root = nullptr;
+    u32 _seed = 0x9E3779B9;
+    Allocator _alloc;
+
+public:
+    constexpr static usize NODE_SIZE = 512;
+    constexpr static usize CHUNK_CAPACITY = NODE_SIZE - sizeof(Node) - 1;
+
+    constexpr Rope() = default;
+
+    explicit Rope(Allocator const& alloc)
+        : _alloc(alloc)
+    {}
+
+    Rope(StringRef s, Allocator const& alloc = {})
+        : _alloc(alloc)
+    {
+        _root = _build(s);
+    }
+
+    Rope(Rope const& other)
+        : _seed(other._seed), _alloc(other._alloc)
+    {
+        other.forEachChunk([&](StringRef chunk) { _root = _merge(_root, _build(chunk)); });
+    }
+
+    Rope(Rope&& other)
+        : _root(other._root), _seed(other._seed), _alloc(other._alloc)
+    {
+        other._root = nullptr;
+    }
+
+    Rope& operator=(Rope const& other)
+    {
+        if (this != &other) {
+            this->~Rope();
+            new (this) Rope(other);
+        }
+        return *this;
+    }
+
+    Rope& operator=(Rope&& other)
+    {
+        if (this != &other) {
+            this->~Rope();
+            new (this) Rope(static_cast<Rope&&>(other));
+        }
+        return *this;
+    }
+
+    ~Rope() { _free(_root); }
+
+    ///
+    /// Returns the number of characters in the rope.
+    ///
+    NODISCARD FORCEINLINE usize length() const { return _total(_root); }
+
+    NODISCARD FORCEINLINE bool isEmpty() const { return _root == nullptr; }
+
+    ///
+    /// Returns the allocator the chunks come from.
+    ///
+    NODISCARD FORCEINLINE Allocator const& allocator() const { return _alloc; }
+
+    ///
+    /// Returns the character at an index in O(log n).
+    ///
+    NODISCARD char charAt(usize index) const
+    {
+        Assert(index < length(), ASMS_BOUNDS);
+        Node* n = _root;
+        while (true) {
+            usize leftTotal = _total(n->left);
+            if (index < leftTotal) {
+                n = n->left;
+            } else if (index < leftTotal + n->length) {
+                return UNSAFE(_chars(n)[index - leftTotal]);
+            } else {
+                index -= leftTotal + n->length;
+                n = n->right;
+            }
+        }
+    }
+
+    NODISCARD FORCEINLINE char operator[](usize index) const { return charAt(index); }
+
+    ///
+    /// Inserts a string before the character at an index (or at the end if index == length()).
+    ///
+    void insert(usize index, StringRef s)
+    {
+        Assert(index <= length(), ASMS_BOUNDS);
+        if (s.length() == 0) {
+            return;
+        }
+        auto [left, right] = _split(_root, index);
+        // Typing one character at a time should not leave a trail of tiny chunks, so top up the chunk just before the
+        // insertion point if it has room.
+        if (left != nullptr && _appendToLast(left, s)) {
+            _root = _join(left, right);
+        } else {
+            _root = _join(_join(left, _build(s)), right);
+        }
+    }
+
+    FORCEINLINE void append(StringRef s) { insert(length(), s); }
+
+    ///
+    /// Removes n characters starting at an index.
+    ///
+    void erase(usize index, usize n)
+    {
+        Assert(index + n <= length(), ASMS_BOUNDS);
+        if (n == 0) {
+            return;
+        }
+        auto [left, rest] = _split(_root, index);
+        auto [middle, right] = _split(rest, n);
+        _free(middle);
+        _root = _join(left, right);
+    }
+
+    ///
+    /// Returns a copy of the characters from startIndex (inclusive) to endIndex (exclusive) as a new rope.
+    ///
+    NODISCARD Rope slice(usize startIndex, usize endIndex) const
+    {
+        Rope result(_alloc);
+        forEachChunk(startIndex, endIndex, [&](StringRef chunk) {
+            result._root = _merge(result._root, result._build(chunk));
+        });
+        return result;
+    }
+
+    ///
+    /// Calls a function with each chunk of the rope in order, as a StringRef.
+    /// The StringRefs are invalidated by any modification of the rope.
+    ///
+    void forEachChunk(auto const& func) const { _forEachChunk(_root, func); }
+
+    ///
+    /// Calls a function with the pieces of the chunks covering the characters from startIndex (inclusive) to endIndex
+    /// (exclusive). Only the O(log n) subtrees overlapping the range are visited.
+    /// @note The pieces at either end of the range are not null terminated.
+    ///
+    void forEachChunk(usize startIndex, usize endIndex, auto const& func) const
+    {
+        Assert(startIndex <= endIndex && endIndex <= length(), ASMS_BOUNDS);
+        _forEachChunkInRange(_root, startIndex, endIndex, func);
+    }
+
+    ///
+    /// Flattens the rope into a contiguous String. The String's buffer is sized once up front.
+    ///
+    NODISCARD String toString(Allocator const& alloc = {}) const
+    {
+        String result(alloc);
+        result.reserve(length());
+        forEachChunk([&](StringRef chunk) { result.append(chunk); });
+        return result;
+    }
+
+    NODISCARD FORCEINLINE bool equals(StringRef s) const
+    {
+        if (s.length() != length()) {
+            return false;
+        }
+        usize offset = 0;
+        bool equal = true;
+        forEachChunk([&](StringRef chunk) {
+            equal = equal && __builtin_memcmp(chunk.data(), UNSAFE(s.data() + offset), chunk.length()) == 0;
+            offset += chunk.length();
+        });
+        return equal;
+    }
+
+    constexpr static void outputString(Rope const& rope, auto const& out)
+    {
+        rope.forEachChunk([&](StringRef chunk) {
+            for (usize i = 0; i < chunk.length(); i++) {
+                out(UNSAFE(chunk.data()[i]));
+            }
+        });
+    }
+
+private:
+    FORCEINLINE static usize _total(Node* n) { return n == nullptr ? 0 : n->total; }
+    FORCEINLINE static char* _chars(Node* n) { return UNSAFE(reinterpret_cast<char*>(n) + sizeof(Node)); }
+
+    FORCEINLINE static void _update(Node* n) { n->total = _total(n->left) + n->length + _total(n->right); }
+
+    FORCEINLINE u32 _nextPriority()
+    {
+        // xorshift32, kept per rope so that ropes used by different threads do not share state
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 17;
+        _seed ^= _seed << 5;
+        return _seed;
+    }
+
+    Node* _newNode(char const* chars, usize length)
+    {
+        Assert(length <= CHUNK_CAPACITY, ASMS_BUG);
+        auto* n = static_cast<Node*>(_alloc.allocate(NODE_SIZE, alignof(Node)));
+        n->left = n->right = nullptr;
+        n->length = u32(length);
+        n->total = length;
+        n->priority = _nextPriority();
+        memcpy(_chars(n), chars, length);
+        UNSAFE(_chars(n)[length] = '\0');
+        return n;
+    }
+
+    void _free(Node* n)
+    {
+        if (n != nullptr) {
+            _free(n->left);
+            _free(n->right);
+            _alloc.deallocate(n, NODE_SIZE, alignof(Node));
+        }
+    }
+
+    ///
+    /// Builds a tree out of a string, cutting it into full chunks.
+    ///
+    Node* _build(StringRef s)
+    {
+        Node* result = nullptr;
+        for (usize i = 0; i < s.length(); i += CHUNK_CAPACITY) {
+            result = _merge(result, _newNode(UNSAFE(s.data() + i), min(CHUNK_CAPACITY, s.length() - i)));
+        }
+        return result;
+    }
+
+    ///
+    /// Concatenates two trees, every character of a coming before every character of b.
+    ///
+    static Node* _merge(Node* a, Node* b)
+    {
+        if (a == nullptr) {
+            return b;
+        }
+        if (b == nullptr) {
+            return a;
+        }
+        if (a->priority > b->priority) {
+            a->right = _merge(a->right, b);
+            _update(a);
+            return a;
+        }
+        b->left = _merge(a, b->left);
+        _update(b);
+        return b;
+    }
+
+    ///
+    /// Concatenates two trees like _merge(), but first moves the first chunk of b into the last chunk of a if they fit
+    /// in one chunk together. A split in the middle of a chunk leaves two underfull chunks, so without this a series of
+    /// edits would leave a trail of small chunks behind it.
+    ///
+    Node* _join(Node* a, Node* b)
+    {
+        if (a != nullptr && b != nullptr) {
+            Node* first = b;
+            while (first->left != nullptr) {
+                first = first->left;
+            }
+            if (_appendToLast(a, StringRef(_chars(first), first->length))) {
+                b = _removeFirst(b);
+                _alloc.deallocate(first, NODE_SIZE, alignof(Node));
+            }
+        }
+        return _merge(a, b);
+    }
+
+    ///
+    /// Unlinks the first chunk of a tree, returning the new root. The node itself is not freed.
+    ///
+    static Node* _removeFirst(Node* n)
+    {
+        if (n->left == nullptr) {
+            return n->right;
+        }
+        n->left = _removeFirst(n->left);
+        _update(n);
+        return n;
+    }
+
+    struct SplitResult
+    {
+        Node* left;
+        Node* right;
+    };
+
+    ///
+    /// Splits a tree into the first `index` characters and the rest. A chunk straddling the split point is cut in two.
+    ///
+    SplitResult _split(Node* n, usize index)
+    {
+        if (n == nullptr) {
+            return {nullptr, nullptr};
+        }
+        usize leftTotal = _total(n->left);
+        if (index <= leftTotal) {
+            auto [a, b] = _split(n->left, index);
+            n->left = b;
+            _update(n);
+            return {a, n};
+        }
+        if (index >= leftTotal + n->length) {
+            auto [a, b] = _split(n->right, index - leftTotal - n->length);
+            n->right = a;
+            _update(n);
+            return {n, b};
+        }
+        usize k = index - leftTotal;
+        Node* tail = _newNode(UNSAFE(_chars(n) + k), n->length - k);
+        n->length = u32(k);
+        UNSAFE(_chars(n)[k] = '\0');
+        Node* right = n->right;
+        n->right = nullptr;
+        _update(n);
+        return {n, _merge(tail, right)};
+    }
+
+    ///
+    /// Appends a string to the last chunk of a tree if it fits, fixing up the totals along the right spine.
+    ///
+    static bool _appendToLast(Node* n, StringRef s)
+    {
+        Node* last = n;
+        while (last->right != nullptr) {
+            last = last->right;
+        }
+        if (last->length + s.length() > CHUNK_CAPACITY) {
+            return false;
+        }
+        memcpy(UNSAFE(_chars(last) + last->length), s.data(), s.length());
+        last->length += u32(s.length());
+        UNSAFE(_chars(last)[last->length] = '\0');
+        for (Node* p = n; p != nullptr; p = p->right) {
+            p->total += s.length();
+        }
+        return true;
+    }
+
+    static void _forEachChunk(Node* n, auto const& func)
+    {
+        if (n != nullptr) {
+            _forEachChunk(n->left, func);
+            func(StringRef(_chars(n), n->length));
+            _forEachChunk(n->right, func);
+        }
+    }
+
+    ///
+    /// Visits the part of a subtree between start and end, which are relative to the subtree's first character.
+    ///
+    static void _forEachChunkInRange(Node* n, usize start, usize end, auto const& func)
+    {
+        if (n == nullptr || start >= end) {
+            return;
+        }
+        usize leftTotal = _total(n->left);
+        usize chunkEnd = leftTotal + n->length;
+        if (start < leftTotal) {
+            _forEachChunkInRange(n->left, start, min(end, leftTotal), func);
+        }
+        if (start < chunkEnd && end > leftTotal) {
+            usize from = max(start, leftTotal) - leftTotal;
+            usize to = min(end, chunkEnd) - leftTotal;
+            func(StringRef(UNSAFE(_chars(n) + from), to - from));
+        }
+        if (end > chunkEnd) {
+            _forEachChunkInRange(n->right, max(start, chunkEnd) - chunkEnd, end - chunkEnd, func);
+        }
+    }
+};
+
+}  // namespace cm
+#endif
@@ -61,36 +61,41 @@ template<typename Type>
 struct SparseArray
 {
     Type** data;
-    usize _length;
+    usize _length = 0;
     // firstIndex, lastIndex
 
 public:
     SparseArray() { this->data = new Type*[256]{}; }
 
-    ~SparseArray() { clear(); }
+    ~SparseArray()
+    {
+        clear();
+        delete[] this->data;
+    }
+
+    SparseArray(SparseArray const&) = delete;
+    SparseArray& operator=(SparseArray const&) = delete;
 
     void clear()
     {
-        auto ptr = this->data;
-
-        auto _ = [&](this auto const& next_, unsigned depth) -> void {
-            if (depth == 0) {
-                for (int k = 0; k < 256; k++) {
-                    if (ptr[k]) {
-                        delete ptr;
-                    }
+        // Below the root there are 7 levels of tables, the last of which points to the elements
+        auto _ = [&](this auto const& next_, Type** table, unsigned depth) -> void {
+            for (int k = 0; k < 256; k++) {
+                if (table[k] == nullptr) {
+                    continue;
                 }
-            } else {
-                for (int k = 0; k < 256; k++) {
-                    if (ptr[k] != nullptr) {
-                        ptr = reinterpret_cast<Type**>(ptr[k]);
-                        next_(depth - 1);
-                        delete[] ptr;
-                    }
+                if (depth == 0) {
+                    delete table[k];
+                } else {
+                    auto child = reinterpret_cast<Type**>(table[k]);
+                    next_(child, depth - 1);
+                    delete[] child;
                 }
+                table[k] = nullptr;
             }
         };
-        _(8);
+        _(this->data, 7);
+        _length = 0;
     }
 
 
@@ -116,9 +121,9 @@ public:
         auto ptr = this->data;
 
         for (int _ = 0; _ < 7; _++, index >>= 8) {
+            ptr = reinterpret_cast<Type**>(ptr[static_cast<u8>(index)]);
             if (ptr == nullptr)
                 return None;
-            ptr = reinterpret_cast<Type**>(ptr[static_cast<u8>(index)]);
         }
         auto i = static_cast<u8>(index);
         return !ptr[i] ? None : Optional<Type>(*ptr[i]);
@@ -128,16 +133,16 @@ public:
     {
         auto ptr = this->data;
         for (int _ = 0; _ < 7; _++, index >>= 8) {
+            ptr = reinterpret_cast<Type**>(ptr[static_cast<u8>(index)]);
             if (ptr == nullptr)
                 return;
-            ptr = reinterpret_cast<Type**>(ptr[static_cast<u8>(index)]);
         }
         auto i = static_cast<u8>(index);
         if (ptr[i]) {
             delete ptr[i];
-        }
-        if (_length > 0)
+            ptr[i] = nullptr;
             _length--;
+        }
     }
 
     void forEach(auto visitor)
@@ -23,39 +23,21 @@ namespace cm {
 
 class String;
 
-struct Printable
-{
-    virtual ~Printable() = default;
-    virtual void output(String& result) const = 0;
-};
-
-template<typename T>
-struct PrintableT final : Printable
-{
-    T* ptr;
-
-    PrintableT(T const& ref)
-        : ptr(&const_cast<T&>(ref))
-    {}
-    constexpr void output(String& result) const override;
-};
-
-template<typename T>
-[[maybe_unused]] PrintableT(T const&) -> PrintableT<T>;
-
 
 ///
-/// A dynamic, heap-allocated string
+/// A dynamic, heap-allocated string.
+/// Strings of up to INLINE_LENGTH characters are stored inside the object and do not allocate.
 /// @see docs/String.md
 ///
 class String : public LinearIteratorComponent<String, char>,  //
                public Iterable<String>,
                public IEquatable<String> {
 
-    ByteVector _data;
+    SmallByteVector<23> _data;  // Includes the null terminator
 
 public:
     constexpr static auto FORMAT_DELIMITER = '`';
+    constexpr static usize INLINE_LENGTH = 22;
     using Index = Union<usize, isize> const&;
 
     ///
@@ -87,9 +69,65 @@ public:
         : String(sv.data(), sv.length())
     {}
 
+    ///
+    /// Constructs an empty string whose buffer will come from the given allocator.
+    ///
+    explicit String(Allocator const& alloc)
+        : _data("", 1, alloc)
+    {}
+
+    ///
+    /// Constructs a copy of a string whose buffer comes from the given allocator.
+    ///
+    String(StringRef const& sv, Allocator const& alloc)
+        : _data(sv.data(), sv.length() + 1, alloc)
+    {}
+
+    String(String const& other, Allocator const& alloc)
+        : _data(other._data, alloc)
+    {}
+
     NODISCARD String(String const&) = default;
     NODISCARD String& operator=(String const&) = default;
 
+    ///
+    /// Move constructor. The moved-from string is left empty, like a default-constructed one, since a moved-from
+    /// ByteVector has no null terminator.
+    ///
+    NODISCARD String(String&& other) noexcept
+        : _data(static_cast<SmallByteVector<23>&&>(other._data))
+    {
+        other._data = SmallByteVector<23>("", 1, other._data.allocator());
+    }
+
+    ///
+    /// Move assignment. The moved-from string is left empty.
+    ///
+    NODISCARD String& operator=(String&& other) noexcept
+    {
+        if (this != &other) {
+            _data = static_cast<SmallByteVector<23>&&>(other._data);
+            other._data = SmallByteVector<23>("", 1, other._data.allocator());
+        }
+        return *this;
+    }
+
+    ///
+    /// Makes copies of this string share its buffer until one of them is modified, so that copying a long string takes
+    /// constant time. Short strings are stored inline and are not affected.
+    ///
+    void share() & { _data.share(); }
+
+    ///
+    /// Returns true if the string's buffer is shared with copies of it (see share()).
+    ///
+    NODISCARD bool isShared() const { return _data.isShared(); }
+
+    ///
+    /// Returns the allocator this string's buffer comes from.
+    ///
+    NODISCARD Allocator const& allocator() const { return _data.allocator(); }
+
     NODISCARD operator ArrayRef<char>() { return ArrayRef<char>(const_cast<char*>(cstr()), length()); }
     NODISCARD operator ArrayRef<char>() const { return ArrayRef<char>(const_cast<char*>(cstr()), length()); }
     NODISCARD operator StringRef() { return StringRef(const_cast<char*>(cstr()), length()); }
@@ -128,6 +166,16 @@ public:
 
     NODISCARD constexpr bool equals(StringRef value) const { return StringRef(*this).equals(value); }
 
+    ///
+    /// The hash, which is the same as the hash of the string as a StringRef (so a map with String keys can be searched
+    /// with a StringRef).
+    ///
+    template<typename Hasher>
+    NODISCARD constexpr auto hash(auto seed) const
+    {
+        return StringRef(*this).template hash<Hasher>(seed);
+    }
+
     void ensureNullTermination();
 
     void erase(Index i, usize n) &
@@ -145,15 +193,19 @@ public:
 
     void insertf(Index i, u64 value);
 
+    ///
+    /// Makes sure that the string can grow to `length` characters without reallocating.
+    ///
+    void reserve(usize length) & { _data.reserve(length + 1); }
 
-    /**
-     * TODO
-     */
-    template<unsigned N, typename... Args>
-    NODISCARD FORCEINLINE static String fmt(char const (&sFmt)[N], Args... args)
-    {
-        return _fmt(sFmt, {PrintableT(args)...});
-    }
+
+    ///
+    /// Formats a string, writing each argument where the format string has a backtick (`).
+    /// The format string is parsed at compile time (see FormatString), and the result is built with one allocation,
+    /// or none if it fits inline.
+    ///
+    template<typename... Args>
+    NODISCARD static String fmt(FormatString<Args...> format, Args const&... args);
 
     /**
      * TODO
@@ -172,16 +224,21 @@ public:
     NODISCARD FORCEINLINE String replace(StringRef s, StringRef r) const { return String(*this).replace(s, r); }
     NODISCARD FORCEINLINE String replace(StringRef s, StringRef r) && { return (replace(s, r), *this); }
 
-    void replace(StringRef substr, StringRef replacement) &
+    ///
+    /// Replaces every (non-overlapping, from left to right) occurrence of a substring.
+    ///
+    void replace(StringRef substr, StringRef replacement) &;
+
+    ///
+    /// Substring search; see StringRef::find, rfind, findAll and count.
+    ///
+    NODISCARD Optional<usize> find(StringRef substr, usize from = 0) const
     {
-        usize baseIndex = 0;
-        Optional<usize> index = None;
-        while ((index = this->find(substr, baseIndex)) != None) {
-            erase(index.ref(), substr.length());
-            insert(index.ref(), replacement);
-            baseIndex += replacement.length();
-        }
+        return StringRef(*this).find(substr, from);
     }
+    NODISCARD Optional<usize> rfind(StringRef substr) const { return StringRef(*this).rfind(substr); }
+    void findAll(StringRef substr, auto const& func) const { StringRef(*this).findAll(substr, func); }
+    NODISCARD usize count(StringRef substr) const { return StringRef(*this).count(substr); }
 
 
     NODISCARD FORCEINLINE String erase(Index i, usize n) const { return String(*this).erase(i, n); }
@@ -220,101 +277,206 @@ public:
     }
 
 public:
+    ///
+    /// Returns the integer at the start of the string (after any spaces or tabs), ignoring whatever follows it, like
+    /// atoll. Returns 0 if there is none, and saturates if it does not fit in a long long.
+    /// Use parse<T>() instead to check that the whole string is an integer.
+    ///
     template<int = 0>
     long long toInteger() const
     {
-        // FIXME: this is the bad atoi, use functions from intbase
-        auto result = 0, negate = 0;
-        auto s = begin();
-        while (*s == ' ' || *s == '\t') {
+        UNSAFE_BEGIN;
+        char const* s = data();
+        char const* end = s + length();
+        while (s != end && (*s == ' ' || *s == '\t')) {
             ++s;
         }
-        if (*s == '+' && *(s.next()) != '-') {
-            ++s;
+        char const* numberEnd = (s != end && (*s == '+' || *s == '-')) ? s + 1 : s;
+        while (numberEnd != end && *numberEnd >= '0' && *numberEnd <= '9') {
+            ++numberEnd;
         }
-        if (*s == '-') {
-            negate = 1;
-            ++s;
+        auto result = parse<long long, IntBaseFmt::B10>(StringRef(s, usize(numberEnd - s)));
+        if (result.isOk()) {
+            return result.unwrap();
         }
-        for (; *s != '\0'; ++s) {
-            switch (*s) {
-            case '0' ... '9':
-                if (__builtin_mul_overflow(result, 10, &result) || __builtin_add_overflow(result, -('0' - *s), &result))
-                    return negate ? -2147483648 : 2147483647;
-                continue;
-            default: break;
-            }
-            break;
+        if (result.error().template is<Errors::Overflow>()) {
+            return *s == '-' ? MIN_VALUE<long long> : MAX_VALUE<long long>;
         }
-        return negate ? -result : result;
+        return 0;
+        UNSAFE_END;
     }
 
 
+    ///
+    /// Returns the number in the string (ignoring spaces and tabs around it), correctly rounded. Returns 0 if the string
+    /// is not a number, and an infinity if the number is too large for a double.
+    /// Use parse<double>() instead to tell those apart from the numbers themselves.
+    ///
     template<int = 0>
     double toDouble() const
     {
-        if (*this == "-inf") {
-            return Double::NEG_INF;
-        } else if (*this == "inf") {
-            return Double::POS_INF;
-        } else if (*this == "NaN") {
-            return Double::QNAN;
+        UNSAFE_BEGIN;
+        char const* s = data();
+        char const* end = s + length();
+        while (s != end && (*s == ' ' || *s == '\t')) {
+            ++s;
         }
-        auto it = begin();
-        while (it != last() && *it != '.') {
-            ++it;
+        while (end != s && (end[-1] == ' ' || end[-1] == '\t')) {
+            --end;
         }
-        auto wholePart = double(toInteger());
-
-        String a;
-        while (it != last()) {
-            ++it;
-            a.append(*it);
+        auto result = parse<double>(StringRef(s, usize(end - s)));
+        if (result.isOk()) {
+            return result.unwrap();
         }
-        if (auto fracInt = a.toInteger(); fracInt != 0) {
-            wholePart +=
-                (double(fracInt) / (Double::pow(10.0, int(Double::floor(Double::log10(double(fracInt))))) * 10.0));
+        if (result.error().template is<Errors::Overflow>()) {
+            return *s == '-' ? Double::NEG_INF : Double::POS_INF;
         }
-        return wholePart;
+        return 0;
+        UNSAFE_END;
     }
 
 private:
-    template<int = 0>
-    static String _fmt(StringRef const& format, ArrayRef<RefWrapper<Printable const>> const& objects)
+    friend class StringBuilder;
+
+    ///
+    /// Takes over a buffer that already holds the characters and the null terminator.
+    ///
+    explicit String(SmallByteVector<INLINE_LENGTH + 1>&& data)
+        : _data(static_cast<SmallByteVector<INLINE_LENGTH + 1>&&>(data))
+    {}
+};
+
+// The inline characters are stored over the pointer, length and capacity words; the rest is the Allocator
+static_assert(sizeof(String) == 3 * sizeof(usize) + sizeof(Allocator));
+
+
+///
+/// Builds a String piece by piece in a single growing buffer.
+/// Unlike appending to a String, nothing is kept null terminated (or shifted) along the way, and the buffer can be
+/// sized up front with reserve(). take() then hands the buffer to a String without copying it, so building a string
+/// whose length is known (or guessed) in advance costs exactly one allocation, or none if it fits inline.
+/// \code{.cpp}
+///     StringBuilder sb;
+///     sb.reserve(64);
+///     sb.append("id=").appendInteger(42).append(',');
+///     String s = sb.take();
+/// \endcode
+///
+class StringBuilder {
+    SmallByteVector<String::INLINE_LENGTH + 1> _data;  // Does not include the null terminator until take()
+
+public:
+    constexpr StringBuilder() = default;
+
+    explicit StringBuilder(Allocator const& alloc)
+        : _data(alloc)
+    {}
+
+    ///
+    /// Creates a builder with room for `capacity` characters.
+    ///
+    explicit StringBuilder(usize capacity, Allocator const& alloc = {})
+        : _data(alloc)
     {
-        String result;
-        auto fmtIter = format.begin();
-        auto objIter = objects.begin();
+        reserve(capacity);
+    }
+
+    ///
+    /// Makes sure that `length` characters can be appended in total without reallocating.
+    ///
+    FORCEINLINE void reserve(usize length) { _data.reserve(length + 1); }
+
+    NODISCARD FORCEINLINE usize length() const { return _data.length(); }
+    NODISCARD FORCEINLINE bool empty() const { return _data.empty(); }
 
-        while (fmtIter.isNotEnd() && *fmtIter != '`') {
-            result.append(*fmtIter);
-            ++fmtIter;
+    ///
+    /// Returns the characters appended so far. They are not null terminated.
+    ///
+    NODISCARD FORCEINLINE char const* data() const { return reinterpret_cast<char const*>(_data.data()); }
+
+    FORCEINLINE StringBuilder& appendChars(char const* chars, usize n)
+    {
+        if (n != 0) {
+            memcpy(_data.extend(n), chars, n);
         }
-        while (objIter.isNotEnd()) {
-            Assert(fmtIter != format.end() && *fmtIter == '`', "More arguments than specified in format string");
-            String str;
-            (*objIter)->output(str);
-            result.append(str);
-            ++objIter;
-            ++fmtIter;
-            while (fmtIter.isNotEnd() && *fmtIter != '`') {
-                result.append(*fmtIter);
-                ++fmtIter;
-            }
+        return *this;
+    }
+
+    FORCEINLINE StringBuilder& append(char c)
+    {
+        *_data.extend(1) = u8(c);
+        return *this;
+    }
+
+    FORCEINLINE StringBuilder& append(StringRef s) { return appendChars(s.data(), s.length()); }
+
+    ///
+    /// Appends an integer in decimal, writing the digits straight into the buffer.
+    ///
+    template<IsInteger T>
+    StringBuilder& appendInteger(T value)
+    {
+        usize n = toCharsLength(value);
+        (void)toChars(value, ArrayRef<char>(reinterpret_cast<char*>(_data.extend(n)), n));
+        return *this;
+    }
+
+    ///
+    /// Appends anything that can be output as a string (see writeFormatted).
+    ///
+    template<typename T>
+    StringBuilder& appendValue(T const& value)
+    {
+        if constexpr (IsUnderlyingTypeOneOf<T, char>) {
+            append(value);
+        } else if constexpr (IsInteger<T>) {
+            appendInteger(value);
+        } else {
+            writeFormatted(value, [&](char const* chars, usize n) { appendChars(chars, n); });
         }
-        return result;
+        return *this;
+    }
+
+    ///
+    /// Moves the contents into a String. The builder is left empty.
+    ///
+    NODISCARD String take()
+    {
+        *_data.extend(1) = '\0';
+        return String(static_cast<SmallByteVector<String::INLINE_LENGTH + 1>&&>(_data));
     }
 };
 
 
-template<typename T>
-constexpr inline void PrintableT<T>::output(String& result) const
+template<typename... Args>
+String String::fmt(FormatString<Args...> format, Args const&... args)
 {
-    if constexpr (IsUnderlyingTypeOneOf<T, String, StringRef, char*, char>) {
-        result.append(*ptr);
-    } else {
-        OutputString(*ptr, [&](char c) { result.append(c); });
+    StringBuilder result(format.literalLength() + (formattedSizeHint(args) + ... + 0));
+    format.expand(
+        [&](char const* chars, usize n) { result.appendChars(chars, n); },
+        [&](auto const& arg) { result.appendValue(arg); }, args...);
+    return result.take();
+}
+
+
+inline void String::replace(StringRef substr, StringRef replacement) &
+{
+    usize n = substr.length();
+    // Count the matches first so that the result is allocated once, at its final size
+    usize matches = count(substr);
+    if (matches == 0) {
+        return;
     }
+    UNSAFE_BEGIN;
+    StringBuilder result(length() - (matches * n) + (matches * replacement.length()), allocator());
+    usize start = 0;
+    findAll(substr, [&](usize i) {
+        result.appendChars(data() + start, i - start).append(replacement);
+        start = i + n;
+    });
+    result.appendChars(data() + start, length() - start);
+    UNSAFE_END;
+    *this = result.take();
 }
 
 
@@ -331,14 +493,6 @@ struct FormatLiteral
     }
 
     constexpr inline usize size() const { return N - 1; }
-
-    // Use a variadic operator() to handle formatting arguments
-    template<typename... Args>
-    inline String operator()(Args&&... args) const
-    {
-        // Replace with your String::fmt logic
-        return String::fmt(fmt, Forward<Args>(args)...);
-    }
 };
 
 template<usize N>
@@ -347,7 +501,8 @@ FormatLiteral(char const (&str)[N]) -> FormatLiteral<N>;
 template<FormatLiteral L>
 constexpr inline auto operator""_fmt()
 {
-    return L;
+    // L is a template parameter object, so its characters are a constant expression that FormatString can parse
+    return [](auto const&... args) { return String::fmt(L.fmt, args...); };
 }
 
 
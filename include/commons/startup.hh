@@ -42,6 +42,7 @@
 extern "C" void* malloc(size_t);
 extern "C" void* aligned_alloc(size_t, size_t);
 extern "C" void free(void*);
+extern "C" size_t malloc_usable_size(void*);
 
 
 inline u32 cm::FastPRNG::_state;
@@ -239,29 +240,86 @@ inline void signalHandlers()
 constexpr std::align_val_t DEFAULT_ALIGNMENT = std::align_val_t(8);
 
 
+///
+/// Returns how many bytes a heap block really occupies, which is what HeapStats counts.
+///
+inline size_t usableSizeImpl(void* ptr)
+{
+#if __has_feature(address_sanitizer)
+    return malloc_usable_size(ptr);
+#else
+    return ::cm::LinuxHeap::usableSize(ptr);
+#endif
+}
+
 inline void* newImpl(std::size_t size, std::align_val_t alignment) noexcept
 {
     void* ptr;
+#if __has_feature(address_sanitizer)
+    // Leave the heap to the sanitizer, so that it can still catch use-after-free and overflows
     if (alignment == DEFAULT_ALIGNMENT) {
         ptr = malloc(size);
     } else {
         ptr = aligned_alloc(static_cast<size_t>(alignment), size);
     }
+#else
+    ptr = ::cm::LinuxHeap::allocate(size, static_cast<size_t>(alignment));
+#endif
     ::cm::Assert(ptr);
+    if constexpr (::cm::HeapStats::ENABLED) {
+        ::cm::HeapStats::recordAllocation(usableSizeImpl(ptr));
+    }
     return ptr;
 }
 
 inline void* newImplNothrow(std::size_t size, std::align_val_t alignment) noexcept
 {
-    return aligned_alloc(static_cast<size_t>(alignment), size);
+#if __has_feature(address_sanitizer)
+    void* ptr = aligned_alloc(static_cast<size_t>(alignment), size);
+#else
+    void* ptr = ::cm::LinuxHeap::allocate(size, static_cast<size_t>(alignment));
+#endif
     // return GC_alloc(size, size_t(alignment));
+    if constexpr (::cm::HeapStats::ENABLED) {
+        if (ptr != nullptr) {
+            ::cm::HeapStats::recordAllocation(usableSizeImpl(ptr));
+        }
+    }
+    return ptr;
 }
 
 inline void deleteImpl(void* ptr)
 {
+    if constexpr (::cm::HeapStats::ENABLED) {
+        if (ptr != nullptr) {
+            ::cm::HeapStats::recordDeallocation(usableSizeImpl(ptr));
+        }
+    }
     // GC_free(ptr);
+#if __has_feature(address_sanitizer)
     free(ptr);
-    (void)ptr;
+#else
+    ::cm::LinuxHeap::deallocate(ptr);
+#endif
+}
+
+///
+/// Sized deallocation, which lets the heap skip looking up the block's size class.
+///
+inline void deleteSizedImpl(void* ptr, std::size_t size, std::align_val_t alignment)
+{
+    if constexpr (::cm::HeapStats::ENABLED) {
+        if (ptr != nullptr) {
+            ::cm::HeapStats::recordDeallocation(usableSizeImpl(ptr));
+        }
+    }
+#if __has_feature(address_sanitizer)
+    (void)size;
+    (void)alignment;
+    free(ptr);
+#else
+    ::cm::LinuxHeap::deallocate(ptr, size, static_cast<size_t>(alignment));
+#endif
 }
 
 
@@ -309,9 +367,31 @@ void operator delete(void* ptr) noexcept { return deleteImpl(ptr); }
 
 void operator delete[](void* ptr) noexcept { return deleteImpl(ptr); }
 
-void operator delete(void* ptr, __SIZE_TYPE__) noexcept { return deleteImpl(ptr); }
+void operator delete(void* ptr, __SIZE_TYPE__ sz) noexcept { return deleteSizedImpl(ptr, sz, DEFAULT_ALIGNMENT); }
+
+void operator delete[](void* ptr, __SIZE_TYPE__ sz) noexcept { return deleteSizedImpl(ptr, sz, DEFAULT_ALIGNMENT); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { return deleteImpl(ptr); }
 
-void operator delete[](void* ptr, __SIZE_TYPE__) noexcept { return deleteImpl(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { return deleteImpl(ptr); }
+
+void operator delete(void* ptr, __SIZE_TYPE__ sz, std::align_val_t al) noexcept { return deleteSizedImpl(ptr, sz, al); }
+
+void operator delete[](void* ptr, __SIZE_TYPE__ sz, std::align_val_t al) noexcept
+{
+    return deleteSizedImpl(ptr, sz, al);
+}
+
+#ifdef CM_HEAP_STATS
+///
+/// Prints the heap statistics to stderr when the program exits.
+///
+[[gnu::destructor]]
+static void _dumpHeapStatsAtExit()
+{
+    ::cm::HeapStats::dump(::cm::stderr);
+}
+#endif
 
 extern "C" [[noreturn]]
 void __cxa_pure_virtual()
@@ -35,6 +35,7 @@
 #include HEADER(system/streamstatus.inl)   // IWYU pragma: keep
 #include HEADER(system/outstream.inl)      // IWYU pragma: keep
 #include HEADER(system/stringstream.inl)   // IWYU pragma: keep
+#include HEADER(system/hashstream.inl)     // IWYU pragma: keep
 #include HEADER(system/listdir.inl)        // IWYU pragma: keep
 #include HEADER(system/shell.inl)          // IWYU pragma: keep
 
@@ -44,6 +45,7 @@
 
 namespace cm {
 #include HEADER(system/linux/linuxsyscall.inl)  // IWYU pragma: keep
+#include HEADER(system/linux/linuxheap.inl)     // IWYU pragma: keep
 #include HEADER(system/linux/linuxstdout.inl)   // IWYU pragma: keep
 #include HEADER(system/linux/linuxfileout.inl)  // IWYU pragma: keep
 #include HEADER(system/linux/linuxshell.inl)    // IWYU pragma: keep
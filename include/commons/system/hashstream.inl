@@ -0,0 +1,68 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+*/
+
+#pragma once
+#ifdef __inline_sys_header__
+
+namespace cm {
+
+///
+/// Defines a stream that hashes everything written to it on the way to another stream, e.g. to checksum a file while it
+/// is written through a LinuxFileOutStream:
+///
+///     HashingOutStream<Crc32, LinuxFileOutStream> out(file);
+///     out.println("...");
+///     auto checksum = out.hash();
+///
+/// The hash is the same as Hash<Hasher>::hashData on all the bytes written, no matter how the writes split them.
+///
+template<typename Hasher, typename Target>
+struct HashingOutStream : public IOutStream<HashingOutStream<Hasher, Target>>
+{
+    using Status = StreamStatus;
+
+    HashingOutStream() = delete;
+    HashingOutStream(Target& to, typename Hasher::SeedType seed = Hasher::DEFAULT_SEED)
+        : _to(to), _state(seed)
+    {}
+
+    inline HashingOutStream& writeBytes(void const* data, usize sizeBytes)
+    {
+        _state.update(data, sizeBytes);
+        _to.writeBytes(data, sizeBytes);
+        return *this;
+    }
+
+    inline HashingOutStream& flush()
+    {
+        _to.flush();
+        return *this;
+    }
+
+    inline Result<Status, Status> close() { return _to.close(); }
+
+    inline Status status() const { return _to.status(); }
+
+    ///
+    /// Returns the hash of everything written so far.
+    ///
+    NODISCARD inline Hasher::HashResult hash() const { return _state.finalize(); }
+
+private:
+    Target& _to;
+    HashState<Hasher> _state;
+};
+
+}  // namespace cm
+#endif
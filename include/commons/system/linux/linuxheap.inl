@@ -0,0 +1,506 @@
+/*
+   Copyright 2025 Anthony A. Constantinescu.
+
+   Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+   in compliance with the License. You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+
+   File: commons/system/linux/linuxheap.inl
+   Description: The size-class heap behind the global operator new/delete
+*/
+
+#pragma once
+#ifdef __inline_sys_header__
+
+///
+/// The general-purpose heap on Linux, which backs the global operator new/delete (see startup.hh).
+///
+/// Small requests are rounded up to one of NUM_SIZE_CLASSES size classes: multiples of 16 bytes up to 128, then four
+/// classes per power of two up to MAX_SMALL_SIZE. Each class keeps a free list of blocks carved out of SPAN_SIZE spans
+/// obtained with mmap. Spans are aligned to their own size, so the header at the start of a span (which records the
+/// size class) can be found from any block inside of it by masking off the low bits of the address. Sized deletes skip
+/// even that, since the class can be computed from the size.
+///
+/// Larger requests, and requests aligned to more than a page, get a mapping of their own, with the same kind of header
+/// in front. Mappings of at least
+/// HUGE_PAGE_THRESHOLD bytes are aligned to HUGE_PAGE_SIZE and marked with madvise(MADV_HUGEPAGE), so that streaming
+/// over them does not take a TLB miss every 4 KB.
+/// Memory in spans is reused by the size class, but is never returned to the system.
+///
+/// In front of the shared free lists, every thread has a small cache of free blocks per size class, so that the common
+/// case of allocating and freeing touches only thread-local memory. When a cache runs empty it is refilled with a batch
+/// of blocks from the shared list, and when it grows past its limit half of it is flushed back in one batch.
+///
+struct LinuxHeap
+{
+    constexpr static usize SPAN_SIZE = 256_KB;
+    constexpr static usize PAGE_SIZE = 4_KB;
+    constexpr static usize DATA_OFFSET = PAGE_SIZE;  // Blocks start a page into the span
+    constexpr static usize MIN_ALIGNMENT = 16;
+    constexpr static usize MAX_SMALL_SIZE = 32_KB;
+    constexpr static u32 NUM_SIZE_CLASSES = 40;
+    constexpr static u32 LARGE = 0xffffffff;
+    constexpr static u32 SPAN_MAGIC = 0x5ba45ba4;
+    constexpr static usize HUGE_PAGE_SIZE = 2_MB;
+    constexpr static usize HUGE_PAGE_THRESHOLD = 32_MB;
+    constexpr static u64 MADV_HUGEPAGE = 14;
+    constexpr static u64 MADV_NOHUGEPAGE = 15;
+
+    struct SpanHeader
+    {
+        u32 sizeClass;
+        u32 magic;
+        usize mappingSize;
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct SizeClass
+    {
+        SpinLock lock;
+        FreeBlock* freeList;
+        u8* bump;
+        u8* bumpEnd;
+    };
+
+    ///
+    /// Free blocks cached by one thread. On thread exit the cached blocks are returned to the shared free lists.
+    ///
+    struct ThreadCache
+    {
+        struct Bin
+        {
+            FreeBlock* head;
+            u32 count;
+        };
+        Bin bins[NUM_SIZE_CLASSES];
+        bool disabled;
+
+        ~ThreadCache()
+        {
+            for (u32 c = 0; c < NUM_SIZE_CLASSES; c++) {
+                _flush(c, UNSAFE(bins[c]).count);
+            }
+            disabled = true;  // in case other thread-exit code still frees memory
+        }
+    };
+
+    constexpr static usize CACHE_BYTES_PER_CLASS = 64_KB;
+
+    ///
+    /// Returns the number of blocks a thread may cache for a size class before it flushes half of them.
+    ///
+    FORCEINLINE constexpr static u32 cacheLimit(u32 sizeClass)
+    {
+        return u32(max(usize(4), min(usize(256), CACHE_BYTES_PER_CLASS / classSize(sizeClass))));
+    }
+
+    ///
+    /// Returns the index of the smallest size class that fits sizeBytes (which must be at most MAX_SMALL_SIZE).
+    ///
+    FORCEINLINE constexpr static u32 sizeClassOf(usize sizeBytes)
+    {
+        if (sizeBytes <= 128) {
+            return u32((max(sizeBytes, usize(1)) + 15) / 16 - 1);
+        }
+        auto k = u32(63 - __builtin_clzll(sizeBytes - 1));  // 2^k < sizeBytes <= 2^(k+1)
+        return 8 + (k - 7) * 4 + u32((sizeBytes - 1 - (usize(1) << k)) >> (k - 2));
+    }
+
+    ///
+    /// Returns the block size of a size class.
+    ///
+    FORCEINLINE constexpr static usize classSize(u32 sizeClass)
+    {
+        if (sizeClass < 8) {
+            return (sizeClass + 1) * 16;
+        }
+        auto k = (sizeClass - 8) / 4 + 7;
+        auto j = (sizeClass - 8) % 4;
+        return (usize(1) << k) + (j + 1) * (usize(1) << (k - 2));
+    }
+
+    ///
+    /// Returns the size class an allocation is served from, or LARGE if it gets its own mapping.
+    /// Over-aligned requests go to the first class whose block size is a multiple of the alignment; since blocks start
+    /// at a page boundary in their span, every block in such a class is aligned. That only holds up to the page size,
+    /// so requests aligned to more than a page get their own mapping.
+    ///
+    FORCEINLINE constexpr static u32 classFor(usize sizeBytes, usize alignment)
+    {
+        if (sizeBytes > MAX_SMALL_SIZE || alignment > PAGE_SIZE) {
+            return LARGE;
+        }
+        if (alignment <= MIN_ALIGNMENT) {
+            return sizeClassOf(sizeBytes);
+        }
+        auto c = sizeClassOf(max(sizeBytes, alignment));
+        while (c < NUM_SIZE_CLASSES && (classSize(c) & (alignment - 1)) != 0) {
+            c++;
+        }
+        return c < NUM_SIZE_CLASSES ? c : LARGE;
+    }
+
+    ///
+    /// Allocates memory, or returns nullptr if the system is out of memory. The alignment must be a power of two.
+    ///
+    [[gnu::malloc, gnu::alloc_size(1), gnu::alloc_align(2)]]
+    static void* allocate(usize sizeBytes, usize alignment = MIN_ALIGNMENT)
+    {
+        auto c = classFor(sizeBytes, alignment);
+        if (c == LARGE) [[unlikely]] {
+            return alignment > PAGE_SIZE ? _allocateAligned(sizeBytes, alignment) : _allocateLarge(sizeBytes);
+        }
+        return _allocateSmall(c);
+    }
+
+    ///
+    /// Frees memory from allocate(), finding its size class through the span header.
+    ///
+    static void deallocate(void* ptr)
+    {
+        if (ptr == nullptr) {
+            return;
+        }
+        auto* span = spanOf(ptr);
+        Assert(span->magic == SPAN_MAGIC, ASMS_DATA_CORRUPTION);
+        if (span->sizeClass == LARGE) {
+            _deallocateLarge(span);
+        } else {
+            _deallocateSmall(ptr, span->sizeClass);
+        }
+    }
+
+    ///
+    /// Frees memory from allocate() when the size and alignment of the request are known, which avoids touching the
+    /// span header for small blocks.
+    ///
+    static void deallocate(void* ptr, usize sizeBytes, usize alignment)
+    {
+        if (ptr == nullptr) {
+            return;
+        }
+        auto c = classFor(sizeBytes, alignment);
+        if (c == LARGE) [[unlikely]] {
+            _deallocateLarge(spanOf(ptr));
+        } else {
+            _deallocateSmall(ptr, c);
+        }
+    }
+
+    ///
+    /// Returns the number of usable bytes in a block from allocate(), which is at least the size that was requested.
+    ///
+    static usize usableSize(void* ptr)
+    {
+        auto* span = spanOf(ptr);
+        if (span->sizeClass == LARGE) {
+            return span->mappingSize - (reinterpret_cast<usize>(ptr) - reinterpret_cast<usize>(span));
+        }
+        return classSize(span->sizeClass);
+    }
+
+    ///
+    /// Returns the number of free blocks of a size class in the calling thread's cache.
+    ///
+    static u32 cachedBlocks(u32 sizeClass) { return _bin(sizeClass).count; }
+
+    ///
+    /// Returns the header of the span (or large mapping) containing ptr.
+    /// No block starts at the beginning of a span, except for mappings aligned to SPAN_SIZE or more, which keep their
+    /// header in the page before the block instead.
+    ///
+    FORCEINLINE static SpanHeader* spanOf(void* ptr)
+    {
+        auto span = reinterpret_cast<usize>(ptr) & ~(SPAN_SIZE - 1);
+        if (span == reinterpret_cast<usize>(ptr)) [[unlikely]] {
+            span -= PAGE_SIZE;
+        }
+        return reinterpret_cast<SpanHeader*>(span);
+    }
+
+    ///
+    /// Maps sizeBytes (a multiple of the page size) of memory aligned to the given alignment, or returns nullptr.
+    ///
+    static u8* mapAligned(usize sizeBytes, usize alignment)
+    {
+        auto padded = sizeBytes + alignment - PAGE_SIZE;
+        auto result = LinuxSyscall(
+            LinuxSyscall.mmap, 0, padded, 0x1 | 0x2 /* PROT_READ | PROT_WRITE */,
+            0x02 | 0x20 /* MAP_PRIVATE | MAP_ANONYMOUS */, u64(-1), 0);
+        if (result > u64(-4096)) [[unlikely]] {
+            return nullptr;
+        }
+        auto base = usize(result);
+        auto aligned = alignUp(base, alignment);
+        if (aligned != base) {
+            LinuxSyscall(LinuxSyscall.munmap, base, aligned - base);
+        }
+        if (auto tail = (base + padded) - (aligned + sizeBytes); tail != 0) {
+            LinuxSyscall(LinuxSyscall.munmap, aligned + sizeBytes, tail);
+        }
+        return reinterpret_cast<u8*>(aligned);
+    }
+
+    ///
+    /// Allocator functions for PageAllocator and HugePageAllocator (below), which map every allocation directly.
+    /// The state pointer is unused; the page size is picked by which function is called.
+    ///
+    static void* allocatePages(void*, usize sizeBytes, usize alignment)
+    {
+        if (alignment > PAGE_SIZE) [[unlikely]] {
+            return nullptr;
+        }
+        auto* ptr = mapAligned(alignUp(sizeBytes, PAGE_SIZE), PAGE_SIZE);
+        if (ptr != nullptr) {
+            LinuxSyscall(LinuxSyscall.madvise, usize(ptr), alignUp(sizeBytes, PAGE_SIZE), MADV_NOHUGEPAGE);
+        }
+        return ptr;
+    }
+
+    static void deallocatePages(void*, void* ptr, usize sizeBytes, usize)
+    {
+        LinuxSyscall(LinuxSyscall.munmap, usize(ptr), alignUp(sizeBytes, PAGE_SIZE));
+    }
+
+    static void* allocateHugePages(void*, usize sizeBytes, usize alignment)
+    {
+        if (alignment > HUGE_PAGE_SIZE) [[unlikely]] {
+            return nullptr;
+        }
+        auto* ptr = mapAligned(alignUp(sizeBytes, HUGE_PAGE_SIZE), HUGE_PAGE_SIZE);
+        if (ptr != nullptr) {
+            LinuxSyscall(LinuxSyscall.madvise, usize(ptr), alignUp(sizeBytes, HUGE_PAGE_SIZE), MADV_HUGEPAGE);
+        }
+        return ptr;
+    }
+
+    static void deallocateHugePages(void*, void* ptr, usize sizeBytes, usize)
+    {
+        LinuxSyscall(LinuxSyscall.munmap, usize(ptr), alignUp(sizeBytes, HUGE_PAGE_SIZE));
+    }
+
+private:
+    inline static SizeClass _classes[NUM_SIZE_CLASSES];
+    inline static thread_local ThreadCache _cache;
+
+    FORCEINLINE static SizeClass& _class(u32 c) { return UNSAFE(_classes[c]); }
+    FORCEINLINE static ThreadCache::Bin& _bin(u32 c) { return UNSAFE(_cache.bins[c]); }
+
+    FORCEINLINE static void* _allocateSmall(u32 c)
+    {
+        auto& bin = _bin(c);
+        if (auto* block = bin.head; block != nullptr) [[likely]] {
+            bin.head = block->next;
+            bin.count--;
+            return block;
+        }
+        return _refill(c);
+    }
+
+    FORCEINLINE static void _deallocateSmall(void* ptr, u32 c)
+    {
+        auto& bin = _bin(c);
+        auto* block = static_cast<FreeBlock*>(ptr);
+        if (_cache.disabled) [[unlikely]] {
+            block->next = nullptr;
+            _pushShared(c, block, block);
+            return;
+        }
+        block->next = bin.head;
+        bin.head = block;
+        if (++bin.count > cacheLimit(c)) [[unlikely]] {
+            _flush(c, bin.count / 2);
+        }
+    }
+
+    ///
+    /// Moves a batch of blocks from the shared free list (or a fresh span) into this thread's cache and returns one of
+    /// them.
+    ///
+    [[clang::noinline]]
+    static void* _refill(u32 c)
+    {
+        auto& sc = _class(c);
+        auto batch = _cache.disabled ? 1 : cacheLimit(c) / 2;
+        FreeBlock* head = nullptr;
+        u32 n = 0;
+
+        sc.lock.lock();
+        for (; n < batch; n++) {
+            auto* block = sc.freeList;
+            if (block != nullptr) {
+                sc.freeList = block->next;
+            } else if ((block = static_cast<FreeBlock*>(_carve(sc, c))) == nullptr) {
+                break;
+            }
+            block->next = head;
+            head = block;
+        }
+        sc.lock.unlock();
+
+        if (head == nullptr) {
+            return nullptr;
+        }
+        auto& bin = _bin(c);
+        bin.head = head->next;
+        bin.count = n - 1;
+        return head;
+    }
+
+    ///
+    /// Moves the first n blocks of this thread's cache back to the shared free list.
+    ///
+    [[clang::noinline]]
+    static void _flush(u32 c, u32 n)
+    {
+        if (n == 0) {
+            return;
+        }
+        auto& bin = _bin(c);
+        auto* first = bin.head;
+        auto* last = first;
+        for (u32 i = 1; i < n; i++) {
+            last = last->next;
+        }
+        bin.head = last->next;
+        bin.count -= n;
+        _pushShared(c, first, last);
+    }
+
+    ///
+    /// Prepends a chain of blocks to the shared free list of a size class.
+    ///
+    static void _pushShared(u32 c, FreeBlock* first, FreeBlock* last)
+    {
+        auto& sc = _class(c);
+        sc.lock.lock();
+        last->next = sc.freeList;
+        sc.freeList = first;
+        sc.lock.unlock();
+    }
+
+    ///
+    /// Takes a new block from the span being carved up, mapping a new span when it runs out.
+    /// Must be called with the size class locked.
+    ///
+    [[clang::noinline]]
+    static void* _carve(SizeClass& sc, u32 c)
+    {
+        UNSAFE_BEGIN;
+        auto size = classSize(c);
+        if (sc.bump == nullptr || sc.bump + size > sc.bumpEnd) {
+            auto* span = mapAligned(SPAN_SIZE, SPAN_SIZE);
+            if (span == nullptr) {
+                return nullptr;
+            }
+            *reinterpret_cast<SpanHeader*>(span) = {c, SPAN_MAGIC, SPAN_SIZE};
+            sc.bump = span + DATA_OFFSET;
+            sc.bumpEnd = span + SPAN_SIZE;
+        }
+        auto* block = sc.bump;
+        sc.bump += size;
+        return block;
+        UNSAFE_END;
+    }
+
+    static void* _allocateLarge(usize sizeBytes)
+    {
+        if (sizeBytes > (usize(1) << 47)) [[unlikely]] {
+            return nullptr;
+        }
+        if (sizeBytes + DATA_OFFSET >= HUGE_PAGE_THRESHOLD) {
+            auto mappingSize = alignUp(sizeBytes + DATA_OFFSET, HUGE_PAGE_SIZE);
+            auto* base = mapAligned(mappingSize, HUGE_PAGE_SIZE);
+            if (base == nullptr) {
+                return nullptr;
+            }
+            LinuxSyscall(LinuxSyscall.madvise, usize(base), mappingSize, MADV_HUGEPAGE);
+            *reinterpret_cast<SpanHeader*>(base) = {LARGE, SPAN_MAGIC, mappingSize};
+            return UNSAFE(base + DATA_OFFSET);
+        }
+        auto mappingSize = alignUp(sizeBytes + DATA_OFFSET, PAGE_SIZE);
+        auto* base = mapAligned(mappingSize, SPAN_SIZE);
+        if (base == nullptr) {
+            return nullptr;
+        }
+        *reinterpret_cast<SpanHeader*>(base) = {LARGE, SPAN_MAGIC, mappingSize};
+        return UNSAFE(base + DATA_OFFSET);
+    }
+
+    ///
+    /// Maps a block aligned to more than a page. Below SPAN_SIZE, the block starts alignment bytes into a mapping that
+    /// is aligned to SPAN_SIZE, so the header is still at the start of the span. From SPAN_SIZE on, the block starts on
+    /// a span boundary, and the mapping starts a page before it, where spanOf() looks for the header.
+    ///
+    static void* _allocateAligned(usize sizeBytes, usize alignment)
+    {
+        UNSAFE_BEGIN;
+        if (sizeBytes > (usize(1) << 47) || alignment > (usize(1) << 40)) [[unlikely]] {
+            return nullptr;
+        }
+        if (alignment < SPAN_SIZE) {
+            auto mappingSize = alignUp(sizeBytes + alignment, PAGE_SIZE);
+            auto* base = mapAligned(mappingSize, SPAN_SIZE);
+            if (base == nullptr) {
+                return nullptr;
+            }
+            *reinterpret_cast<SpanHeader*>(base) = {LARGE, SPAN_MAGIC, mappingSize};
+            return base + alignment;
+        }
+        auto mappingSize = PAGE_SIZE + alignUp(sizeBytes, PAGE_SIZE);
+        auto* base = mapAligned(alignment - PAGE_SIZE + mappingSize, alignment);
+        if (base == nullptr) {
+            return nullptr;
+        }
+        auto* header = base + alignment - PAGE_SIZE;
+        LinuxSyscall(LinuxSyscall.munmap, usize(base), alignment - PAGE_SIZE);
+        *reinterpret_cast<SpanHeader*>(header) = {LARGE, SPAN_MAGIC, mappingSize};
+        return header + PAGE_SIZE;
+        UNSAFE_END;
+    }
+
+    static void _deallocateLarge(SpanHeader* span)
+    {
+        Assert(span->magic == SPAN_MAGIC && span->sizeClass == LARGE, ASMS_DATA_CORRUPTION);
+        LinuxSyscall(LinuxSyscall.munmap, usize(span), span->mappingSize);
+    }
+};
+
+///
+/// An Allocator that maps each allocation directly with 4 KB pages, and unmaps it when it is freed.
+///
+inline constexpr Allocator PageAllocator = Allocator(nullptr, LinuxHeap::allocatePages, LinuxHeap::deallocatePages);
+
+///
+/// An Allocator that maps each allocation directly, aligned to 2 MB and advised to use transparent huge pages.
+/// Meant for large buffers that are streamed over; every allocation takes at least 2 MB.
+///
+inline constexpr Allocator HugePageAllocator =
+    Allocator(nullptr, LinuxHeap::allocateHugePages, LinuxHeap::deallocateHugePages);
+
+///
+/// Creates a variable-length Array whose elements live in huge pages.
+/// @param length The number of elements
+///
+template<typename T>
+inline Array<T> HugePageArray(usize length)
+{
+    return Array<T>(length, HugePageAllocator);
+}
+
+static_assert(LinuxHeap::sizeClassOf(LinuxHeap::MAX_SMALL_SIZE) == LinuxHeap::NUM_SIZE_CLASSES - 1);
+static_assert(LinuxHeap::classSize(LinuxHeap::NUM_SIZE_CLASSES - 1) == LinuxHeap::MAX_SMALL_SIZE);
+static_assert(LinuxHeap::classSize(LinuxHeap::sizeClassOf(129)) == 160);
+static_assert(sizeof(LinuxHeap::SpanHeader) <= LinuxHeap::DATA_OFFSET);
+
+#endif
@@ -90,7 +90,7 @@ public:
     ///
     inline void print(auto const& value) const
     {
-        _print('`', ArrayRef<RefWrapper<Printable const>>{RefWrapper<Printable const>(PrintableT(value))});
+        writeFormatted(value, [&](char const* chars, usize n) { writeBytes(chars, n); });
     }
     template<int N>
     inline void print(char const (&str)[N]) const
@@ -100,12 +100,17 @@ public:
 
     ///
     /// Print a text followed to the stream with a format specifier.
+    /// The format string is parsed at compile time, and each argument is written straight to the stream.
     /// @param sFmt The format string
     /// @param args The arguments
     ///
-    inline void print(StringRef const& sFmt, auto const&... args) const
+    template<typename... Args>
+    inline void print(FormatString<Args...> sFmt, Args const&... args) const
     {
-        this->_print(sFmt, ArrayRef<RefWrapper<Printable const>>{(RefWrapper<Printable const>(PrintableT(args)))...});
+        sFmt.expand(
+            [&](char const* chars, usize n) { writeBytes(chars, n); },
+            [&](auto const& arg) { writeFormatted(arg, [&](char const* chars, usize n) { writeBytes(chars, n); }); },
+            args...);
     }
 
     /// =========================================================================================================================
@@ -131,36 +136,11 @@ public:
     /// @param sFmt The format string
     /// @param args The arguments
     ///
-    inline void println(StringRef sFmt, auto const&... args) const { print(sFmt, args...), print(LS); }
-
-
-private:
-    void _print(StringRef const& format, ArrayRef<RefWrapper<Printable const>> const& objects) const
+    template<typename... Args>
+    inline void println(FormatString<Args...> sFmt, Args const&... args) const
     {
-        auto fmtIter = format.begin();
-        auto objIter = objects.begin();
-
-        while (fmtIter.isNotEnd() && *fmtIter != '`') {
-            char ch = *fmtIter;
-            this->writeBytes(&ch, sizeof(char));
-            ++fmtIter;
-        }
-        while (objIter.isNotEnd()) {
-            Assert(fmtIter != format.end() && *fmtIter == '`', "More arguments than specified in format string");
-
-            String str;
-            (*objIter)->output(str);
-            this->writeBytes(str.cstr(), str.sizeBytes());
-
-            ++objIter;
-            ++fmtIter;
-
-            while (fmtIter.isNotEnd() && *fmtIter != '`') {
-                char ch = *fmtIter;
-                this->writeBytes(&ch, sizeof(char));
-                ++fmtIter;
-            }
-        }
+        print(sFmt, args...);
+        print(LS);
     }
 };
 
@@ -0,0 +1,41 @@
+#include <commons/system.hh>
+#include <commons/datastructs.hh>
+#include <commons/startup.hh>
+#include "benchmark.hh"
+#include "benchallocator.cc"
+#include "benchheap.cc"
+#include "benchhugepages.cc"
+#include "benchrope.cc"
+#include "benchtochars.cc"
+#include "benchfloat.cc"
+#include "benchparse.cc"
+#include "benchcsv.cc"
+#include "benchmemory.cc"
+#include "benchstrings.cc"
+#include "benchsearch.cc"
+#include "benchmatch.cc"
+#include "benchhash.cc"
+#include "benchmap.cc"
+
+
+using namespace cm;
+
+
+int main()
+{
+    benchAllocator();
+    benchHeap();
+    benchHugePages();
+    benchRope();
+    benchToChars();
+    benchFloat();
+    benchParse();
+    benchCsv();
+    benchMemory();
+    benchStrings();
+    benchSearch();
+    benchMatch();
+    benchHash();
+    benchMap();
+    benchFixedMap();
+}
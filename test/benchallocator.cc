@@ -0,0 +1,34 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Simulates a request handler that builds a few strings and a short list, then throws everything away.
+/// Compares taking every buffer from the global heap against taking them from an Arena that is reset per request.
+///
+inline void benchAllocator()
+{
+    stdout.println("\nBENCHMARK Allocator (per-request allocation cost)");
+    constexpr u64 REQUESTS = 100'000;
+    constexpr u32 ITEMS_PER_REQUEST = 32;
+
+    auto handleRequest = [&](Allocator const& alloc, u64 request) {
+        DLList<u64> ids(alloc);
+        String body(alloc);
+        for (u32 i = 0; i < ITEMS_PER_REQUEST; i++) {
+            ids.end().insert(request + i);
+            body.append("header-value;");
+        }
+        Array<u64> scratch(usize(ITEMS_PER_REQUEST), alloc);
+        bench::doNotOptimize(ids.length() + body.length() + scratch.length());
+    };
+
+    bench::report("heap", bench::measure(REQUESTS, [&](u64 request) { handleRequest(Allocator(), request); }));
+
+    Arena arena;
+    bench::report("arena", bench::measure(REQUESTS, [&](u64 request) {
+                      handleRequest(arena, request);
+                      arena.reset();
+                  }));
+    stdout.println("  arena reserved ` bytes", arena.reservedBytes());
+}
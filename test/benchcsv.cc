@@ -0,0 +1,98 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Text to floating point, on the kind of numeric CSV data that gets loaded in bulk: rows of a price with 2 decimals,
+/// a latitude and a longitude with 6, and a measurement written with the shortest digits. The fields are parsed by
+/// accumulating digits in a double and scaling by a power of ten (what String::toDouble used to amount to, without
+/// its allocation; it is not correctly rounded) vs. parse<double> and parse<float>.
+///
+inline void benchCsv()
+{
+    stdout.println("\nBENCHMARK Text to floating point (CSV)");
+    constexpr u64 ITERATIONS = 50;
+    constexpr usize ROWS = 4096;
+    constexpr usize COLUMNS = 4;
+
+    auto digitLoop = [](StringRef s) {
+        UNSAFE_BEGIN;
+        char const* p = s.data();
+        char const* end = p + s.length();
+        bool negative = p != end && *p == '-';
+        p += negative ? 1 : 0;
+        double value = 0;
+        double scale = 1;
+        for (bool fraction = false; p != end && *p != 'e'; p++) {
+            if (*p == '.') {
+                fraction = true;
+                continue;
+            }
+            value = (value * 10) + (*p - '0');
+            scale *= fraction ? 10 : 1;
+        }
+        i64 exponent = 0;
+        if (p != end) {
+            exponent = parse<i64, IntBaseFmt::B10>(StringRef(p + 1, usize(end - p - 1))).unwrap();
+        }
+        for (; exponent > 0; exponent--) {
+            value *= 10;
+        }
+        for (; exponent < 0; exponent++) {
+            scale *= 10;
+        }
+        return negative ? -value / scale : value / scale;
+        UNSAFE_END;
+    };
+
+    static char text[ROWS * COLUMNS * FLOAT_TO_CHARS_MAX_LENGTH];
+    usize length = 0;
+    auto append = [&](double value, FloatFormat format, Optional<u32> precision, char separator) {
+        UNSAFE_BEGIN;
+        length += toChars(value, ArrayRef<char>(text + length, FLOAT_TO_CHARS_MAX_LENGTH), format, precision).val();
+        text[length++] = separator;
+        UNSAFE_END;
+    };
+    for (usize i = 0; i < ROWS; i++) {
+        u64 bits = (i + 1) * 0x9E3779B97F4A7C15ull;
+        double unit = double(bits >> 11) * 0x1p-53;
+        double scale = 1e-3;
+        for (u64 e = i % 8; e != 0; e--) {
+            scale *= 10;
+        }
+        append(unit * 10'000, FloatFormat::FIXED, 2u, ',');
+        append((unit * 180) - 90, FloatFormat::FIXED, 6u, ',');
+        append((double((bits >> 7) % 360'000'000) * 1e-6) - 180, FloatFormat::FIXED, 6u, ',');
+        append(unit * scale, FloatFormat::GENERAL, None, '\n');
+    }
+
+    // Calls field(chars) for every field, and returns the sum of what it returns
+    auto forEachField = [&](auto const& field) {
+        UNSAFE_BEGIN;
+        double sum = 0;
+        usize start = 0;
+        for (usize i = 0; i < length; i++) {
+            if (text[i] == ',' || text[i] == '\n') {
+                sum += double(field(StringRef(text + start, i - start)));
+                start = i + 1;
+            }
+        }
+        return sum;
+        UNSAFE_END;
+    };
+    double total = 0;
+    auto naive = bench::measure(ITERATIONS, [&](u64) { total += forEachField(digitLoop); });
+    auto doubles = bench::measure(ITERATIONS, [&](u64) {
+        total += forEachField([](StringRef s) { return parse<double>(s).unwrap(); });
+    });
+    auto floats = bench::measure(ITERATIONS, [&](u64) {
+        total += forEachField([](StringRef s) { return parse<float>(s).unwrap(); });
+    });
+    bench::doNotOptimize(total);
+
+    // Bytes per nanosecond is GB/s; the throughput is reported in MB/s
+    auto throughput = [&](u64 nanoseconds) { return (length * 1000) / max(nanoseconds, u64(1)); };
+    stdout.println("  ` rows, ` bytes", ROWS, length);
+    stdout.println("  digit loop ` MB/s, parse<double> ` MB/s, parse<float> ` MB/s", throughput(naive),
+        throughput(doubles), throughput(floats));
+}
@@ -0,0 +1,58 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Floating point to text: the digit loop outputStringForPrimitiveType used to have (repeatedly multiplying the
+/// fraction by 10, which neither round trips nor stops at the shortest digits) vs. toChars, shortest and with a
+/// precision, over an array of doubles spread across magnitudes.
+///
+inline void benchFloat()
+{
+    stdout.println("\nBENCHMARK Floating point to text");
+    constexpr u64 ITERATIONS = 1'000'000;
+    constexpr usize VALUES = 1024;
+
+    auto digitLoop = [](double val, char* buffer) {
+        usize n = 0;
+        if (val < 0) {
+            UNSAFE(buffer[n++] = '-');
+            val = -val;
+        }
+        n += toChars(i64(val), ArrayRef<char>(UNSAFE(buffer + n), TO_CHARS_MAX_LENGTH<i64>)).val();
+        UNSAFE(buffer[n++] = '.');
+        for (int i = 0; i < 16; i++) {
+            val = (val - double(i64(val))) * 10;
+            UNSAFE(buffer[n++] = char('0' + i64(val)));
+        }
+        return n;
+    };
+
+    double values[VALUES];
+    for (usize i = 0; i < VALUES; i++) {
+        // Uniform in [0, 1) scaled by 10^-3 .. 10^12, with both signs
+        u64 bits = (i + 1) * 0x9E3779B97F4A7C15ull;
+        double unit = double(bits >> 11) * 0x1p-53;
+        double scale = 1e-3;
+        for (u64 e = i % 16; e != 0; e--) {
+            scale *= 10;
+        }
+        UNSAFE(values[i] = (bits & 1) ? unit * scale : -unit * scale);
+    }
+
+    char buffer[64];
+    usize total = 0;
+    auto naive = bench::measure(ITERATIONS, [&](u64 i) { total += digitLoop(UNSAFE(values[i % VALUES]), buffer); });
+    auto shortest = bench::measure(ITERATIONS, [&](u64 i) {
+        total += toChars(UNSAFE(values[i % VALUES]), buffer).val();
+    });
+    auto precision = bench::measure(ITERATIONS, [&](u64 i) {
+        total += toChars(UNSAFE(values[i % VALUES]), buffer, FloatFormat::SCIENTIFIC, 6u).val();
+    });
+    auto exact = bench::measure(ITERATIONS, [&](u64 i) {
+        total += toChars(UNSAFE(values[i % VALUES]), buffer, FloatFormat::SCIENTIFIC, 20u).val();
+    });
+    bench::doNotOptimize(total);
+    stdout.println("  digit loop ` ns, toChars shortest ` ns", naive, shortest);
+    stdout.println("  toChars 7 digits ` ns, 21 digits (exact expansion) ` ns", precision, exact);
+}
@@ -0,0 +1,57 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Hashing buffers of a few sizes: one Crc32::hash8 per byte (what Hash::hashData used to do) vs. Hash::hashData with
+/// the bulk CRC32C path and with the 64-bit hashers, then the same hashers through HashState.
+///
+inline void benchHash()
+{
+    stdout.println("\nBENCHMARK Hashing (Hash<Hasher>::hashData)");
+    constexpr usize LARGEST = 1_MB;
+    static u8 data[LARGEST];
+    for (usize i = 0; i < LARGEST; i++) {
+        UNSAFE(data[i] = u8(((i + 1) * 0x9E3779B97F4A7C15ull) >> 56));
+    }
+
+    for (usize n : {16uz, 64uz, 4096uz, LARGEST}) {
+        // About 256 MB hashed per measurement
+        u64 iterations = (256 * 1_MB) / n;
+        u64 total = 0;
+        auto naive = bench::measure(iterations, [&](u64 i) {
+            u32 seed = u32(i);
+            for (usize k = 0; k < n; k++) {
+                seed = Crc32::hash8(UNSAFE(data[k]), seed);
+            }
+            total ^= seed;
+        });
+        auto crc = bench::measure(iterations, [&](u64 i) { total ^= Hash<Crc32>::hashData(data, n, u32(i)); });
+        auto wy = bench::measure(iterations, [&](u64 i) { total ^= Hash<WyHash>::hashData(data, n, i); });
+        auto xxh3 = bench::measure(iterations, [&](u64 i) { total ^= Hash<Xxh3>::hashData(data, n, i); });
+        bench::doNotOptimize(total);
+        // Bytes per nanosecond is GB/s; the throughput is reported in MB/s
+        auto throughput = [&](u64 nanoseconds) { return (n * 1000) / max(nanoseconds, u64(1)); };
+        stdout.println("  ` bytes: hash8 loop ` MB/s, Crc32 ` MB/s, WyHash ` MB/s, Xxh3 ` MB/s", n, throughput(naive),
+            throughput(crc), throughput(wy), throughput(xxh3));
+    }
+
+    // The whole buffer given to HashState in pieces of the size LinuxFileOutStream writes by default, which should
+    // cost about the same as hashing it in one call
+    stdout.println("  1 MB in 4 KB pieces through HashState:");
+    auto streamed = [&]<typename Hasher>(StringRef name) {
+        u64 total = 0;
+        auto ns = bench::measure(256, [&](u64 i) {
+            HashState<Hasher> state{typename Hasher::SeedType(i)};
+            for (usize k = 0; k < LARGEST; k += 4_KB) {
+                state.update(ArrayRef<u8>(UNSAFE(data + k), 4_KB));
+            }
+            total ^= state.finalize();
+        });
+        bench::doNotOptimize(total);
+        stdout.println("    `: ` MB/s", name, (LARGEST * 1000) / max(ns, u64(1)));
+    };
+    streamed.template operator()<Crc32>("Crc32");
+    streamed.template operator()<WyHash>("WyHash");
+    streamed.template operator()<Xxh3>("Xxh3");
+}
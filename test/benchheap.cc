@@ -0,0 +1,48 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+extern "C" int pthread_create(unsigned long* thread, void const* attr, void* (*start)(void*), void* arg);
+extern "C" int pthread_join(unsigned long thread, void** result);
+
+///
+/// Each thread allocates and frees small blocks of mixed sizes, like DLList nodes and short ByteVector buffers.
+/// With per-thread caches the time per operation should stay flat as threads are added.
+/// LinuxHeap is called directly, since operator new leaves the heap to malloc when built with the address sanitizer.
+///
+inline void benchHeap()
+{
+    stdout.println("\nBENCHMARK LinuxHeap scaling (small mixed sizes)");
+    constexpr u64 OPS_PER_THREAD = 2'000'000;
+    constexpr u32 MAX_THREADS = 16;
+
+    auto worker = [](void*) -> void* {
+        void* live[64] = {};
+        UNSAFE_BEGIN;
+        for (u64 i = 0; i < OPS_PER_THREAD; i++) {
+            auto slot = (i * 7) % 64;
+            LinuxHeap::deallocate(live[slot]);
+            live[slot] = LinuxHeap::allocate(16 + (i % 24) * 8);
+        }
+        for (auto* p : live) {
+            LinuxHeap::deallocate(p);
+        }
+        UNSAFE_END;
+        return nullptr;
+    };
+
+    for (u32 threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        unsigned long ids[MAX_THREADS] = {};
+        auto start = bench::nowNanoseconds();
+        UNSAFE_BEGIN;
+        for (u32 t = 0; t < threads; t++) {
+            pthread_create(&ids[t], nullptr, worker, nullptr);
+        }
+        for (u32 t = 0; t < threads; t++) {
+            pthread_join(ids[t], nullptr);
+        }
+        UNSAFE_END;
+        auto elapsed = bench::nowNanoseconds() - start;
+        stdout.println("  ` threads : ` ns/op (wall clock per op per thread)", threads, elapsed / OPS_PER_THREAD);
+    }
+}
@@ -0,0 +1,40 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Streams over a 1 GB array mapped with 4 KB pages, then with 2 MB huge pages.
+/// The strided pass touches a new 4 KB page on every access, which is where the TLB misses show up.
+///
+inline void benchHugePages()
+{
+    stdout.println("\nBENCHMARK 1 GB array, 4 KB pages vs. huge pages");
+    constexpr usize LENGTH = 1024_MB / sizeof(u64);
+    constexpr usize STRIDE = (4_KB + 64) / sizeof(u64);
+
+    auto run = [&](StringRef name, Allocator const& alloc) {
+        Array<u64> array(LENGTH, alloc);
+        auto* data = array.data();
+        u64 sum = 0;
+
+        auto sequential = bench::measure(1, [&](u64) {
+            UNSAFE_BEGIN;
+            for (usize i = 0; i < LENGTH; i++) {
+                sum += data[i] + i;
+            }
+            UNSAFE_END;
+        });
+        auto strided = bench::measure(1, [&](u64) {
+            UNSAFE_BEGIN;
+            for (usize i = 0, j = 0; i < LENGTH; i++, j = (j + STRIDE) % LENGTH) {
+                sum += data[j];
+            }
+            UNSAFE_END;
+        });
+        bench::doNotOptimize(sum);
+        stdout.println("  ` : sequential ` ms, strided ` ms", name, sequential / 1'000'000, strided / 1'000'000);
+    };
+
+    run("4 KB pages", PageAllocator);
+    run("huge pages", HugePageAllocator);
+}
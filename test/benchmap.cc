@@ -0,0 +1,216 @@
+#include "benchmark.hh"
+
+#define __inline_core_header__
+#include <commons/datastructs/sparse_array.hh>
+#undef __inline_core_header__
+
+using namespace cm;
+
+namespace bench {
+
+///
+/// The Map before it was rewritten: the hash of the key, shifted up by 32 bits, indexes a SparseArray, and keys with
+/// the same hash take the indices after it. Every probe walks the 8 levels of the SparseArray and copies the entry out.
+///
+template<typename K, typename V>
+struct SparseArrayMap
+{
+    void put(K const& key, V const& value)
+    {
+        u64 index = u64(u32(Hash<Crc32>::hash(key))) << 32;
+        for (u32 j = 0; j < MAX_VALUE<u32>; j++) {
+            if (!_array.get(index + j).hasValue()) {
+                _array.set(index + j, Pair<K, V>(key, value));
+                break;
+            }
+        }
+    }
+
+    Optional<V> get(K const& key) const
+    {
+        u64 index = u64(u32(Hash<Crc32>::hash(key))) << 32;
+        for (u32 j = 0; j < MAX_VALUE<u32>; j++) {
+            Optional<Pair<K, V>> entry = _array.get(index + j);
+            if (!entry.hasValue()) {
+                return None;
+            } else if (key == entry.ref().first) {
+                return entry.ref().second;
+            }
+        }
+        return None;
+    }
+
+    SparseArray<Pair<K, V>> _array;
+};
+
+///
+/// A chained hash table laid out like std::unordered_map, which cannot be included next to this library: an array of
+/// buckets, each the head of a singly linked list of entries that are allocated one at a time, and enough buckets to
+/// keep the load factor at most 1. It hashes with the same hasher as Map.
+///
+UNSAFE_BEGIN;
+template<typename K, typename V>
+struct ChainedMap
+{
+    struct Node
+    {
+        Node* next;
+        K key;
+        V value;
+    };
+
+    ChainedMap() { _buckets = new Node*[_bucketCount]{}; }
+
+    ~ChainedMap()
+    {
+        for (usize b = 0; b < _bucketCount; b++) {
+            for (Node* node = _buckets[b]; node != nullptr;) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+        delete[] _buckets;
+    }
+
+    ChainedMap(ChainedMap const&) = delete;
+    ChainedMap& operator=(ChainedMap const&) = delete;
+
+    void put(K const& key, V const& value)
+    {
+        if (V* existing = get(key); existing != nullptr) {
+            *existing = value;
+            return;
+        }
+        if (_length == _bucketCount) {
+            _rehash(_bucketCount * 2);
+        }
+        Node*& head = _buckets[_bucketOf(key)];
+        head = new Node{head, key, value};
+        _length++;
+    }
+
+    V* get(K const& key) const
+    {
+        for (Node* node = _buckets[_bucketOf(key)]; node != nullptr; node = node->next) {
+            if (node->key == key) {
+                return &node->value;
+            }
+        }
+        return nullptr;
+    }
+
+    bool remove(K const& key)
+    {
+        for (Node** link = &_buckets[_bucketOf(key)]; *link != nullptr; link = &(*link)->next) {
+            if ((*link)->key == key) {
+                Node* node = *link;
+                *link = node->next;
+                delete node;
+                _length--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    usize _bucketOf(K const& key) const { return usize(Hash<WyHash>::hash(key)) & (_bucketCount - 1); }
+
+    void _rehash(usize bucketCount)
+    {
+        Node** old = _buckets;
+        usize oldCount = _bucketCount;
+        _bucketCount = bucketCount;
+        _buckets = new Node*[bucketCount]{};
+        for (usize b = 0; b < oldCount; b++) {
+            for (Node* node = old[b]; node != nullptr;) {
+                Node* next = node->next;
+                Node*& head = _buckets[_bucketOf(node->key)];
+                node->next = head;
+                head = node;
+                node = next;
+            }
+        }
+        delete[] old;
+    }
+
+    Node** _buckets;
+    usize _bucketCount = 16;
+    usize _length = 0;
+};
+UNSAFE_END;
+
+}  // namespace bench
+
+///
+/// Hash maps with u64 keys: Map vs. a chained table laid out like std::unordered_map, and the SparseArray-based Map it
+/// replaced (only for the smaller size, since each of its keys takes a few KB of tables). Each map is filled from
+/// empty, then every key is looked up, then keys that are not in it are looked up, then every key is removed (the old
+/// Map could not remove keys).
+///
+inline void benchMap()
+{
+    stdout.println("\nBENCHMARK Hash maps (u64 keys, ns per operation)");
+    auto key = [](u64 i) { return (i + 1) * 0x9E3779B97F4A7C15ull; };
+    for (u64 n : {10'000ull, 1'000'000ull}) {
+        u64 total = 0;
+        Map<u64, u64> map;
+        bench::ChainedMap<u64, u64> chained;
+        auto mapInsert = bench::measure(n, [&](u64 i) { map.put(key(i), i); });
+        auto chainedInsert = bench::measure(n, [&](u64 i) { chained.put(key(i), i); });
+        auto mapHit = bench::measure(n, [&](u64 i) { total += *map.get(key(i)).val(); });
+        auto chainedHit = bench::measure(n, [&](u64 i) { total += *chained.get(key(i)); });
+        auto mapMiss = bench::measure(n, [&](u64 i) { total += map.contains(key(i + n)); });
+        auto chainedMiss = bench::measure(n, [&](u64 i) { total += chained.get(key(i + n)) != nullptr; });
+        auto mapErase = bench::measure(n, [&](u64 i) { total += map.remove(key(i)); });
+        auto chainedErase = bench::measure(n, [&](u64 i) { total += chained.remove(key(i)); });
+        bench::doNotOptimize(total);
+        stdout.println("  ` keys: Map insert `, hit `, miss `, erase `", n, mapInsert, mapHit, mapMiss, mapErase);
+        stdout.println("  ` keys: chained insert `, hit `, miss `, erase `", n, chainedInsert, chainedHit, chainedMiss,
+            chainedErase);
+
+        if (n <= 10'000) {
+            bench::SparseArrayMap<u64, u64> sparse;
+            auto sparseInsert = bench::measure(n, [&](u64 i) { sparse.put(key(i), i); });
+            auto sparseHit = bench::measure(n, [&](u64 i) { total += sparse.get(key(i)).val(); });
+            auto sparseMiss = bench::measure(n, [&](u64 i) { total += sparse.get(key(i + n)).hasValue(); });
+            bench::doNotOptimize(total);
+            stdout.println("  ` keys: SparseArray Map insert `, hit `, miss `", n, sparseInsert, sparseHit,
+                sparseMiss);
+        }
+    }
+}
+
+///
+/// Looking up strings in a FixedMap of 32 C++ keywords: built in a constant expression, where it finds a perfect hash
+/// for the keys, vs. built at runtime, where it uses open addressing with every slot full. The misses are keywords
+/// that are not in the map.
+///
+inline void benchFixedMap()
+{
+    stdout.println("\nBENCHMARK FixedMap (32 string keys, ns per lookup)");
+    static constexpr Tuple<StringRef, int> KEYWORDS[] = {{"alignas", 0}, {"alignof", 1}, {"asm", 2}, {"auto", 3},
+        {"bool", 4}, {"break", 5}, {"case", 6}, {"catch", 7}, {"char", 8}, {"class", 9}, {"const", 10},
+        {"constexpr", 11}, {"continue", 12}, {"decltype", 13}, {"default", 14}, {"delete", 15}, {"do", 16},
+        {"double", 17}, {"else", 18}, {"enum", 19}, {"explicit", 20}, {"export", 21}, {"extern", 22}, {"float", 23},
+        {"for", 24}, {"friend", 25}, {"goto", 26}, {"if", 27}, {"inline", 28}, {"int", 29}, {"long", 30},
+        {"mutable", 31}};
+    static constexpr StringRef MISSES[] = {"namespace", "new", "noexcept", "operator", "private", "protected",
+        "public", "return", "short", "signed", "sizeof", "static", "struct", "switch", "template", "this"};
+    constexpr usize n = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+    constexpr usize misses = sizeof(MISSES) / sizeof(MISSES[0]);
+
+    static constexpr FixedMap<StringRef, int, n> perfect(ArrayRef<Tuple<StringRef, int>>(KEYWORDS, n));
+    FixedMap<StringRef, int, n> probing(ArrayRef<Tuple<StringRef, int>>(KEYWORDS, n));
+
+    u64 total = 0;
+    auto run = [&](StringRef name, auto const& map) {
+        auto hit = bench::measure(1'000'000, [&](u64 i) { total += map[UNSAFE(KEYWORDS[i % n]).get<0>()].val(); });
+        auto miss = bench::measure(1'000'000, [&](u64 i) { total += map[UNSAFE(MISSES[i % misses])].hasValue(); });
+        bench::doNotOptimize(total);
+        stdout.println("  `: hit `, miss `", name, hit, miss);
+    };
+    run("built in a constant expression (perfect hash)", perfect);
+    run("built at runtime (open addressing)", probing);
+}
@@ -0,0 +1,53 @@
+#include <commons/godbolt.hh>
+
+///
+/// A minimal harness for the micro-benchmarks in test/bench*.cc
+///
+namespace bench {
+
+using namespace cm;
+
+///
+/// Returns a monotonic timestamp in nanoseconds.
+///
+inline u64 nowNanoseconds()
+{
+    struct
+    {
+        i64 seconds;
+        i64 nanoseconds;
+    } ts{};
+    LinuxSyscall(LinuxSyscall.clock_gettime, 1 /* CLOCK_MONOTONIC */, u64(&ts));
+    return u64(ts.seconds) * 1'000'000'000ull + u64(ts.nanoseconds);
+}
+
+///
+/// Keeps the compiler from optimizing away a value that a benchmark computes but never uses.
+///
+template<typename T>
+FORCEINLINE void doNotOptimize(T const& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+///
+/// Runs func(iteration) the given number of times and returns the average time per iteration in nanoseconds.
+///
+inline u64 measure(u64 iterations, auto const& func)
+{
+    auto start = nowNanoseconds();
+    for (u64 i = 0; i < iterations; i++) {
+        func(i);
+    }
+    return (nowNanoseconds() - start) / max(iterations, u64(1));
+}
+
+///
+/// Prints one line of results.
+///
+inline void report(StringRef name, u64 nanosecondsPerIteration)
+{
+    stdout.println("  ` : ` ns/iter", name, nanosecondsPerIteration);
+}
+
+}  // namespace bench
@@ -0,0 +1,53 @@
+#include "benchmark.hh"
+
+// The C library's own versions, reached through the fortified entry points, since memcpy, memmove and memset
+// themselves resolve to the ones in core/cstring.hh
+extern "C" void* __memcpy_chk(void* dst, void const* src, usize n, usize dstLength);
+extern "C" void* __memmove_chk(void* dst, void const* src, usize n, usize dstLength);
+extern "C" void* __memset_chk(void* dst, int c, usize n, usize dstLength);
+
+using namespace cm;
+
+///
+/// memcpy, memmove (with overlapping buffers) and memset from core/cstring.hh vs. glibc's, from a few bytes to sizes
+/// that take the non-temporal path. The destination is misaligned by one byte to keep the comparison honest.
+///
+inline void benchMemory()
+{
+    stdout.println("\nBENCHMARK memcpy / memmove / memset (this library vs. glibc)");
+    constexpr usize LARGEST = 8_MB;
+    static u8 source[LARGEST + 64];
+    static u8 target[LARGEST + 64];
+    memset(source, 0x5A, sizeof(source));
+    memset(target, 0, sizeof(target));
+
+    constexpr usize SIZES[] = {7, 24, 100, 1000, 64 * 1024, LARGEST};
+    for (usize n : SIZES) {
+        // About 1 GB moved per measurement, but at least a few iterations
+        u64 iterations = max(u64(1'000'000'000 / (n + 64)), u64(8));
+        iterations = min(iterations, u64(10'000'000));
+        u8* dst = UNSAFE(target + 1);
+
+        auto copy = bench::measure(iterations, [&](u64) { memcpy(dst, source, n); bench::doNotOptimize(dst); });
+        auto libcCopy = bench::measure(iterations, [&](u64) {
+            __memcpy_chk(dst, source, n, n);
+            bench::doNotOptimize(dst);
+        });
+        // Shifting a buffer by a few bytes, like inserting into a ByteVector does
+        auto move = bench::measure(iterations, [&](u64) {
+            memmove(UNSAFE(dst + 3), dst, n);
+            bench::doNotOptimize(dst);
+        });
+        auto libcMove = bench::measure(iterations, [&](u64) {
+            __memmove_chk(UNSAFE(dst + 3), dst, n, n);
+            bench::doNotOptimize(dst);
+        });
+        auto fill = bench::measure(iterations, [&](u64 i) { memset(dst, int(i), n); bench::doNotOptimize(dst); });
+        auto libcFill = bench::measure(iterations, [&](u64 i) {
+            __memset_chk(dst, int(i), n, n);
+            bench::doNotOptimize(dst);
+        });
+        stdout.println("  ` bytes: memcpy ` / ` ns, memmove ` / ` ns, memset ` / ` ns (this / glibc)", n, copy,
+            libcCopy, move, libcMove, fill, libcFill);
+    }
+}
@@ -0,0 +1,59 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Text to integer: one multiply-add per character (the way String::toInteger used to work) vs. parse<T>, which
+/// converts runs of 8 digits with SWAR arithmetic and checks for overflow once per run.
+///
+inline void benchParse()
+{
+    stdout.println("\nBENCHMARK Text to integer");
+    constexpr u64 ITERATIONS = 1'000'000;
+    constexpr usize VALUES = 256;
+
+    auto charByChar = [](StringRef s) {
+        i64 result = 0;
+        bool negative = false;
+        usize i = 0;
+        if (s.length() != 0 && UNSAFE(s.data()[0]) == '-') {
+            negative = true;
+            i++;
+        }
+        for (; i < s.length(); i++) {
+            auto digit = i64(UNSAFE(s.data()[i]) - '0');
+            if (__builtin_mul_overflow(result, 10, &result) || __builtin_add_overflow(result, digit, &result)) {
+                return negative ? MIN_VALUE<i64> : MAX_VALUE<i64>;
+            }
+        }
+        return negative ? -result : result;
+    };
+
+    auto run = [&](StringRef name, u64 modulus) {
+        // The numbers are written back to back, as they would be in a log line
+        char text[VALUES * TO_CHARS_MAX_LENGTH<i64>];
+        usize offsets[VALUES + 1] = {};
+        for (usize i = 0; i < VALUES; i++) {
+            auto value = i64(((i + 1) * 0x9E3779B97F4A7C15ull) % modulus) * ((i & 1) ? -1 : 1);
+            UNSAFE_BEGIN;
+            auto n = toChars(value, ArrayRef<char>(text + offsets[i], TO_CHARS_MAX_LENGTH<i64>)).val();
+            offsets[i + 1] = offsets[i] + n;
+            UNSAFE_END;
+        }
+        auto number = [&](u64 i) {
+            UNSAFE_BEGIN;
+            usize k = i % VALUES;
+            return StringRef(text + offsets[k], offsets[k + 1] - offsets[k]);
+            UNSAFE_END;
+        };
+        i64 total = 0;
+        auto naive = bench::measure(ITERATIONS, [&](u64 i) { total += charByChar(number(i)); });
+        auto fast = bench::measure(ITERATIONS, [&](u64 i) { total += parse<i64>(number(i)).unwrap(); });
+        bench::doNotOptimize(total);
+        stdout.println("  ` : char by char ` ns, parse ` ns", name, naive, fast);
+    };
+
+    run("up to 4 digits", 10'000);
+    run("up to 10 digits", 10'000'000'000ull);
+    run("up to 19 digits", u64(MAX_VALUE<i64>));
+}
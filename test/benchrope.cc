@@ -0,0 +1,36 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Types into the middle of a 1 MB document: String moves the whole tail on every keystroke, Rope does not.
+///
+inline void benchRope()
+{
+    stdout.println("\nBENCHMARK Editing a 1 MB document, String vs. Rope");
+    constexpr usize DOCUMENT_LENGTH = 1_MB;
+    constexpr u64 EDITS = 20'000;
+
+    String document;
+    document.reserve(DOCUMENT_LENGTH);
+    for (usize i = 0; i < DOCUMENT_LENGTH / 16; i++) {
+        document.append("lorem ipsum dol\n");
+    }
+
+    auto position = [&](u64 i) { return usize((i * 0x9E3779B97F4A7C15ull) >> 44) % (DOCUMENT_LENGTH / 2); };
+
+    String string = document;
+    bench::report("String insert+erase", bench::measure(EDITS, [&](u64 i) {
+                      string.insert(position(i), "x");
+                      string.erase(position(i) + 7, 1);
+                  }));
+
+    Rope rope(document);
+    bench::report("Rope insert+erase", bench::measure(EDITS, [&](u64 i) {
+                      rope.insert(position(i), "x");
+                      rope.erase(position(i) + 7, 1);
+                  }));
+
+    bench::report("Rope toString", bench::measure(100, [&](u64) { bench::doNotOptimize(rope.toString().length()); }));
+    bench::doNotOptimize(string.length() + rope.length());
+}
@@ -0,0 +1,53 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Substring search in a buffer of log lines: comparing the needle at every position (what String::replace used to
+/// do) vs. StringRef::find, with a short needle and one long enough for Two-Way, and StringRef::count for a needle
+/// that occurs on many lines. None of the searched needles occur until the last line, so each search scans it all.
+///
+inline void benchSearch()
+{
+    stdout.println("\nBENCHMARK Substring search (log lines)");
+    constexpr usize LENGTH = 4_MB;
+    constexpr u64 ITERATIONS = 20;
+    static char text[LENGTH + 1];
+
+    StringRef const LEVELS[] = {"INFO", "DEBUG", "WARN"};
+    StringRef const COMPONENTS[] = {"http.server", "db.pool", "scheduler", "cache"};
+    usize length = 0;
+    for (usize i = 0; length + 128 < LENGTH; i++) {
+        u64 bits = (i + 1) * 0x9E3779B97F4A7C15ull;
+        auto line = String::fmt("2025-06-` 12:`:` [`] `: request ` handled in ` ms\n", (bits >> 8) % 28 + 1,
+            (bits >> 16) % 60, (bits >> 24) % 60, UNSAFE(LEVELS[bits % 3]), UNSAFE(COMPONENTS[(bits >> 4) % 4]),
+            bits >> 40, (bits >> 32) % 1000);
+        UNSAFE(memcpy(text + length, line.data(), line.length()));
+        length += line.length();
+    }
+    StringRef last = "[ERROR] scheduler: worker pool exhausted, dropping request\n";
+    UNSAFE(memcpy(text + length - last.length(), last.data(), last.length()));
+    StringRef haystack(UNSAFE(&text[0]), length);
+
+    auto naiveFind = [&](StringRef needle) {
+        for (usize i = 0; i + needle.length() <= haystack.length(); i++) {
+            if (UNSAFE(__builtin_memcmp(haystack.data() + i, needle.data(), needle.length())) == 0) {
+                return i;
+            }
+        }
+        return usize(0);
+    };
+
+    usize total = 0;
+    for (StringRef needle : {StringRef("ERROR"), StringRef("worker pool exhausted, dropping request")}) {
+        auto naive = bench::measure(ITERATIONS, [&](u64) { total += naiveFind(needle); });
+        auto fast = bench::measure(ITERATIONS, [&](u64) { total += haystack.find(needle).val(); });
+        bench::doNotOptimize(total);
+        // Bytes per nanosecond is GB/s; the throughput is reported in MB/s
+        stdout.println("  find \"`\": loop ` MB/s, StringRef::find ` MB/s", needle,
+            (length * 1000) / max(naive, u64(1)), (length * 1000) / max(fast, u64(1)));
+    }
+    auto counting = bench::measure(ITERATIONS, [&](u64) { total += haystack.count("scheduler"); });
+    bench::doNotOptimize(total);
+    stdout.println("  count \"scheduler\": ` MB/s", (length * 1000) / max(counting, u64(1)));
+}
@@ -0,0 +1,53 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Turning C strings into StringRefs: a character-at-a-time length loop (what strlen used to be) vs. strlen, which
+/// checks a vector register's worth of characters per step, and the same for strcmp on equal strings.
+///
+inline void benchStrings()
+{
+    stdout.println("\nBENCHMARK C strings");
+    constexpr u64 ITERATIONS = 2'000'000;
+    constexpr usize STRINGS = 64;
+    static char text[STRINGS][512];
+    static char copy[STRINGS][512];
+
+    auto lengthLoop = [](char const* s) {
+        usize n = 0;
+        while (UNSAFE(s[n]) != '\0') {
+            n++;
+        }
+        return n;
+    };
+    auto compareLoop = [](char const* s1, char const* s2) {
+        UNSAFE_BEGIN;
+        for (; *s1 != '\0' && *s1 == *s2; s1++, s2++) {
+        }
+        return u8(*s1) - u8(*s2);
+        UNSAFE_END;
+    };
+
+    for (usize maxLength : {16uz, 64uz, 500uz}) {
+        for (usize i = 0; i < STRINGS; i++) {
+            // Lengths spread over [maxLength / 2, maxLength)
+            usize length = (maxLength / 2) + (((i + 1) * 0x9E3779B97F4A7C15ull) % (maxLength / 2));
+            UNSAFE_BEGIN;
+            memset(text[i], 'a' + char(i % 26), length);
+            text[i][length] = '\0';
+            memcpy(copy[i], text[i], length + 1);
+            UNSAFE_END;
+        }
+        auto string = [&](u64 i) { return UNSAFE(&text[i % STRINGS][0]); };
+        auto same = [&](u64 i) { return UNSAFE(&copy[i % STRINGS][0]); };
+        usize total = 0;
+        auto naive = bench::measure(ITERATIONS, [&](u64 i) { total += lengthLoop(string(i)); });
+        auto fast = bench::measure(ITERATIONS, [&](u64 i) { total += StringRef(string(i)).length(); });
+        auto naiveCompare = bench::measure(ITERATIONS, [&](u64 i) { total += usize(compareLoop(string(i), same(i))); });
+        auto fastCompare = bench::measure(ITERATIONS, [&](u64 i) { total += usize(strcmp(string(i), same(i))); });
+        bench::doNotOptimize(total);
+        stdout.println("  length < ` : loop ` ns, StringRef(char const*) ` ns; strcmp loop ` ns, strcmp ` ns",
+            maxLength, naive, fast, naiveCompare, fastCompare);
+    }
+}
@@ -0,0 +1,47 @@
+#include "benchmark.hh"
+
+using namespace cm;
+
+///
+/// Integer to text: one division per digit (the way outputStringForPrimitiveType used to work) vs. toChars, which
+/// counts the digits up front and converts two digits per division.
+///
+inline void benchToChars()
+{
+    stdout.println("\nBENCHMARK Integer to text");
+    constexpr u64 ITERATIONS = 1'000'000;
+
+    auto digitByDigit = [](auto value, char* buffer) {
+        auto [magnitude, negative] = impl::splitSign(value);
+        char tmp[TO_CHARS_MAX_LENGTH<decltype(value)>];
+        usize n = 0;
+        do {
+            UNSAFE(tmp[n++] = char('0' + (magnitude % 10)));
+            magnitude /= 10;
+        } while (magnitude != 0);
+        usize length = 0;
+        if (negative) {
+            UNSAFE(buffer[length++] = '-');
+        }
+        while (n != 0) {
+            UNSAFE(buffer[length++] = tmp[--n]);
+        }
+        return length;
+    };
+
+    auto run = [&]<typename T>(StringRef name, T magnitude) {
+        char buffer[TO_CHARS_MAX_LENGTH<T>];
+        usize total = 0;
+        auto naive = bench::measure(ITERATIONS, [&](u64 i) { total += digitByDigit(T(magnitude - T(i & 7)), buffer); });
+        auto fast = bench::measure(ITERATIONS, [&](u64 i) { total += toChars(T(magnitude - T(i & 7)), buffer).val(); });
+        bench::doNotOptimize(total);
+        stdout.println("  ` : digit by digit ` ns, toChars ` ns", name, naive, fast);
+    };
+
+    run.operator()<u32>("u32 small (2 digits)", u32(42));
+    run.operator()<u32>("u32 large (10 digits)", u32(4'000'000'000));
+    run.operator()<u64>("u64 medium (10 digits)", u64(4'000'000'000));
+    run.operator()<u64>("u64 large (20 digits)", u64(18'000'000'000'000'000'000ull));
+    run.operator()<i64>("i64 small negative", i64(-1000));
+    run.operator()<i64>("i64 large negative", i64(-9'000'000'000'000'000'000));
+}
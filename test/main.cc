@@ -3,6 +3,28 @@
 #include <commons/startup.hh>
 // #define TEST_THAT_WARNINGS_ARE_SHOWN 0
 #include "testoptional.cc"
+#include "testallocations.cc"
+#include "testheap.cc"
+#include "teststring.cc"
+#include "testrope.cc"
+#include "testformat.cc"
+#include "testtochars.cc"
+#include "testfloattochars.cc"
+#include "testparseint.cc"
+#include "testparsefloat.cc"
+#include "testmemory.cc"
+#include "testcstring.cc"
+#include "teststringsearch.cc"
+#include "testmultimatcher.cc"
+#include "testcrc32.cc"
+#include "testhashers.cc"
+#include "teststreaminghash.cc"
+#include "testmap.cc"
+#include "testfixedmap.cc"
+#include "testheapstats.cc"
+#include "testlinkedlist.cc"
+#include "testbytevector.cc"
+#include "testarena.cc"
 
 
 using namespace cm;
@@ -10,7 +32,7 @@ using namespace cm;
 
 int main()
 {
-    auto s = FixedMap("hello", "!", "bob", "ugh", "apple", ":C", "apple", ":^\\");
+    constexpr auto s = FixedMap("hello", "!", "bob", "ugh", "apple", ":C", "apple", ":^\\");
 
     stdout.println(s["hello"]);
     stdout.println(s["bob"]);
@@ -19,6 +41,35 @@ int main()
     Union<double, int> h = 1;
 
     h.match([](int) { stdout.println("this is an int"); }, [](double) { stdout.println("this is a double"); });
+
+    testAllocations();
+    testHeap();
+    testHeapSizeClasses();
+    testHeapLarge();
+    testHugePages();
+    testHeapThreadCache();
+    testStringShare();
+    testStringMove();
+    testRope();
+    testFormat();
+    testToChars();
+    testFloatToChars();
+    testParseInt();
+    testParseFloat();
+    testMemory();
+    testCString();
+    testStringSearch();
+    testMultiMatcher();
+    testCrc32();
+    testHashers();
+    testStreamingHash();
+    testMap();
+    testMapStringKeys();
+    testFixedMap();
+    testHeapStats();
+    testLinkedList();
+    testSmallByteVector();
+    testArena();
 }
 
 
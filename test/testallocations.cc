@@ -0,0 +1,87 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test that common operations on small strings do not allocate.
+/// Needs the heap statistics, so the test target is built with CM_HEAP_STATS.
+///
+inline void testAllocations()
+{
+    stdout.println("\nTESTING allocations");
+    if constexpr (!HeapStats::ENABLED) {
+        stdout.println("\tSkipped, needs CM_HEAP_STATS");
+        return;
+    }
+    usize t = 0;
+    auto countAllocations = [](auto const& func) {
+        auto before = HeapStats::allocationCount();
+        func();
+        return HeapStats::allocationCount() - before;
+    };
+    {
+        auto n = countAllocations([] { String s = String::fmt("`", 12345); });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+    }
+    {
+        auto n = countAllocations([] { String s = String::fmt("id=` n=`", 7, -123); });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+    }
+    {
+        // Too long to be inline: the size hints of the arguments make fmt allocate the result once, at its final size
+        auto n = countAllocations([] {
+            String s = String::fmt("` is ` characters long and ends in `", StringRef("this argument"), 13, 't');
+        });
+        stdout.println("\t(`) Expect \"1\" : `", t++, n);
+    }
+    {
+        auto n = countAllocations([] { stdout.println("\t    `", 1234567890); });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+    }
+    {
+        auto n = countAllocations([] {
+            String s = "abc";
+            s.append("defghijklmnopqrstuv");  // 22 characters: still inline
+        });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+    }
+    {
+        auto n = countAllocations([] {
+            String s = "abc";
+            s.append("defghijklmnopqrstuvwxyz");  // 26 characters: on the heap
+        });
+        stdout.println("\t(`) Expect \"1\" : `", t++, n);
+    }
+    {
+        // 22 characters from a buffer on the stack (not in .rodata), so they are copied in: still inline
+        char chars[String::INLINE_LENGTH + 1];
+        for (usize i = 0; i < String::INLINE_LENGTH; i++) {
+            UNSAFE(chars[i] = char('a' + i));
+        }
+        UNSAFE(chars[String::INLINE_LENGTH] = '\0');
+        auto n = countAllocations([&] { String s(&chars[0], String::INLINE_LENGTH); });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+        String s(&chars[0], String::INLINE_LENGTH);
+        n = countAllocations([&] { String copy = s; });
+        stdout.println("\t(`) Expect \"0\" : `", t++, n);
+        String copy = s;
+        stdout.println("\t(`) Expect \"abcdefghijklmnopqrstuv 22\" : ` `", t++, copy, copy.length());
+    }
+    {
+        String s = "the cat sat on the mat, the end";
+        auto n = countAllocations([&] { s.replace("the", "a"); });
+        stdout.println("\t(`) Expect \"1\" : `", t++, n);
+        stdout.println("\t(`) Expect \"a cat sat on a mat, a end\" : `", t++, s);
+    }
+    {
+        auto n = countAllocations([] {
+            StringBuilder sb;
+            sb.reserve(100);
+            for (u32 i = 0; i < 10; i++) {
+                sb.append("item ").appendInteger(i).append(',');
+            }
+            String s = sb.take();
+        });
+        stdout.println("\t(`) Expect \"1\" : `", t++, n);
+    }
+}
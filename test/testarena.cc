@@ -0,0 +1,120 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// An upstream allocator that counts the chunks an Arena takes from the heap and the bytes it has not given back.
+///
+struct CountingUpstream
+{
+    usize allocations = 0;
+    usize deallocations = 0;
+    usize outstandingBytes = 0;
+
+    Allocator allocator() { return Allocator(this, _allocate, _deallocate); }
+
+private:
+    static void* _allocate(void* self, usize sizeBytes, usize alignment)
+    {
+        auto* upstream = static_cast<CountingUpstream*>(self);
+        upstream->allocations++;
+        upstream->outstandingBytes += sizeBytes;
+        return Allocator().allocate(sizeBytes, alignment);
+    }
+
+    static void _deallocate(void* self, void* ptr, usize sizeBytes, usize alignment)
+    {
+        auto* upstream = static_cast<CountingUpstream*>(self);
+        upstream->deallocations++;
+        upstream->outstandingBytes -= sizeBytes;
+        Allocator().deallocate(ptr, sizeBytes, alignment);
+    }
+};
+
+///
+/// Test Arena: reset() hands the same chunks out again without going upstream, requests larger than a chunk get a
+/// chunk of their own, blocks of mixed sizes and alignments are aligned and do not overlap, and release() (or the
+/// destructor) gives every chunk back.
+///
+inline void testArena()
+{
+    stdout.println("\nTESTING Arena");
+    usize t = 0;
+    constexpr usize CHUNK_SIZE = 4096;
+    constexpr usize BLOCKS = 200;
+    CountingUpstream upstream;
+
+    {
+        Arena arena(CHUNK_SIZE, upstream.allocator());
+        stdout.println("\t(`) Expect \"0 0\" : ` `", t++, arena.reservedBytes(), upstream.allocations);
+
+        // 200 blocks of 64 bytes fill 4 chunks, which are handed out again, in the same order, after a reset
+        void* blocks[BLOCKS];
+        for (usize i = 0; i < BLOCKS; i++) {
+            UNSAFE(blocks[i] = arena.allocate(64));
+        }
+        auto chunks = upstream.allocations;
+        auto reserved = arena.reservedBytes();
+        usize moved = 0;
+        for (u32 round = 0; round < 3; round++) {
+            arena.reset();
+            for (usize i = 0; i < BLOCKS; i++) {
+                moved += arena.allocate(64) != UNSAFE(blocks[i]);
+            }
+        }
+        stdout.println("\t(`) Expect \"4 true 4 0\" : ` ` ` `", t++, chunks, reserved == CHUNK_SIZE * chunks,
+            upstream.allocations, moved);
+
+        // Deallocating the latest block gives its memory back; any other block waits for the reset
+        arena.reset();
+        auto* first = arena.allocate(64);
+        static_cast<void>(arena.allocate(64));
+        arena.deallocate(first, 64);
+        auto* third = arena.allocate(64);
+        arena.deallocate(third, 64);
+        stdout.println("\t(`) Expect \"false true\" : ` `", t++, third == first, arena.allocate(64) == third);
+
+        // A request larger than a chunk gets a chunk of its own, even with a large alignment
+        auto* large = static_cast<u8*>(arena.allocate(3 * CHUNK_SIZE, 4096));
+        memset(large, 0xAB, 3 * CHUNK_SIZE);
+        auto* afterLarge = arena.allocate(64);
+        stdout.println("\t(`) Expect \"0 5 true true\" : ` ` ` `", t++, reinterpret_cast<usize>(large) % 4096,
+            upstream.allocations, arena.reservedBytes() >= reserved + (3 * CHUNK_SIZE) + 4096, afterLarge != nullptr);
+        // It is kept by a reset like the other chunks
+        arena.reset();
+        auto* largeAgain = arena.allocate(3 * CHUNK_SIZE, 4096);
+        stdout.println("\t(`) Expect \"true 5\" : ` `", t++, largeAgain == large, upstream.allocations);
+
+        // Blocks of mixed sizes and alignments are aligned, and writing to one does not overwrite another
+        arena.reset();
+        constexpr usize sizes[] = {1, 3, 8, 13, 24, 100, 7};
+        constexpr usize alignments[] = {1, 2, 4, 8, 16, 32, 64, 256};
+        usize blockSizes[BLOCKS];
+        usize misaligned = 0;
+        for (usize i = 0; i < BLOCKS; i++) {
+            auto size = UNSAFE(sizes[i % 7]);
+            auto alignment = UNSAFE(alignments[i % 8]);
+            UNSAFE(blocks[i] = arena.allocate(size, alignment));
+            UNSAFE(blockSizes[i] = size);
+            misaligned += reinterpret_cast<usize>(UNSAFE(blocks[i])) % alignment != 0;
+            memset(UNSAFE(blocks[i]), int(i), size);
+        }
+        usize overwritten = 0;
+        for (usize i = 0; i < BLOCKS; i++) {
+            auto* bytes = static_cast<u8*>(UNSAFE(blocks[i]));
+            for (usize j = 0; j < UNSAFE(blockSizes[i]); j++) {
+                overwritten += UNSAFE(bytes[j]) != u8(i);
+            }
+        }
+        stdout.println("\t(`) Expect \"0 0\" : ` `", t++, misaligned, overwritten);
+
+        // Everything goes back upstream, and the arena can be used again afterwards
+        arena.release();
+        stdout.println("\t(`) Expect \"0 0 5\" : ` ` `", t++, arena.reservedBytes(), upstream.outstandingBytes,
+            upstream.deallocations);
+        static_cast<void>(arena.allocate(64));
+        stdout.println("\t(`) Expect \"true 6\" : ` `", t++, arena.reservedBytes() == CHUNK_SIZE, upstream.allocations);
+    }
+    // The destructor releases the chunks too
+    stdout.println("\t(`) Expect \"0 6\" : ` `", t++, upstream.outstandingBytes, upstream.deallocations);
+}
@@ -0,0 +1,131 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// The alphabet, twice. Being a string literal, it is in .rodata.
+///
+constexpr char const* BYTE_VECTOR_LETTERS = "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz";
+
+///
+/// Appends count letters of the alphabet to a vector, one byte at a time, carrying on from its last letter.
+///
+template<usize N>
+inline void appendLetters(SmallByteVector<N>& v, usize count)
+{
+    for (usize i = 0; i < count; i++) {
+        auto letter = u8('a' + (v.length() % 26));
+        v.insert(v.length(), &letter, 1);
+    }
+}
+
+///
+/// Returns true if a vector holds the letters of the alphabet, starting from 'a', and nothing else.
+///
+template<usize N>
+inline bool holdsLetters(SmallByteVector<N> const& v, usize length)
+{
+    if (v.length() != length) {
+        return false;
+    }
+    for (usize i = 0; i < length; i++) {
+        if (UNSAFE(v.data()[i]) != u8('a' + (i % 26))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+///
+/// Returns true if the bytes of a vector are stored in the vector object itself.
+///
+template<usize N>
+inline bool storedInObject(SmallByteVector<N> const& v)
+{
+    auto address = reinterpret_cast<usize>(v.data());
+    return address >= reinterpret_cast<usize>(&v) && address < reinterpret_cast<usize>(&v) + sizeof(v);
+}
+
+///
+/// Test a SmallByteVector<N>: contents of exactly N bytes stay inline, one byte more moves them to the heap, copies and
+/// moves keep the contents of inline and heap vectors, and a vector of .rodata copies the data inline if it fits once
+/// it is modified.
+///
+template<usize N>
+inline void testSmallByteVectorOf(usize& t)
+{
+    static_assert(N > 0 && N < 52);
+    using Vector = SmallByteVector<N>;
+
+    // Exactly N bytes stay inline, appended one at a time or inserted at once into an empty vector
+    Vector appended;
+    appendLetters(appended, N);
+    Vector inserted;
+    inserted.insert(0, BYTE_VECTOR_LETTERS, N);
+    stdout.println("\t(`) Expect \"true true true true true\" : ` ` ` ` `", t++, appended.isInline(),
+        appended.capacity() == N, holdsLetters(appended, N), inserted.isInline(), holdsLetters(inserted, N));
+
+    // One byte more spills to the heap, keeping the contents
+    Vector spilled;
+    appendLetters(spilled, N + 1);
+    Vector insertedPastN;
+    appendLetters(insertedPastN, 1);
+    insertedPastN.insert(1, &BYTE_VECTOR_LETTERS[1], N);
+    stdout.println("\t(`) Expect \"false true true false true\" : ` ` ` ` `", t++, spilled.isInline(),
+        spilled.capacity() > N, holdsLetters(spilled, N + 1), insertedPastN.isInline(),
+        holdsLetters(insertedPastN, N + 1));
+
+    // Copies and moves of an inline vector are inline, and the moved-from vector is left empty
+    {
+        Vector copy = appended;
+        Vector moved = static_cast<Vector&&>(appended);
+        stdout.println("\t(`) Expect \"true true true true true\" : ` ` ` ` `", t++, copy.isInline(),
+            holdsLetters(copy, N), moved.isInline(), holdsLetters(moved, N), appended.empty());
+        Vector assigned;
+        assigned = static_cast<Vector&&>(moved);
+        copy = assigned;
+        stdout.println("\t(`) Expect \"true true true\" : ` ` `", t++, holdsLetters(assigned, N), holdsLetters(copy, N),
+            moved.empty());
+    }
+
+    // A copy of a heap vector gets its own buffer, while a move takes the buffer over
+    {
+        auto const* buffer = spilled.data();
+        Vector copy = spilled;
+        Vector moved = static_cast<Vector&&>(spilled);
+        stdout.println("\t(`) Expect \"true true true true true\" : ` ` ` ` `", t++, copy.data() != buffer,
+            holdsLetters(copy, N + 1), moved.data() == buffer, holdsLetters(moved, N + 1), spilled.empty());
+        Vector assigned = inserted;
+        assigned = static_cast<Vector&&>(moved);
+        copy = inserted;
+        stdout.println("\t(`) Expect \"true true true true\" : ` ` ` `", t++, assigned.data() == buffer,
+            holdsLetters(assigned, N + 1), copy.isInline(), holdsLetters(copy, N));
+    }
+
+    // A vector of .rodata points to it until the data is asked for to be modified, which copies it inline if it fits
+    {
+        Vector fits(BYTE_VECTOR_LETTERS, N);
+        Vector doesNotFit(BYTE_VECTOR_LETTERS, N + 1);
+        Vector const& unmodifiedFits = fits;
+        Vector const& unmodifiedDoesNotFit = doesNotFit;
+        auto* letters = reinterpret_cast<u8 const*>(BYTE_VECTOR_LETTERS);
+        auto pointedToRodata = unmodifiedFits.data() == letters && unmodifiedDoesNotFit.data() == letters;
+        UNSAFE(fits.data()[0] = 'a');
+        UNSAFE(doesNotFit.data()[0] = 'a');
+        stdout.println("\t(`) Expect \"true true true true true false true\" : ` ` ` ` ` ` `", t++, pointedToRodata,
+            fits.isInline(), storedInObject(fits), holdsLetters(fits, N), fits.capacity() == N, doesNotFit.isInline(),
+            holdsLetters(doesNotFit, N + 1));
+    }
+}
+
+///
+/// Test SmallByteVector with an inline capacity smaller than its words, equal to them and larger than them.
+///
+inline void testSmallByteVector()
+{
+    stdout.println("\nTESTING SmallByteVector");
+    usize t = 0;
+    testSmallByteVectorOf<7>(t);
+    testSmallByteVectorOf<23>(t);
+    testSmallByteVectorOf<40>(t);
+}
@@ -0,0 +1,57 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+// The CRC-32C check value: the CRC of "123456789" with the usual initial value and final XOR of 0xFFFFFFFF
+static_assert((Crc32::hashBytes("123456789", 9, 0xFFFFFFFFu) ^ 0xFFFFFFFFu) == 0xE3069283u);
+
+///
+/// Test Crc32::hashBytes against hashing the same bytes one at a time with hash8: every length up to 300 (the 8-byte
+/// loop and its 4- and 1-byte tails), lengths around the interleaved rounds of 3 * 256 and 3 * 2048 bytes where the
+/// streams are combined with carry-less multiplication, and starts at every offset from an 8-byte boundary.
+///
+inline void testCrc32()
+{
+    stdout.println("\nTESTING Crc32::hashBytes");
+    usize t = 0;
+    // 0xE3069283
+    stdout.println("\t(`) Expect \"3808858755\" : `", t++, Crc32::hashBytes("123456789", 9, 0xFFFFFFFFu) ^ 0xFFFFFFFFu);
+
+    constexpr usize MAX_LENGTH = (2 * 3 * 2048) + (3 * 256) + 17;
+    auto* buffer = new u8[MAX_LENGTH + 8];
+    u64 seed = 0x9E3779B97F4A7C15ull;
+    for (usize i = 0; i < MAX_LENGTH + 8; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        UNSAFE(buffer[i] = u8(seed));
+    }
+
+    auto hashOneByOne = [&](u8 const* in, usize length, u32 crc) {
+        for (usize i = 0; i < length; i++) {
+            crc = Crc32::hash8(UNSAFE(in[i]), crc);
+        }
+        return crc;
+    };
+    usize mismatches = 0;
+    auto check = [&](usize length) {
+        for (usize offset = 0; offset < 8; offset++) {
+            for (u32 crc : {u32(Crc32::DEFAULT_SEED), 0xFFFFFFFFu}) {
+                u8 const* in = UNSAFE(buffer + offset);
+                mismatches += Crc32::hashBytes(in, length, crc) != hashOneByOne(in, length, crc);
+            }
+        }
+    };
+    for (usize length = 0; length <= 300; length++) {
+        check(length);
+    }
+    // One byte short of, at and past a round of short blocks, of two, of a round of long blocks, and of two long
+    // rounds followed by a short one
+    for (usize round : {usize(3 * 256), usize(2 * 3 * 256), usize(3 * 2048), usize((2 * 3 * 2048) + (3 * 256))}) {
+        for (usize length : {round - 1, round, round + 1, round + 7, round + 8, round + 13}) {
+            check(length);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : `", t++, mismatches);
+    delete[] buffer;
+}
@@ -0,0 +1,66 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test strlen, strnlen, wcslen and wcsnlen on strings that start at the beginning of a page or end at its end, with
+/// the pages on either side made inaccessible: the chunked loads must find the terminator (or stop at the limit)
+/// without reading across the page boundary.
+///
+inline void testCString()
+{
+    stdout.println("\nTESTING strlen, strnlen, wcslen and wcsnlen");
+    usize t = 0;
+    constexpr usize PAGE_SIZE = 4_KB;
+    constexpr usize C = impl::MEMORY_CHUNK;
+    auto mapping = LinuxSyscall(LinuxSyscall.mmap, 0, 3 * PAGE_SIZE, 0x1 | 0x2 /* PROT_READ | PROT_WRITE */,
+        0x02 | 0x20 /* MAP_PRIVATE | MAP_ANONYMOUS */, u64(-1), 0);
+    LinuxSyscall(LinuxSyscall.mprotect, mapping, PAGE_SIZE, 0 /* PROT_NONE */);
+    LinuxSyscall(LinuxSyscall.mprotect, mapping + (2 * PAGE_SIZE), PAGE_SIZE, 0 /* PROT_NONE */);
+    auto* page = reinterpret_cast<char*>(mapping + PAGE_SIZE);
+
+    UNSAFE_BEGIN;
+    usize mismatches = 0;
+    for (usize length = 0; length <= 3 * C; length++) {
+        for (usize k = 0; k <= C + 1; k++) {
+            for (usize start : {k, PAGE_SIZE - 1 - length - k}) {
+                memset(page, 'x', PAGE_SIZE);
+                page[start + length] = '\0';
+                char const* s = page + start;
+                mismatches += strlen(s) != length;
+                mismatches += strnlen(s, length) != length;
+                mismatches += strnlen(s, length + 1) != length;
+                mismatches += strnlen(s, length / 2) != length / 2;
+                mismatches += strnlen(s, ~usize(0)) != length;
+            }
+            // No terminator before the end of the page: only the limit stops the search
+            memset(page, 'x', PAGE_SIZE);
+            mismatches += strnlen(page + PAGE_SIZE - length - k, length + k) != length + k;
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (strlen, strnlen)", t++, mismatches);
+
+    mismatches = 0;
+    auto* widePage = reinterpret_cast<wchar_t*>(page);
+    constexpr usize WIDE_PAGE_LENGTH = PAGE_SIZE / sizeof(wchar_t);
+    for (usize length = 0; length <= C; length++) {
+        for (usize k = 0; k <= (C / sizeof(wchar_t)) + 1; k++) {
+            for (usize start : {k, WIDE_PAGE_LENGTH - 1 - length - k}) {
+                for (usize i = 0; i < WIDE_PAGE_LENGTH; i++) {
+                    widePage[i] = L'x';
+                }
+                widePage[start + length] = L'\0';
+                wchar_t const* s = widePage + start;
+                mismatches += wcslen(s) != length;
+                mismatches += wcsnlen(s, length / 2) != length / 2;
+                // Limits whose size in bytes does not fit in a usize
+                mismatches += wcsnlen(s, ~usize(0)) != length;
+                mismatches += wcsnlen(s, usize(1) << 62) != length;
+                mismatches += wcsnlen(s, (usize(1) << 62) + 1) != length;
+            }
+        }
+    }
+    UNSAFE_END;
+    stdout.println("\t(`) Expect \"0\" : ` (wcslen, wcsnlen)", t++, mismatches);
+    LinuxSyscall(LinuxSyscall.munmap, mapping, 3 * PAGE_SIZE);
+}
@@ -0,0 +1,112 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// A FixedMap key whose hash is chosen by the test, to give different keys the same hash.
+///
+struct CollidingFixedMapKey
+{
+    u64 value;
+    u32 hashValue;
+
+    template<typename Hasher>
+    constexpr u32 hash(auto) const
+    {
+        return hashValue;
+    }
+
+    constexpr bool operator==(CollidingFixedMapKey const& other) const { return value == other.value; }
+};
+
+///
+/// Returns a FixedMap of the keys 3i + 1 for i below count, with the value i * i, followed by the first duplicates
+/// keys listed again with the value 1000 + i. Built in a constant expression, the map has a perfect hash.
+///
+template<unsigned N>
+constexpr FixedMap<u64, u64, N> fixedMapOfSquares(unsigned count, unsigned duplicates)
+{
+    Tuple<u64, u64> tuples[N]{};
+    for (unsigned i = 0; i < count; i++) {
+        UNSAFE(tuples[i] = Tuple<u64, u64>(u64((3 * i) + 1), u64(i) * i));
+    }
+    for (unsigned i = 0; i < duplicates; i++) {
+        UNSAFE(tuples[count + i] = Tuple<u64, u64>(u64((3 * i) + 1), u64(1000 + i)));
+    }
+    return FixedMap<u64, u64, N>(ArrayRef<Tuple<u64, u64>>(&tuples[0], count + duplicates));
+}
+
+///
+/// Returns the number of lookups in a map from fixedMapOfSquares that do not give the expected value: every key, with
+/// its last listed value, and the absent keys up to 10000.
+///
+template<unsigned N>
+usize fixedMapOfSquaresMismatches(FixedMap<u64, u64, N> const& map, unsigned count, unsigned duplicates)
+{
+    usize mismatches = 0;
+    for (unsigned i = 0; i < count; i++) {
+        auto value = map[u64((3 * i) + 1)];
+        mismatches += !value.hasValue() || value.val() != (i < duplicates ? u64(1000 + i) : u64(i) * i);
+    }
+    for (u64 key = 0; key < 10'000; key++) {
+        mismatches += (key % 3 != 1 || key >= (3 * count) + 1) && map[key].hasValue();
+    }
+    return mismatches;
+}
+
+///
+/// Test FixedMap lookups when it is built in a constant expression, with a perfect hash, and at runtime, with open
+/// addressing: hits for every key, misses for absent keys, keys listed more than once at construction, keys that
+/// cannot be told apart by their hash, and a perfect map given a new key, after which it falls back to open addressing.
+///
+inline void testFixedMap()
+{
+    stdout.println("\nTESTING FixedMap");
+    usize t = 0;
+
+    // A key listed twice keeps its last value
+    static constexpr auto constant = FixedMap("hello", 1, "bob", 2, "apple", 3, "apple", 4);
+    auto runtime = FixedMap("hello", 1, "bob", 2, "apple", 3, "apple", 4);
+    stdout.println("\t(`) Expect \"true false 4\" : ` ` `", t++, constant.usesPerfectHash(), runtime.usesPerfectHash(),
+        constant.capacity());
+    auto lookups = [&](auto const& m) {
+        stdout.println("\t(`) Expect \"1 2 4 None None\" : ` ` ` ` `", t++, m["hello"], m["bob"], m["apple"], m["pear"],
+            m[""]);
+    };
+    lookups(constant);
+    lookups(runtime);
+
+    // 32 keys, 8 of them listed twice, in a table of 48 slots
+    static constexpr auto squares = fixedMapOfSquares<48>(32, 8);
+    auto squaresAtRuntime = fixedMapOfSquares<48>(32, 8);
+    stdout.println("\t(`) Expect \"true false\" : ` `", t++, squares.usesPerfectHash(),
+        squaresAtRuntime.usesPerfectHash());
+    stdout.println("\t(`) Expect \"0\" : ` (perfect hash)", t++, fixedMapOfSquaresMismatches(squares, 32, 8));
+    stdout.println(
+        "\t(`) Expect \"0\" : ` (open addressing)", t++, fixedMapOfSquaresMismatches(squaresAtRuntime, 32, 8));
+    // With every slot full
+    static constexpr auto fullSquares = fixedMapOfSquares<40>(40, 0);
+    stdout.println("\t(`) Expect \"true 0 0\" : ` ` `", t++, fullSquares.usesPerfectHash(),
+        fixedMapOfSquaresMismatches(fullSquares, 40, 0),
+        fixedMapOfSquaresMismatches(fixedMapOfSquares<40>(40, 0), 40, 0));
+
+    // Giving a key the map has a new value keeps the perfect hash; a new key drops it for open addressing
+    auto added = squares;
+    added.add(u64(4), u64(7));
+    stdout.println("\t(`) Expect \"true 7\" : ` `", t++, added.usesPerfectHash(), added[u64(4)]);
+    added.add(u64(4), u64(1001));
+    added.add(u64(3 * 32) + 1, u64(32) * 32);
+    added.add(u64(3 * 33) + 1, u64(33) * 33);
+    stdout.println(
+        "\t(`) Expect \"false 0\" : ` `", t++, added.usesPerfectHash(), fixedMapOfSquaresMismatches(added, 34, 8));
+    auto filled = constant;
+    filled.add("pear", 5);
+    stdout.println("\t(`) Expect \"false 1 2 4 5 None\" : ` ` ` ` ` `", t++, filled.usesPerfectHash(), filled["hello"],
+        filled["bob"], filled["apple"], filled["pear"], filled["plum"]);
+
+    // Different keys with the same hash cannot be given different slots by any pilot
+    static constexpr auto colliding = FixedMap(CollidingFixedMapKey{1, 5}, 1, CollidingFixedMapKey{2, 5}, 2,
+        CollidingFixedMapKey{3, 9}, 3, CollidingFixedMapKey{1, 5}, 4);
+    stdout.println("\t(`) Expect \"false 4 2 3 None None\" : ` ` ` ` ` `", t++, colliding.usesPerfectHash(),
+        colliding[{1, 5}], colliding[{2, 5}], colliding[{3, 9}], colliding[{4, 5}], colliding[{5, 9}]);
+}
@@ -0,0 +1,100 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns what toChars() writes for a float or double, or "None" if it fails.
+///
+template<IsFloatingPoint T>
+String floatToCharsString(T value, FloatFormat format = FloatFormat::GENERAL, Optional<u32> precision = None)
+{
+    char buffer[1200];
+    auto n = toChars(value, ArrayRef<char>(buffer), format, precision);
+    if (!n.hasValue()) {
+        return "None";
+    }
+    return String(StringRef(&buffer[0], n.val()));
+}
+
+///
+/// Test toChars() for floats and doubles: the shortest digits read back as the same value, and the FIXED, SCIENTIFIC
+/// and GENERAL formats round to a precision like printf's %.*f, %.*e and %.*g.
+///
+inline void testFloatToChars()
+{
+    stdout.println("\nTESTING toChars (floating point)");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+    using enum FloatFormat;
+
+    // Shortest round trip: random bit patterns (NaNs and infinities aside) must parse back to the same bits
+    u64 seed = 0x2545F4914F6CDD1Dull;
+    usize mismatches = 0;
+    for (usize i = 0; i < 100'000; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        auto d = bit_cast<double>(seed);
+        auto f = bit_cast<float>(u32(seed));
+        if (!__builtin_isnan(d) && !__builtin_isinf(d)) {
+            char buffer[FLOAT_TO_CHARS_MAX_LENGTH];
+            usize n = toChars(d, ArrayRef<char>(buffer)).val();
+            auto parsed = parse<double>(StringRef(&buffer[0], n));
+            mismatches += !parsed.isOk() || bit_cast<u64>(parsed.unwrap()) != seed;
+        }
+        if (!__builtin_isnan(f) && !__builtin_isinf(f)) {
+            char buffer[FLOAT_TO_CHARS_MAX_LENGTH];
+            usize n = toChars(f, ArrayRef<char>(buffer)).val();
+            auto parsed = parse<float>(StringRef(&buffer[0], n));
+            mismatches += !parsed.isOk() || bit_cast<u32>(parsed.unwrap()) != u32(seed);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : `", t++, mismatches);
+
+    check("0.1", floatToCharsString(0.1));
+    check("0.3333333333333333", floatToCharsString(1.0 / 3));
+    check("100.0", floatToCharsString(100.0));
+    check("1e+16", floatToCharsString(1e16));
+    check("0.0001", floatToCharsString(0.0001));
+    check("1e-05", floatToCharsString(0.00001));
+    check("-0.0", floatToCharsString(-0.0));
+    check("5e-324", floatToCharsString(5e-324));
+    check("1.7976931348623157e+308", floatToCharsString(1.7976931348623157e308));
+    check("2.2250738585072014e-308", floatToCharsString(2.2250738585072014e-308));
+    check("0.1", floatToCharsString(0.1f));
+    check("3.4028235e+38", floatToCharsString(3.4028235e38f));
+    check("1e-45", floatToCharsString(1e-45f));
+
+    // FIXED: digits after the point, like %.*f
+    check("3.14", floatToCharsString(3.14159, FIXED, 2));
+    check("2", floatToCharsString(2.5, FIXED, 0));
+    check("0.12", floatToCharsString(0.125, FIXED, 2));
+    check("0.000", floatToCharsString(1e-5, FIXED, 3));
+    check("-1.500", floatToCharsString(-1.5, FIXED, 3));
+    check("0.10000000000000000555", floatToCharsString(0.1, FIXED, 20));
+    check("10000000000000000.0", floatToCharsString(1e16, FIXED));
+
+    // SCIENTIFIC: digits after the point, like %.*e
+    check("1.23e+05", floatToCharsString(123456.0, SCIENTIFIC, 2));
+    check("1.23e-04", floatToCharsString(0.000123, SCIENTIFIC));
+    check("1e+300", floatToCharsString(1e300, SCIENTIFIC, 0));
+    check("9.99e+00", floatToCharsString(9.995, SCIENTIFIC, 2));
+    check("4.941e-324", floatToCharsString(5e-324, SCIENTIFIC, 3));
+
+    // GENERAL: significant digits, and scientific notation from an exponent of the precision on, like %.*g
+    check("1.2e+05", floatToCharsString(123456.0, GENERAL, 2));
+    check("123456.0", floatToCharsString(123456.0, GENERAL, 6));
+    check("0.00012", floatToCharsString(0.0001234, GENERAL, 2));
+    check("1.2e-05", floatToCharsString(0.00001234, GENERAL, 2));
+    check("100.0", floatToCharsString(99.96, GENERAL, 3));
+    check("1e+03", floatToCharsString(999.6, GENERAL, 3));
+    check("0.10000000000000001", floatToCharsString(0.1, GENERAL, 17));
+    check("1000000000000000.0", floatToCharsString(1e15, GENERAL, 20));
+
+    check("NaN inf -inf", String::fmt("` ` `", floatToCharsString(__builtin_nan("")),
+                              floatToCharsString(__builtin_inf()), floatToCharsString(-__builtin_inf())));
+    char small[4];
+    stdout.println("\t(`) Expect \"false\" : `", t++, toChars(0.125, ArrayRef<char>(small)).hasValue());
+}
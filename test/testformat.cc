@@ -0,0 +1,48 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+template<bool>
+struct FormatCheck
+{};
+
+///
+/// Satisfied if the literal L is a valid format string for Args, that is if it has one slot per argument. Parsing a
+/// format string happens in a consteval constructor, so a mismatch is a substitution failure here, not a hard error.
+///
+template<FormatLiteral L, typename... Args>
+concept IsFormatStringFor = requires { typename FormatCheck<(FormatString<Args...>(L.fmt), true)>; };
+
+static_assert(IsFormatStringFor<"no slots">);
+static_assert(IsFormatStringFor<"` + ` = `", int, int, int>);
+static_assert(!IsFormatStringFor<"` + ` = `", int, int>);
+static_assert(!IsFormatStringFor<"` + ` = `", int, int, int, int>);
+static_assert(!IsFormatStringFor<"no slots", int>);
+static_assert(!IsFormatStringFor<"`">);
+
+///
+/// Test String::fmt and the _fmt literal with each kind of argument, and with slots next to each other or at either
+/// end of the format string.
+///
+inline void testFormat()
+{
+    stdout.println("\nTESTING String::fmt");
+    usize t = 0;
+    stdout.println("\t(`) Expect \"no slots\" : `", t++, String::fmt("no slots"));
+    stdout.println("\t(`) Expect \"1 + 2 = 3\" : `", t++, String::fmt("` + ` = `", 1, 2, 3));
+    stdout.println("\t(`) Expect \"ab\" : `", t++, String::fmt("``", 'a', "b"));
+    stdout.println("\t(`) Expect \"[-42]\" : `", t++, String::fmt("[`]", -42));
+    stdout.println("\t(`) Expect \"-9223372036854775808 18446744073709551615\" : `", t++,
+        String::fmt("` `", MIN_VALUE<i64>, MAX_VALUE<u64>));
+    stdout.println("\t(`) Expect \"1.5 0.1\" : `", t++, String::fmt("` `", 1.5, 0.1));
+
+    String name = "a string that is too long to be stored inline";
+    StringRef ref = "ref";
+    stdout.println("\t(`) Expect \"<a string that is too long to be stored inline>\" : `", t++,
+        String::fmt("<`>", name));
+    stdout.println("\t(`) Expect \"ref=ref\" : `", t++, String::fmt("ref=`", ref));
+    stdout.println("\t(`) Expect \"x=1, y=2\" : `", t++, "x=`, y=`"_fmt(1, 2));
+
+    // A format string whose only slot is the whole string, as println(value) uses
+    stdout.println("\t(`) Expect \"12345\" : `", t++, String::fmt("`", 12345));
+}
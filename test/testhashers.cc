@@ -0,0 +1,134 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+// Constant evaluation reads the input byte by byte, and must agree with the known answers below
+static_assert(WyHash::hashBytes("message digest", 14, 0) == 0x41d032e1df79b67eull);
+static_assert(Xxh3::hashBytes("message digest", 14, 0) == 0x41d032e1df79b67eull);
+static_assert([] {
+    u8 input[300] = {};
+    for (usize i = 0; i < 300; i++) {
+        input[i] = u8((i * 7) + 3);
+    }
+    return WyHash::hashBytes(&input[0], 300, 0) == 0xb1a7bdf2798cead1ull &&
+           Xxh3::hashBytes(&input[0], 300, 0) == 0x3b6f5edcbb2247f7ull;
+}());
+
+///
+/// Test WyHash and Xxh3 against known answers, on the bytes u8(i * 7 + 3) at the lengths where their code paths
+/// change: the 3-, 8- and 16-byte reads, WyHash's 48-byte rounds, Xxh3's LONG_INPUT and its 1 KB blocks. The known
+/// answers come from separate transcriptions of the two algorithms, which give upstream wyhash's (final version 4) and
+/// XXH3's results when they are given upstream's secrets; these hashers have secrets of their own, so their results
+/// are not upstream's. Then check that the seed and every input bit change the hash, and that hash8/16/32/64 hash
+/// the little-endian bytes of the value like hashBytes.
+///
+inline void testHashers()
+{
+    stdout.println("\nTESTING WyHash and Xxh3");
+    usize t = 0;
+    struct KnownAnswer
+    {
+        usize length;
+        u64 seed;
+        u64 wyHash;
+        u64 xxh3;
+    };
+    KnownAnswer const KNOWN_ANSWERS[] = {
+        {0, 0, 0x0409638ee2bde459ull, 0x0409638ee2bde459ull},
+        {0, 0x9E3779B97F4A7C15ull, 0x9ac2c3a040ba9638ull, 0x9ac2c3a040ba9638ull},
+        {1, 0, 0xac4c24d5552ac9edull, 0xac4c24d5552ac9edull},
+        {1, 0x9E3779B97F4A7C15ull, 0xd6e59523ff1aecdcull, 0xd6e59523ff1aecdcull},
+        {3, 0, 0x5f537215ae3e82f9ull, 0x5f537215ae3e82f9ull},
+        {3, 0x9E3779B97F4A7C15ull, 0x8f142bff46509f76ull, 0x8f142bff46509f76ull},
+        {4, 0, 0x6cbf4a473d35cedeull, 0x6cbf4a473d35cedeull},
+        {4, 0x9E3779B97F4A7C15ull, 0x297dda9f93241098ull, 0x297dda9f93241098ull},
+        {8, 0, 0xdd7753dcc1e7d7a2ull, 0xdd7753dcc1e7d7a2ull},
+        {8, 0x9E3779B97F4A7C15ull, 0x37d7a34532e499acull, 0x37d7a34532e499acull},
+        {9, 0, 0x1446304174856561ull, 0x1446304174856561ull},
+        {9, 0x9E3779B97F4A7C15ull, 0x23dfb0d7ce1d696dull, 0x23dfb0d7ce1d696dull},
+        {16, 0, 0x853aa766ce2f8c64ull, 0x853aa766ce2f8c64ull},
+        {16, 0x9E3779B97F4A7C15ull, 0x399b279e47b146a2ull, 0x399b279e47b146a2ull},
+        {17, 0, 0x8c406b9bd1cbf3ffull, 0x8c406b9bd1cbf3ffull},
+        {17, 0x9E3779B97F4A7C15ull, 0x18430711a1b1c31full, 0x18430711a1b1c31full},
+        {33, 0, 0x25cd17aea5279511ull, 0x25cd17aea5279511ull},
+        {33, 0x9E3779B97F4A7C15ull, 0xda5644fb028309bdull, 0xda5644fb028309bdull},
+        {48, 0, 0x446d9fb23a188f73ull, 0x446d9fb23a188f73ull},
+        {48, 0x9E3779B97F4A7C15ull, 0x3d5cd6adec141822ull, 0x3d5cd6adec141822ull},
+        {49, 0, 0x271253a8708703e1ull, 0x271253a8708703e1ull},
+        {49, 0x9E3779B97F4A7C15ull, 0xd6bd846fb734ab1bull, 0xd6bd846fb734ab1bull},
+        {96, 0, 0x8461f4e504f284fbull, 0x8461f4e504f284fbull},
+        {96, 0x9E3779B97F4A7C15ull, 0xc5f46a3ae70edad5ull, 0xc5f46a3ae70edad5ull},
+        {97, 0, 0xde2063f25fd5deacull, 0xde2063f25fd5deacull},
+        {97, 0x9E3779B97F4A7C15ull, 0x5ec4ea7af85c5ee9ull, 0x5ec4ea7af85c5ee9ull},
+        {255, 0, 0x74e7ca198a417992ull, 0x74e7ca198a417992ull},
+        {255, 0x9E3779B97F4A7C15ull, 0x9de84bbfbe49eae4ull, 0x9de84bbfbe49eae4ull},
+        {256, 0, 0x1629dc9be63726c2ull, 0xf609f1d993122977ull},
+        {256, 0x9E3779B97F4A7C15ull, 0x70a4f4c614921a9eull, 0x24216256c7f66033ull},
+        {257, 0, 0xa179c9f6dee3acd2ull, 0x10bd5d766fd543fbull},
+        {257, 0x9E3779B97F4A7C15ull, 0x3400d8cdcee0026full, 0x5d711c373f3a2a8aull},
+        {1024, 0, 0x34c6f63a69e52c85ull, 0x554e6fd0835580faull},
+        {1024, 0x9E3779B97F4A7C15ull, 0x8c58e49fd39abad5ull, 0xc4b4ea5d52122abfull},
+        {1025, 0, 0xd1a6dde3364c6ab6ull, 0xe4b909ced65394abull},
+        {1025, 0x9E3779B97F4A7C15ull, 0xd77442a99f3dc21bull, 0xead08edef5fafc8full},
+        {4999, 0, 0x72b9d6327d0d7500ull, 0xb203a66e658324f5ull},
+        {4999, 0x9E3779B97F4A7C15ull, 0x86da490f2b7b4912ull, 0xef01f0fcaecdc8e5ull},
+    };
+    constexpr usize MAX_LENGTH = 4999;
+    auto* input = new u8[MAX_LENGTH];
+    UNSAFE_BEGIN;
+    for (usize i = 0; i < MAX_LENGTH; i++) {
+        input[i] = u8((i * 7) + 3);
+    }
+    usize mismatches = 0;
+    for (KnownAnswer const& k : KNOWN_ANSWERS) {
+        mismatches += WyHash::hashBytes(input, k.length, k.seed) != k.wyHash;
+        mismatches += Xxh3::hashBytes(input, k.length, k.seed) != k.xxh3;
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (known answers)", t++, mismatches);
+
+    // Different seeds give different hashes, and so does flipping any one bit of the input
+    usize collisions = 0;
+    auto checkSensitivity = [&](auto hashBytes, usize length) {
+        u64 seeds[] = {0, 1, 2, u64(1) << 63, 0x9E3779B97F4A7C15ull};
+        u64 hashes[5];
+        for (usize i = 0; i < 5; i++) {
+            hashes[i] = hashBytes(input, length, seeds[i]);
+            for (usize j = 0; j < i; j++) {
+                collisions += hashes[i] == hashes[j];
+            }
+        }
+        for (usize bit = 0; bit < length * 8; bit += (length < 64 ? 1 : 61)) {
+            input[bit / 8] ^= u8(1 << (bit % 8));
+            collisions += hashBytes(input, length, 0) == hashes[0];
+            input[bit / 8] ^= u8(1 << (bit % 8));
+        }
+    };
+    for (usize length = 0; length <= 300; length++) {
+        checkSensitivity([](u8 const* p, usize n, u64 seed) { return WyHash::hashBytes(p, n, seed); }, length);
+        checkSensitivity([](u8 const* p, usize n, u64 seed) { return Xxh3::hashBytes(p, n, seed); }, length);
+    }
+    for (usize length : {usize(1024), usize(1025), MAX_LENGTH}) {
+        checkSensitivity([](u8 const* p, usize n, u64 seed) { return Xxh3::hashBytes(p, n, seed); }, length);
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (seed and input bits)", t++, collisions);
+
+    // The fixed-width hashes are hashBytes on the little-endian bytes
+    mismatches = 0;
+    for (u64 seed : {u64(0), u64(0x9E3779B97F4A7C15ull)}) {
+        for (usize i = 0; i + 8 <= 64; i++) {
+            u8 const* p = input + i;
+            u64 value = 0;
+            for (usize k = 0; k < 8; k++) {
+                value |= u64(p[k]) << (8 * k);
+            }
+            mismatches += WyHash::hash8(u8(value), seed) != WyHash::hashBytes(p, 1, seed);
+            mismatches += WyHash::hash16(u16(value), seed) != WyHash::hashBytes(p, 2, seed);
+            mismatches += WyHash::hash32(u32(value), seed) != WyHash::hashBytes(p, 4, seed);
+            mismatches += WyHash::hash64(value, seed) != WyHash::hashBytes(p, 8, seed);
+            mismatches += Xxh3::hash64(value, seed) != Xxh3::hashBytes(p, 8, seed);
+        }
+    }
+    UNSAFE_END;
+    stdout.println("\t(`) Expect \"0\" : ` (hash8/16/32/64)", t++, mismatches);
+    delete[] input;
+}
@@ -0,0 +1,333 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+extern "C" int pthread_create(unsigned long* thread, void const* attr, void* (*start)(void*), void* arg);
+extern "C" int pthread_join(unsigned long thread, void** result);
+
+///
+/// Returns true if the page at a page-aligned address is mapped: mincore fails with ENOMEM for unmapped memory.
+///
+inline bool isPageMapped(void const* page)
+{
+    u8 residency = 0;
+    return LinuxSyscall(LinuxSyscall.mincore, usize(page), LinuxHeap::PAGE_SIZE, usize(&residency)) == 0;
+}
+
+///
+/// Test allocations aligned to more than a page, which LinuxHeap gives a mapping of their own.
+///
+inline void testHeap()
+{
+    stdout.println("\nTESTING LinuxHeap");
+    usize t = 0;
+    for (usize alignment : {8_KB, 64_KB, 256_KB, 1_MB}) {
+        auto ok = true;
+        for (usize size : {1ull, 100ull, 8_KB, 1_MB}) {
+            auto* ptr = static_cast<u8*>(LinuxHeap::allocate(size, alignment));
+            if (ptr == nullptr) {
+                ok = false;
+            } else {
+                ok = ok && (reinterpret_cast<usize>(ptr) & (alignment - 1)) == 0;
+                ok = ok && LinuxHeap::usableSize(ptr) >= size;
+                memset(ptr, 0xab, size);
+                if (size == 100) {
+                    LinuxHeap::deallocate(ptr, size, alignment);
+                } else {
+                    LinuxHeap::deallocate(ptr);
+                }
+            }
+        }
+        stdout.println("\t(`) Expect \"true\" : ` (aligned to ` bytes)", t++, ok, alignment);
+    }
+
+    // Through operator new, which used to trap for alignments larger than a page
+    struct alignas(8_KB) Aligned8K
+    {
+        u8 bytes[100];
+    };
+    struct alignas(64_KB) Aligned64K
+    {
+        u8 bytes[100];
+    };
+    auto* a = new Aligned8K;
+    auto* b = new Aligned64K[3];
+    stdout.println("\t(`) Expect \"0\" : `", t++, reinterpret_cast<usize>(a) % 8_KB);
+    stdout.println("\t(`) Expect \"0\" : `", t++, reinterpret_cast<usize>(b) % 64_KB);
+    delete a;
+    delete[] b;
+}
+
+///
+/// Test the size classes of LinuxHeap, calling it directly since operator new leaves the heap to malloc when built with
+/// the address sanitizer: the smallest and largest request of every class up to MAX_SMALL_SIZE, blocks that lie in
+/// their span with spanOf() finding its header, and a freed block that is handed out again for its class.
+///
+inline void testHeapSizeClasses()
+{
+    stdout.println("\nTESTING LinuxHeap size classes");
+    usize t = 0;
+    UNSAFE_BEGIN;
+    usize mismatches = 0;
+    for (u32 c = 0; c < LinuxHeap::NUM_SIZE_CLASSES; c++) {
+        auto size = LinuxHeap::classSize(c);
+        auto smallest = c == 0 ? usize(1) : LinuxHeap::classSize(c - 1) + 1;
+        mismatches += LinuxHeap::sizeClassOf(smallest) != c || LinuxHeap::sizeClassOf(size) != c;
+        for (usize request : {smallest, size}) {
+            auto* ptr = static_cast<u8*>(LinuxHeap::allocate(request));
+            auto* span = reinterpret_cast<u8*>(LinuxHeap::spanOf(ptr));
+            mismatches += LinuxHeap::spanOf(ptr)->magic != LinuxHeap::SPAN_MAGIC;
+            mismatches += LinuxHeap::spanOf(ptr)->sizeClass != c || LinuxHeap::usableSize(ptr) != size;
+            mismatches += reinterpret_cast<usize>(ptr) % LinuxHeap::MIN_ALIGNMENT != 0;
+            mismatches += ptr < span + LinuxHeap::DATA_OFFSET || ptr + size > span + LinuxHeap::SPAN_SIZE;
+            memset(ptr, 0xab, size);
+            if (request == size) {
+                LinuxHeap::deallocate(ptr, request, LinuxHeap::MIN_ALIGNMENT);
+            } else {
+                LinuxHeap::deallocate(ptr);
+            }
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (every size class)", t++, mismatches);
+    // One byte past the largest class gets a mapping of its own
+    auto* large = LinuxHeap::allocate(LinuxHeap::MAX_SMALL_SIZE + 1);
+    stdout.println("\t(`) Expect \"true true\" : ` `", t++, LinuxHeap::spanOf(large)->sizeClass == LinuxHeap::LARGE,
+        LinuxHeap::usableSize(large) > LinuxHeap::MAX_SMALL_SIZE);
+    LinuxHeap::deallocate(large);
+
+    // Enough blocks of the largest classes to fill several spans, which do not divide into them evenly
+    mismatches = 0;
+    constexpr usize BLOCKS = 40;
+    void* blocks[BLOCKS];
+    for (u32 c : {LinuxHeap::NUM_SIZE_CLASSES - 4, LinuxHeap::NUM_SIZE_CLASSES - 1}) {
+        auto size = LinuxHeap::classSize(c);
+        for (auto*& block : blocks) {
+            block = LinuxHeap::allocate(size);
+            auto* span = reinterpret_cast<u8*>(LinuxHeap::spanOf(block));
+            mismatches += LinuxHeap::spanOf(block)->sizeClass != c || span == block;
+            mismatches += static_cast<u8*>(block) + size > span + LinuxHeap::SPAN_SIZE;
+            memset(block, 0xcd, size);
+        }
+        for (auto* block : blocks) {
+            LinuxHeap::deallocate(block, size, LinuxHeap::MIN_ALIGNMENT);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (blocks across spans)", t++, mismatches);
+
+    // A freed block is the next one handed out for any request in its class
+    auto* first = LinuxHeap::allocate(100);
+    LinuxHeap::deallocate(first);
+    auto* second = LinuxHeap::allocate(97);
+    stdout.println("\t(`) Expect \"true\" : `", t++, first == second);
+    LinuxHeap::deallocate(second, 97, LinuxHeap::MIN_ALIGNMENT);
+    UNSAFE_END;
+}
+
+///
+/// Test LinuxHeap allocations larger than MAX_SMALL_SIZE, which get a mapping of their own: they are zeroed and usable
+/// to the end, the mapping is gone once they are freed, and the heap keeps serving them after many are freed. Also
+/// blocks that start on a span boundary, whose header spanOf() finds in the page before them.
+///
+inline void testHeapLarge()
+{
+    stdout.println("\nTESTING LinuxHeap large allocations");
+    usize t = 0;
+    UNSAFE_BEGIN;
+    usize mismatches = 0;
+    for (usize size : {LinuxHeap::MAX_SMALL_SIZE + 1, usize(64_KB), usize(1_MB + 17), usize(5_MB)}) {
+        for (usize round = 0; round < 3; round++) {
+            auto* ptr = static_cast<u8*>(LinuxHeap::allocate(size));
+            auto* span = LinuxHeap::spanOf(ptr);
+            auto mappingSize = span->mappingSize;
+            mismatches += span->sizeClass != LinuxHeap::LARGE || LinuxHeap::usableSize(ptr) < size;
+            // A new mapping each time, so nothing written before is left in it
+            mismatches += ptr[0] != 0 || ptr[size / 2] != 0 || ptr[size - 1] != 0;
+            memset(ptr, 0xab, LinuxHeap::usableSize(ptr));
+            if (round == 1) {
+                LinuxHeap::deallocate(ptr, size, LinuxHeap::MIN_ALIGNMENT);
+            } else {
+                LinuxHeap::deallocate(ptr);
+            }
+            auto* lastPage = reinterpret_cast<u8*>(span) + mappingSize - LinuxHeap::PAGE_SIZE;
+            mismatches += isPageMapped(span) || isPageMapped(lastPage);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (freed and mapped again)", t++, mismatches);
+
+    // Freeing every one of them returns the memory, so allocating many in turn does not run out
+    mismatches = 0;
+    for (usize i = 0; i < 2000; i++) {
+        auto* ptr = static_cast<u8*>(LinuxHeap::allocate(4_MB));
+        mismatches += ptr == nullptr;
+        if (ptr != nullptr) {
+            ptr[i] = 1;
+            LinuxHeap::deallocate(ptr);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (2000 of 4 MB in turn)", t++, mismatches);
+
+    // Aligned to a span or more, the block starts on a span boundary and its header is in the page before it
+    mismatches = 0;
+    for (usize alignment : {LinuxHeap::SPAN_SIZE, 2 * LinuxHeap::SPAN_SIZE}) {
+        for (usize size : {usize(1), LinuxHeap::SPAN_SIZE, LinuxHeap::SPAN_SIZE + 1}) {
+            auto* ptr = static_cast<u8*>(LinuxHeap::allocate(size, alignment));
+            auto* header = LinuxHeap::spanOf(ptr);
+            mismatches += reinterpret_cast<usize>(ptr) % alignment != 0;
+            mismatches += reinterpret_cast<u8*>(header) != ptr - LinuxHeap::PAGE_SIZE;
+            mismatches += header->magic != LinuxHeap::SPAN_MAGIC || header->sizeClass != LinuxHeap::LARGE;
+            mismatches += LinuxHeap::usableSize(ptr) != alignUp(size, LinuxHeap::PAGE_SIZE);
+            memset(ptr, 0xab, LinuxHeap::usableSize(ptr));
+            LinuxHeap::deallocate(ptr);
+            mismatches += isPageMapped(header) || isPageMapped(ptr);
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (blocks on a span boundary)", t++, mismatches);
+    UNSAFE_END;
+}
+
+///
+/// Test allocations of HUGE_PAGE_THRESHOLD bytes or more, which are mapped aligned to HUGE_PAGE_SIZE: from
+/// HugePageAllocator, as the storage of a HugePageArray, and from LinuxHeap itself. Each one is zeroed, writable to its
+/// end, and unmapped once it is freed.
+///
+inline void testHugePages()
+{
+    stdout.println("\nTESTING huge page allocations");
+    usize t = 0;
+    UNSAFE_BEGIN;
+    // Not a multiple of the huge page size, so the mapping ends past the last byte
+    constexpr usize SIZE = LinuxHeap::HUGE_PAGE_THRESHOLD + 5_MB + 123;
+    auto nonZeroBytes = [](u8 const* bytes, usize sizeBytes) {
+        usize count = 0;
+        for (usize i = 0; i < sizeBytes; i++) {
+            count += bytes[i] != 0;
+        }
+        return count;
+    };
+    auto isHugePageAligned = [](void const* ptr) {
+        return reinterpret_cast<usize>(ptr) % LinuxHeap::HUGE_PAGE_SIZE == 0;
+    };
+
+    usize mismatches = 0;
+    for (usize round = 0; round < 3; round++) {
+        auto* ptr = static_cast<u8*>(HugePageAllocator.allocate(SIZE, 64));
+        auto* lastPage = ptr + alignUp(SIZE, LinuxHeap::HUGE_PAGE_SIZE) - LinuxHeap::PAGE_SIZE;
+        mismatches += !isHugePageAligned(ptr) || nonZeroBytes(ptr, SIZE) != 0;
+        memset(ptr, 0x5a, SIZE);
+        mismatches += ptr[0] != 0x5a || ptr[SIZE - 1] != 0x5a || !isPageMapped(ptr) || !isPageMapped(lastPage);
+        HugePageAllocator.deallocate(ptr, SIZE, 64);
+        mismatches += isPageMapped(ptr) || isPageMapped(lastPage);
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (HugePageAllocator)", t++, mismatches);
+
+    mismatches = 0;
+    u8 const* first = nullptr;
+    u8 const* lastPage = nullptr;
+    {
+        auto array = HugePageArray<u64>(SIZE / sizeof(u64));
+        auto* data = array.data();
+        first = reinterpret_cast<u8 const*>(data);
+        lastPage = first + alignUp(array.sizeBytes(), LinuxHeap::HUGE_PAGE_SIZE) - LinuxHeap::PAGE_SIZE;
+        mismatches += array.length() != SIZE / sizeof(u64) || !isHugePageAligned(data);
+        mismatches += nonZeroBytes(first, array.sizeBytes()) != 0;
+        for (usize i = 0; i < array.length(); i++) {
+            data[i] = i * 3;
+        }
+        for (usize i = 0; i < array.length(); i++) {
+            mismatches += data[i] != i * 3;
+        }
+        mismatches += !isPageMapped(first) || !isPageMapped(lastPage);
+    }
+    mismatches += isPageMapped(first) || isPageMapped(lastPage);
+    stdout.println("\t(`) Expect \"0\" : ` (HugePageArray)", t++, mismatches);
+
+    // LinuxHeap maps blocks this large aligned to a huge page too, with the span header in the first page
+    mismatches = 0;
+    for (usize round = 0; round < 3; round++) {
+        auto* ptr = static_cast<u8*>(LinuxHeap::allocate(SIZE));
+        auto* span = LinuxHeap::spanOf(ptr);
+        auto mappingSize = span->mappingSize;
+        auto* spanLastPage = reinterpret_cast<u8*>(span) + mappingSize - LinuxHeap::PAGE_SIZE;
+        mismatches += !isHugePageAligned(span);
+        mismatches += mappingSize != alignUp(SIZE + LinuxHeap::DATA_OFFSET, LinuxHeap::HUGE_PAGE_SIZE);
+        mismatches += LinuxHeap::usableSize(ptr) < SIZE || nonZeroBytes(ptr, SIZE) != 0;
+        memset(ptr, 0x5a, LinuxHeap::usableSize(ptr));
+        LinuxHeap::deallocate(ptr);
+        mismatches += isPageMapped(span) || isPageMapped(spanLastPage);
+    }
+    // Just below the threshold, the mapping is only rounded up to a page
+    auto* below = LinuxHeap::allocate(LinuxHeap::HUGE_PAGE_THRESHOLD - LinuxHeap::DATA_OFFSET - 1);
+    mismatches += LinuxHeap::spanOf(below)->mappingSize != LinuxHeap::HUGE_PAGE_THRESHOLD;
+    LinuxHeap::deallocate(below);
+    stdout.println("\t(`) Expect \"0\" : ` (LinuxHeap)", t++, mismatches);
+    UNSAFE_END;
+}
+
+///
+/// Test the per-thread caches of LinuxHeap with blocks allocated on one thread and freed on another. The thread that
+/// frees them caches them up to the high-water mark, past which it flushes half of them to the shared free list, and
+/// returns the rest when it exits. A new thread then refills its cache a batch at a time from the shared list and gets
+/// back every one of the blocks.
+///
+inline void testHeapThreadCache()
+{
+    stdout.println("\nTESTING LinuxHeap thread caches");
+    usize t = 0;
+    constexpr usize SIZE = 1_KB;
+    constexpr usize BLOCKS = 256;
+    struct Blocks
+    {
+        void* freed[BLOCKS];
+        u32 mostCached;
+        u32 cachedAtExit;
+        u32 cachedAfterRefill;
+        usize returned;
+    };
+    auto sizeClass = LinuxHeap::sizeClassOf(SIZE);
+    auto limit = LinuxHeap::cacheLimit(sizeClass);
+    Blocks blocks = {};
+    UNSAFE_BEGIN;
+    for (auto*& block : blocks.freed) {
+        block = LinuxHeap::allocate(SIZE);
+    }
+
+    auto freeBlocks = [](void* arg) -> void* {
+        auto& b = *static_cast<Blocks*>(arg);
+        auto c = LinuxHeap::sizeClassOf(SIZE);
+        for (auto* block : b.freed) {
+            LinuxHeap::deallocate(block);
+            b.mostCached = max(b.mostCached, LinuxHeap::cachedBlocks(c));
+        }
+        b.cachedAtExit = LinuxHeap::cachedBlocks(c);
+        return nullptr;
+    };
+    auto allocateBlocks = [](void* arg) -> void* {
+        auto& b = *static_cast<Blocks*>(arg);
+        auto c = LinuxHeap::sizeClassOf(SIZE);
+        void* allocated[BLOCKS];
+        for (usize i = 0; i < BLOCKS; i++) {
+            allocated[i] = LinuxHeap::allocate(SIZE);
+            if (i == 0) {
+                b.cachedAfterRefill = LinuxHeap::cachedBlocks(c);
+            }
+        }
+        for (auto* block : allocated) {
+            for (auto* freed : b.freed) {
+                b.returned += block == freed;
+            }
+            LinuxHeap::deallocate(block, SIZE, LinuxHeap::MIN_ALIGNMENT);
+        }
+        return nullptr;
+    };
+    unsigned long thread = 0;
+    pthread_create(&thread, nullptr, freeBlocks, &blocks);
+    pthread_join(thread, nullptr);
+    pthread_create(&thread, nullptr, allocateBlocks, &blocks);
+    pthread_join(thread, nullptr);
+    UNSAFE_END;
+
+    stdout.println("\t(`) Expect \"true true\" : ` `", t++, blocks.mostCached == limit,
+        blocks.cachedAtExit > 0 && blocks.cachedAtExit <= limit);
+    stdout.println("\t(`) Expect \"`\" : `", t++, (limit / 2) - 1, blocks.cachedAfterRefill);
+    stdout.println("\t(`) Expect \"`\" : ` (blocks back from the exited thread)", t++, BLOCKS, blocks.returned);
+}
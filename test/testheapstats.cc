@@ -0,0 +1,105 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// An output stream for HeapStats::dump that allocates for every line it is given, as one that formats into a String
+/// would, and counts the lines.
+///
+struct AllocatingLineCounter
+{
+    usize* lines;
+
+    void println(auto const&, auto const&...) const
+    {
+        ByteVector line;
+        line.reserve(64);
+        ++*lines;
+    }
+};
+
+///
+/// The allocations recorded between two copies of the call-site table: the number of call sites that changed, the
+/// allocations and bytes added to them, and the file of (the last of) them.
+///
+struct CallSiteChanges
+{
+    usize sites;
+    u64 count;
+    u64 bytes;
+    StringRef file;
+};
+
+inline CallSiteChanges callSiteChanges(
+    HeapStats::CallSite const* before, u32 nBefore, HeapStats::CallSite const* after, u32 nAfter)
+{
+    CallSiteChanges changes = {};
+    UNSAFE_BEGIN;
+    for (u32 i = 0; i < nAfter; i++) {
+        auto const& site = after[i];
+        u64 countBefore = 0;
+        u64 bytesBefore = 0;
+        for (u32 j = 0; j < nBefore; j++) {
+            if (before[j].where.file() == site.where.file() && before[j].where.line() == site.where.line()) {
+                countBefore = before[j].count;
+                bytesBefore = before[j].bytes;
+            }
+        }
+        if (site.count != countBefore) {
+            changes.sites++;
+            changes.count += site.count - countBefore;
+            changes.bytes += site.bytes - bytesBefore;
+            changes.file = site.where.file();
+        }
+    }
+    UNSAFE_END;
+    return changes;
+}
+
+///
+/// Test the histogram and the call-site table of HeapStats after known allocations, and that dump() can print to an
+/// output stream that allocates.
+///
+inline void testHeapStats()
+{
+    stdout.println("\nTESTING HeapStats");
+    if constexpr (!HeapStats::ENABLED) {
+        stdout.println("\tSkipped, needs CM_HEAP_STATS");
+        return;
+    }
+    usize t = 0;
+    stdout.println("\t(`) Expect \"0 1 2 2 11 11 64\" : ` ` ` ` ` ` `", t++, HeapStats::bucketOf(0),
+        HeapStats::bucketOf(1), HeapStats::bucketOf(2), HeapStats::bucketOf(3), HeapStats::bucketOf(1024),
+        HeapStats::bucketOf(2047), HeapStats::bucketOf(~usize(0)));
+
+    // Three buffers of 5000 bytes, from the same line of ByteVector. The heap rounds them up to no more than 8 KB, so
+    // they stay in the bucket of [4096, 8192).
+    constexpr usize SIZE = 5000;
+    static HeapStats::CallSite before[HeapStats::MAX_CALL_SITES];
+    static HeapStats::CallSite after[HeapStats::MAX_CALL_SITES];
+    auto nBefore = HeapStats::callSites(before);
+    auto bucketBefore = HeapStats::bucketCount(HeapStats::bucketOf(SIZE));
+    auto allocationsBefore = HeapStats::allocationCount();
+    auto freesBefore = HeapStats::freeCount();
+    {
+        ByteVector a;
+        ByteVector b;
+        ByteVector c;
+        a.reserve(SIZE);
+        b.reserve(SIZE);
+        c.reserve(SIZE);
+    }
+    auto allocations = HeapStats::allocationCount() - allocationsBefore;
+    auto frees = HeapStats::freeCount() - freesBefore;
+    auto bucket = HeapStats::bucketCount(HeapStats::bucketOf(SIZE)) - bucketBefore;
+    auto nAfter = HeapStats::callSites(after);
+    auto changes = callSiteChanges(&before[0], nBefore, &after[0], nAfter);
+    stdout.println("\t(`) Expect \"3 3 3\" : ` ` `", t++, allocations, frees, bucket);
+    stdout.println("\t(`) Expect \"1 3 15000 true\" : ` ` ` `", t++, changes.sites, changes.count, changes.bytes,
+        changes.file.find("array_list.hh").hasValue());
+
+    // The output stream allocates, which records a call site while dump() goes through them
+    usize lines = 0;
+    HeapStats::dump(AllocatingLineCounter{&lines});
+    stdout.println("\t(`) Expect \"true\" : `", t++, lines > 6);
+}
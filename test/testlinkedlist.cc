@@ -0,0 +1,175 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// An allocator that records the blocks a container asks for, and takes them from the heap.
+///
+struct RecordingAllocator
+{
+    constexpr static usize MAX_RECORDED = 16;
+
+    usize allocations = 0;
+    usize deallocations = 0;
+    usize lastAlignment = 0;
+    usize sizes[MAX_RECORDED]{};
+
+    Allocator allocator() { return Allocator(this, _allocate, _deallocate); }
+
+private:
+    static void* _allocate(void* self, usize sizeBytes, usize alignment)
+    {
+        auto* r = static_cast<RecordingAllocator*>(self);
+        if (r->allocations < MAX_RECORDED) {
+            UNSAFE(r->sizes[r->allocations] = sizeBytes);
+        }
+        r->allocations++;
+        r->lastAlignment = alignment;
+        return Allocator().allocate(sizeBytes, alignment);
+    }
+
+    static void _deallocate(void* self, void* ptr, usize sizeBytes, usize alignment)
+    {
+        static_cast<RecordingAllocator*>(self)->deallocations++;
+        Allocator().deallocate(ptr, sizeBytes, alignment);
+    }
+};
+
+///
+/// A list element with a stricter alignment than any allocator gives by default.
+///
+struct alignas(64) OverAlignedElement
+{
+    u64 value;
+};
+
+///
+/// A list element that counts how many of its instances are alive.
+///
+struct LiveCountedElement
+{
+    static inline isize live = 0;
+    u64 value;
+
+    LiveCountedElement(u64 v)
+        : value(v)
+    {
+        live++;
+    }
+    LiveCountedElement(LiveCountedElement const& other)
+        : value(other.value)
+    {
+        live++;
+    }
+    ~LiveCountedElement() { live--; }
+};
+
+///
+/// Test the node pool of DLList: removed nodes are reused without going to the allocator, chunks double from
+/// FIRST_CHUNK_NODES up to MAX_CHUNK_NODES, elements are aligned as their type requires, and elements are destroyed
+/// when they are removed, when the list is cleared and when the list is destroyed.
+///
+inline void testLinkedList()
+{
+    stdout.println("\nTESTING DLList");
+    usize t = 0;
+
+    {
+        // The first chunk holds 8 nodes, and removed nodes are handed out again before a new chunk is taken
+        RecordingAllocator recorder;
+        DLList<u64> list(recorder.allocator());
+        for (u64 i = 0; i < 8; i++) {
+            list.end().insert(i);
+        }
+        auto afterFill = recorder.allocations;
+        for (auto it = list.begin(); it != list.end();) {
+            it.remove();
+            if (it != list.end()) {
+                ++it;
+            }
+        }
+        for (u64 i = 8; i < 12; i++) {
+            list.end().insert(i);
+        }
+        auto afterReinsert = recorder.allocations;
+        auto* firstNode = &list.first();
+        list.begin().remove();
+        list.end().insert(12);
+        auto reused = &list.last() == firstNode;
+        list.clear();
+        for (u64 i = 0; i < 8; i++) {
+            list.end().insert(i);
+        }
+        auto afterClear = recorder.allocations;
+        list.end().insert(8);
+        stdout.println("\t(`) Expect \"1 1 true 1 2\" : ` ` ` ` `", t++, afterFill, afterReinsert, reused, afterClear,
+            recorder.allocations);
+        u64 sum = 0;
+        list.forEach([&](u64 value) { sum += value; });
+        stdout.println("\t(`) Expect \"9 36\" : ` `", t++, list.length(), sum);
+    }
+    {
+        // 8 + 16 + ... + 1024 + 1024 nodes fill 9 chunks
+        RecordingAllocator recorder;
+        {
+            DLList<u64> list(recorder.allocator());
+            for (u64 i = 0; i < 3064; i++) {
+                list.end().insert(i);
+            }
+            stdout.println("\t(`) Expect \"9\" : `", t++, recorder.allocations);
+            list.end().insert(3064);
+        }
+        // Each chunk is a header followed by its nodes
+        auto stride = (recorder.sizes[1] - recorder.sizes[0]) / 8;
+        auto header = recorder.sizes[0] - (8 * stride);
+        StringBuilder nodes;
+        for (usize i = 0; i < 10; i++) {
+            if (i > 0) {
+                nodes.append(' ');
+            }
+            nodes.appendInteger(UNSAFE((recorder.sizes[i] - header) / stride));
+        }
+        stdout.println("\t(`) Expect \"8 16 32 64 128 256 512 1024 1024 1024\" : `", t++, nodes.take());
+        stdout.println("\t(`) Expect \"10 10\" : ` `", t++, recorder.allocations, recorder.deallocations);
+    }
+    {
+        // The payload follows the node header at the element's alignment, in every chunk
+        RecordingAllocator recorder;
+        DLList<OverAlignedElement> list(recorder.allocator());
+        for (u64 i = 0; i < 100; i++) {
+            list.end().insert(OverAlignedElement{i});
+        }
+        usize misaligned = 0;
+        u64 expected = 0;
+        usize wrongValues = 0;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            misaligned += (reinterpret_cast<usize>(&*it) % ClassOf<OverAlignedElement>.alignBytes) != 0;
+            wrongValues += it->value != expected++;
+        }
+        stdout.println("\t(`) Expect \"64 64 4 0 0\" : ` ` ` ` `", t++, ClassOf<OverAlignedElement>.alignBytes,
+            recorder.lastAlignment, recorder.allocations, misaligned, wrongValues);
+    }
+    {
+        // Elements are destroyed on remove, on clear, and with the list
+        LiveCountedElement::live = 0;
+        {
+            DLList<LiveCountedElement> list;
+            for (u64 i = 0; i < 10; i++) {
+                list.end().insert(LiveCountedElement(i));
+            }
+            auto afterInsert = LiveCountedElement::live;
+            auto it = list.begin();
+            it.remove().remove().remove();
+            auto afterRemove = LiveCountedElement::live;
+            stdout.println(
+                "\t(`) Expect \"10 7 3 7\" : ` ` ` `", t++, afterInsert, afterRemove, it->value, list.length());
+            list.clear();
+            auto afterClear = LiveCountedElement::live;
+            for (u64 i = 0; i < 5; i++) {
+                list.end().insert(LiveCountedElement(i));
+            }
+            stdout.println("\t(`) Expect \"0 5\" : ` `", t++, afterClear, LiveCountedElement::live);
+        }
+        stdout.println("\t(`) Expect \"0\" : `", t++, LiveCountedElement::live);
+    }
+}
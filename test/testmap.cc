@@ -0,0 +1,187 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// A map key whose hash is chosen by the test, to put many keys on the same probe path.
+///
+struct CollidingKey
+{
+    u64 value;
+    u64 hashValue;
+
+    template<typename Hasher>
+    u64 hash(auto) const
+    {
+        return hashValue;
+    }
+
+    bool equals(CollidingKey const& other) const { return value == other.value; }
+};
+
+///
+/// Test Map lookups after churn: random puts and removes on a small table, then lookups of keys that are present and
+/// of keys that are not; and hundreds of keys on one probe path, which saturates the overflow counters of the groups on
+/// it, removed again before looking up absent keys.
+///
+inline void testMap()
+{
+    stdout.println("\nTESTING Map");
+    usize t = 0;
+    u64 seed = 0x9E3779B97F4A7C15ull;
+    auto next = [&](u64 bound) {
+        seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+        return (seed >> 33) % bound;
+    };
+
+    // Keys 0 to 47 in a table that stays at a few groups, with the expected values kept alongside
+    constexpr usize KEYS = 48;
+    Map<u64, u64> map;
+    bool present[KEYS] = {};
+    u64 values[KEYS] = {};
+    usize expectedLength = 0;
+    usize mismatches = 0;
+    UNSAFE_BEGIN;
+    for (usize i = 0; i < 50'000; i++) {
+        u64 key = next(KEYS);
+        if (next(2) == 0) {
+            u64 value = next(1000);
+            mismatches += map.put(key, value) == present[key];
+            expectedLength += !present[key];
+            present[key] = true;
+            values[key] = value;
+        } else {
+            mismatches += map.remove(key) != present[key];
+            expectedLength -= present[key];
+            present[key] = false;
+        }
+        mismatches += map.length() != expectedLength;
+    }
+    for (u64 key = 0; key < KEYS; key++) {
+        auto value = map.get(key);
+        mismatches += value.hasValue() != present[key] || (present[key] && *value.val() != values[key]);
+    }
+    UNSAFE_END;
+    for (u64 key = KEYS; key < 100'000; key++) {
+        mismatches += map.contains(key);
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (churn)", t++, mismatches);
+    stdout.println("\t(`) Expect \"true\" : `", t++, map.capacity() <= 4 * 15);
+
+    // Rounds of 300 keys with the same home group (the bits above the low 7 of the hash), put and removed again. Each
+    // round saturates the counters at the start of its path; if they stayed stuck, every group of the table would end
+    // up with a nonzero counter, and a lookup of an absent key would never find a group that ends it.
+    Map<CollidingKey, u64> colliding;
+    mismatches = 0;
+    for (u64 round = 0; round < 32; round++) {
+        u64 home = round;
+        for (u64 i = 0; i < 300; i++) {
+            colliding.put(CollidingKey{(round * 1000) + i, (home << 7) | (i & 0x7f)}, i);
+        }
+        for (u64 i = 0; i < 300; i++) {
+            auto value = colliding.get(CollidingKey{(round * 1000) + i, (home << 7) | (i & 0x7f)});
+            mismatches += !value.hasValue() || *value.val() != i;
+        }
+        for (u64 i = 0; i < 300; i++) {
+            mismatches += !colliding.remove(CollidingKey{(round * 1000) + i, (home << 7) | (i & 0x7f)});
+        }
+    }
+    // Absent keys on every path, whose lookups go through the stuck counters
+    for (u64 home = 0; home < 64; home++) {
+        for (u64 low = 0; low < 128; low += 9) {
+            mismatches += colliding.contains(CollidingKey{~u64(0), (home << 7) | low});
+        }
+    }
+    mismatches += colliding.length() != 0;
+    colliding.put(CollidingKey{1, 0}, 1);
+    mismatches += !colliding.contains(CollidingKey{1, 0}) || colliding.contains(CollidingKey{2, 0});
+    stdout.println("\t(`) Expect \"0\" : ` (colliding keys)", t++, mismatches);
+}
+
+///
+/// Returns true if a String hashes with a hasher like the same characters in another buffer do, as a StringRef and as
+/// a C string.
+///
+template<typename Hasher>
+inline bool hashesLikeItsCharacters(String const& s, char* characters)
+{
+    using SeedType = Hasher::SeedType;
+    auto seed = SeedType(Hasher::DEFAULT_SEED);
+    auto hash = u64(s.template hash<Hasher>(seed));
+    return hash == u64(StringRef(characters).template hash<Hasher>(seed)) &&
+           hash == u64(Hash<Hasher>::hash(characters, seed));
+}
+
+///
+/// Test a Map with String keys looked up without making a String: with a StringRef, a string literal and a C string
+/// built at runtime. Also test that a String hashes like its characters do, stored inline, on the heap, shared, and
+/// in .rodata.
+///
+inline void testMapStringKeys()
+{
+    stdout.println("\nTESTING Map with String keys");
+    usize t = 0;
+
+    // A key stored inline and one on the heap, with copies of their characters on the stack
+    String shortKey = "pear";
+    String longKey = "a key that is too long to be stored inline";
+    longKey.append("!");
+    char shortChars[] = "pear";
+    char longChars[64] = {};
+    memcpy(&longChars[0], longKey.cstr(), longKey.length() + 1);
+    char const* shortCString = &shortChars[0];
+    char const* longCString = &longChars[0];
+
+    Map<String, u32> map;
+    auto addedShort = map.put(shortKey, 1);
+    auto addedLong = map.put(longKey, 2);
+    auto addedAgain = map.put(String("pear"), 1);
+    stdout.println(
+        "\t(`) Expect \"true true false 2\" : ` ` ` `", t++, addedShort, addedLong, addedAgain, map.length());
+    auto valueOf = [&](auto const& key) {
+        auto value = map.get(key);
+        return value.hasValue() ? *value.val() : 0u;
+    };
+    stdout.println("\t(`) Expect \"1 1 1\" : ` ` `", t++, valueOf(StringRef("pear")), valueOf("pear"),
+        valueOf(shortCString));
+    stdout.println("\t(`) Expect \"2 2 2\" : ` ` `", t++, valueOf(StringRef(longCString)),
+        valueOf("a key that is too long to be stored inline!"), valueOf(longCString));
+    stdout.println("\t(`) Expect \"true true true\" : ` ` `", t++, map.contains(StringRef("pear")),
+        map.contains("a key that is too long to be stored inline!"), map.contains(longCString));
+
+    // A prefix of a key, and the key without its last character
+    UNSAFE(shortChars[3] = '\0');
+    UNSAFE(longChars[longKey.length() - 1] = '\0');
+    stdout.println("\t(`) Expect \"false false false false\" : ` ` ` `", t++, map.contains(shortCString),
+        map.contains(longCString), map.contains("pea"), map.contains(StringRef("plum")));
+    UNSAFE(shortChars[3] = 'r');
+    UNSAFE(longChars[longKey.length() - 1] = '!');
+
+    auto removedShort = map.remove(shortCString);
+    auto shortLeft = map.contains("pear");
+    auto removedLong = map.remove(StringRef(longCString));
+    auto removedLongAgain = map.remove("a key that is too long to be stored inline!");
+    stdout.println("\t(`) Expect \"true false true false 0\" : ` ` ` ` `", t++, removedShort, shortLeft, removedLong,
+        removedLongAgain, map.length());
+
+    // Inline, heap, shared, and .rodata Strings hash like their characters
+    String heapKey = longKey;
+    String sharedKey = longKey;
+    sharedKey.share();
+    String sharingCopy = sharedKey;
+    String rodataKey = "a key that is too long to be stored inline!";
+    rodataKey.share();  // Does nothing: the characters stay in .rodata
+    stdout.println("\t(`) Expect \"true false\" : ` `", t++, sharingCopy.isShared(), rodataKey.isShared());
+    usize mismatches = 0;
+    auto checkHashes = [&](String const& s, char* characters) {
+        mismatches += !hashesLikeItsCharacters<WyHash>(s, characters);
+        mismatches += !hashesLikeItsCharacters<Xxh3>(s, characters);
+        mismatches += !hashesLikeItsCharacters<Crc32>(s, characters);
+    };
+    checkHashes(shortKey, &shortChars[0]);
+    checkHashes(heapKey, &longChars[0]);
+    checkHashes(sharedKey, &longChars[0]);
+    checkHashes(sharingCopy, &longChars[0]);
+    checkHashes(rodataKey, &longChars[0]);
+    stdout.println("\t(`) Expect \"0\" : ` (with WyHash, Xxh3 and Crc32)", t++, mismatches);
+}
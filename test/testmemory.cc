@@ -0,0 +1,89 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test memmove with buffers overlapping in either direction, and memcpy, memmove and memset between separate buffers,
+/// for sizes in every size class: the overlapping small copies, the forward and backward loops, and the non-temporal
+/// stores above NON_TEMPORAL_THRESHOLD.
+/// The expected bytes are computed from their index, not with another copy, which could end up calling the functions
+/// under test.
+///
+inline void testMemory()
+{
+    stdout.println("\nTESTING memmove, memcpy and memset");
+    usize t = 0;
+    auto pattern = [](usize i) { return u8((i * 131) + 7); };
+    constexpr usize C = impl::MEMORY_CHUNK;
+    // Around each size class boundary (16, 32, 2 chunks, 4 chunks), then the loops
+    usize sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 130, 200, 255,
+        256, 257, 1000, 4096, 4097, 64_KB + 3, impl::NON_TEMPORAL_THRESHOLD + 100};
+
+    usize overlapMismatches = 0;
+    usize separateMismatches = 0;
+    for (usize n : sizes) {
+        // Overlapping: dst is `shift` bytes after src (a backward copy) or before it (a forward copy)
+        usize shifts[] = {1, 3, 8, C - 1, C, C + 1, (2 * C) + 5, (4 * C) + 9, (n / 2) + 1};
+        usize total = n + (2 * ((n / 2) + 1 + (4 * C) + 9)) + 64;
+        auto* buffer = new u8[total];
+        for (usize shift : shifts) {
+            for (usize base : {usize(0), usize(1), usize(13)}) {
+                for (bool backward : {false, true}) {
+                    usize src = backward ? base : base + shift;
+                    usize dst = backward ? base + shift : base;
+                    for (usize i = 0; i < total; i++) {
+                        UNSAFE(buffer[i] = pattern(i));
+                    }
+                    memmove(UNSAFE(buffer + dst), UNSAFE(buffer + src), n);
+                    for (usize i = 0; i < total; i++) {
+                        u8 expected = (i >= dst && i < dst + n) ? pattern(src + i - dst) : pattern(i);
+                        if (UNSAFE(buffer[i]) != expected) {
+                            overlapMismatches++;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        delete[] buffer;
+
+        // Separate buffers, at an unaligned offset or not
+        auto* a = new u8[n + 64];
+        auto* b = new u8[n + 64];
+        for (usize offset : {usize(0), usize(5)}) {
+            auto checkB = [&](auto const& expectedInside, auto const& expectedOutside) {
+                for (usize i = 0; i < n + 64; i++) {
+                    u8 expected = (i >= offset && i < offset + n) ? expectedInside(i) : expectedOutside(i);
+                    if (UNSAFE(b[i]) != expected) {
+                        separateMismatches++;
+                        return;
+                    }
+                }
+            };
+            auto copied = [&](usize i) { return pattern(i - offset + 1); };
+            auto zero = [](usize) { return u8(0); };
+            for (usize i = 0; i < n + 64; i++) {
+                UNSAFE(a[i] = pattern(i));
+                UNSAFE(b[i] = 0);
+            }
+            memcpy(UNSAFE(b + offset), UNSAFE(a + 1), n);
+            checkB(copied, zero);
+
+            for (usize i = 0; i < n + 64; i++) {
+                UNSAFE(b[i] = 0);
+            }
+            memmove(UNSAFE(b + offset), UNSAFE(a + 1), n);
+            checkB(copied, zero);
+
+            for (usize i = 0; i < n + 64; i++) {
+                UNSAFE(b[i] = pattern(i));
+            }
+            memset(UNSAFE(b + offset), 0xA5, n);
+            checkB([](usize) { return u8(0xA5); }, pattern);
+        }
+        delete[] a;
+        delete[] b;
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (memmove, overlapping)", t++, overlapMismatches);
+    stdout.println("\t(`) Expect \"0\" : ` (memcpy, memmove and memset, separate buffers)", t++, separateMismatches);
+}
@@ -0,0 +1,117 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test MultiMatcher against a naive search (every pattern compared at every position), with sets small enough for
+/// the SIMD prefilter and large enough for the Aho-Corasick automaton: overlapping patterns, duplicates, patterns
+/// longer than the prefilter's 3-character fingerprint, empty patterns, and matches that end at the last character.
+/// The prefilter reports matches by start position and the automaton by end position, so the matches are compared as
+/// a set.
+///
+inline void testMultiMatcher()
+{
+    stdout.println("\nTESTING MultiMatcher");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+    auto matches = [](MultiMatcher const& matcher, StringRef text) {
+        String result;
+        matcher.forEachMatch(
+            text, [&](MultiMatcher::Match m) { result.append(String::fmt("`@` ", m.pattern, m.position)); });
+        return result;
+    };
+
+    // Overlapping patterns, one a suffix of another ("he" in "she") or sharing a prefix ("he", "hers")
+    MultiMatcher classic({"he", "she", "his", "hers"});
+    check("3", String::fmt("`", classic.countMatches("ushers")));
+    check("true false", String::fmt("` `", classic.matchesAny("ushers"), classic.matchesAny("usual")));
+    // Duplicate patterns are both reported, and empty ones never match
+    check("0@0 2@0 ", matches(MultiMatcher({"ab", "", "ab"}), "ab"));
+    check("1@14 ", matches(MultiMatcher({"", "tail"}), "a text with a tail"));
+
+    u64 seed = 0x2545F4914F6CDD1Dull;
+    auto next = [&](u64 bound) {
+        seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+        return (seed >> 33) % bound;
+    };
+    constexpr usize MAX_PATTERNS = 48;
+    constexpr usize MAX_PATTERN_LENGTH = 12;
+    constexpr usize MAX_TEXT_LENGTH = 200;
+    char patternChars[MAX_PATTERNS * MAX_PATTERN_LENGTH];
+    StringRef patterns[MAX_PATTERNS];
+    char textChars[MAX_TEXT_LENGTH];
+    bool found[MAX_TEXT_LENGTH * MAX_PATTERNS];
+    usize mismatches = 0;
+    usize prefiltered = 0;
+    usize automata = 0;
+    UNSAFE_BEGIN;
+    for (usize iteration = 0; iteration < 3000; iteration++) {
+        // 1 to 8 patterns, up to the prefilter's limit, or more than that
+        usize sizes[] = {1 + next(8), 1 + next(MultiMatcher::TEDDY_MAX_PATTERNS + 1),
+            MultiMatcher::TEDDY_MAX_PATTERNS + 1 + next(MAX_PATTERNS - MultiMatcher::TEDDY_MAX_PATTERNS)};
+        usize patternCount = min(sizes[iteration % 3], MAX_PATTERNS);
+        // A small alphabet, so that the patterns overlap each other and occur often
+        u64 alphabet = 2 + next(3);
+        for (usize p = 0; p < patternCount; p++) {
+            usize length = next(8) == 0 ? 0 : 1 + next(next(4) == 0 ? MAX_PATTERN_LENGTH : 4);
+            char* chars = patternChars + (p * MAX_PATTERN_LENGTH);
+            for (usize j = 0; j < length; j++) {
+                chars[j] = char('a' + next(alphabet));
+            }
+            patterns[p] = StringRef(chars, length);
+        }
+        if (patternCount > 2 && next(3) == 0) {
+            patterns[1] = patterns[0];
+        }
+        MultiMatcher matcher(ArrayRef<StringRef>(&patterns[0], patternCount));
+        if (matcher.usesPrefilter()) {
+            prefiltered++;
+        } else {
+            automata++;
+        }
+
+        usize n = next(MAX_TEXT_LENGTH + 1);
+        for (usize i = 0; i < n; i++) {
+            textChars[i] = char('a' + next(alphabet + 1));
+        }
+        // Put a pattern at the end of the text, past the last full chunk
+        StringRef tail = patterns[next(patternCount)];
+        if (tail.length() <= n) {
+            memcpy(textChars + n - tail.length(), tail.data(), tail.length());
+        }
+        StringRef text(&textChars[0], n);
+
+        // Every reported match must be a real one, reported once, and there must be as many as the naive search finds
+        memset(found, 0, sizeof(found));
+        usize reported = 0;
+        matcher.forEachMatch(text, [&](MultiMatcher::Match m) {
+            StringRef p = patterns[m.pattern];
+            reported++;
+            if (p.length() == 0 || m.position + p.length() > n ||
+                !StringRef(textChars + m.position, p.length()).equals(p)) {
+                mismatches++;
+                return;
+            }
+            bool& seen = found[(m.position * MAX_PATTERNS) + m.pattern];
+            mismatches += seen;
+            seen = true;
+        });
+        usize expected = 0;
+        for (usize i = 0; i < n; i++) {
+            for (usize p = 0; p < patternCount; p++) {
+                usize length = patterns[p].length();
+                expected += length != 0 && i + length <= n && StringRef(textChars + i, length).equals(patterns[p]);
+            }
+        }
+        mismatches += reported != expected;
+        mismatches += matcher.countMatches(text) != expected;
+        mismatches += matcher.matchesAny(text) != (expected != 0);
+    }
+    UNSAFE_END;
+    stdout.println("\t(`) Expect \"0\" : `", t++, mismatches);
+    // Both the prefilter (where the target has it) and the automaton were tested
+    bool bothTested = automata != 0 && (prefiltered != 0) == (MultiMatcher::TEDDY_MAX_PATTERNS != 0);
+    stdout.println("\t(`) Expect \"true\" : `", t++, bothTested);
+}
@@ -0,0 +1,87 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns the shortest text of the number parse() reads from a string, or the name of the error.
+///
+template<IsFloatingPoint T>
+String parseFloatString(StringRef s)
+{
+    auto result = parse<T>(s);
+    if (result.isOk()) {
+        return String::fmt("`", result.unwrap());
+    }
+    return result.error().template is<Errors::Overflow>() ? "Overflow" : "BadFormat";
+}
+
+///
+/// Test parse() for doubles and floats: ties and near-ties, inputs longer than 19 significant digits, subnormals,
+/// overflow and underflow, negative zero and the syntax.
+///
+inline void testParseFloat()
+{
+    stdout.println("\nTESTING parse (floating point)");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+
+    // Exactly halfway between two doubles rounds to the even one, and any digit past the halfway point rounds up
+    check("9007199254740992.0", parseFloatString<double>("9007199254740993"));
+    check("9007199254740996.0", parseFloatString<double>("9007199254740995"));
+    check("9007199254740994.0", parseFloatString<double>("9007199254740993.0000000000000000001"));
+    check("1.0", parseFloatString<double>("1.00000000000000011102230246251565404236316680908203125"));
+    check("1.0000000000000002",
+        parseFloatString<double>("1.000000000000000111022302462515654042363166809082031250000001"));
+
+    // Around the smallest normal double, where the spacing of the subnormals takes over
+    check("2.225073858507201e-308", parseFloatString<double>("2.2250738585072011e-308"));
+    check("2.2250738585072014e-308", parseFloatString<double>("2.2250738585072012e-308"));
+
+    // More than 19 significant digits
+    check("1.2345678901234568e+29", parseFloatString<double>("123456789012345678901234567890"));
+    check("3.141592653589793", parseFloatString<double>("3.14159265358979323846264338327950288"));
+    check("0.1", parseFloatString<double>("0.10000000000000000555111512312578270211815834045410156250000000001"));
+
+    // Subnormals, and the halfway point below the smallest one
+    check("5e-324", parseFloatString<double>("4.9e-324"));
+    check("5e-324", parseFloatString<double>("2.4703282292062328e-324"));
+    check("0.0", parseFloatString<double>("2.4703282292062327e-324"));
+
+    // Overflow is an error from parse(), and an infinity from String::toDouble(); underflow rounds to 0
+    check("1.7976931348623157e+308", parseFloatString<double>("1.7976931348623158e308"));
+    check("Overflow Overflow", String::fmt("` `", parseFloatString<double>("1.7976931348623159e308"),
+                                   parseFloatString<double>("-1e400")));
+    check("inf -inf", String::fmt("` `", String("1e400").toDouble(), String("-1e400").toDouble()));
+    check("0.0 -0.0", String::fmt("` `", parseFloatString<double>("1e-400"), parseFloatString<double>("-1e-400")));
+
+    // Negative zero keeps its sign
+    check("-0.0 -0.0", String::fmt("` `", parseFloatString<double>("-0.0"), parseFloatString<double>("-0")));
+    check("true", String::fmt("`", __builtin_signbit(parse<double>("-0.0").unwrap()) != 0));
+
+    // Syntax
+    check("0.5 5.0 1500.0 0.0015 12.0 1.5", String::fmt("` ` ` ` ` `", parseFloatString<double>(".5"),
+                                                parseFloatString<double>("5."), parseFloatString<double>("1.5e3"),
+                                                parseFloatString<double>("1.5E-3"), parseFloatString<double>("00012"),
+                                                parseFloatString<double>("+1.5")));
+    check("inf -inf NaN", String::fmt("` ` `", parseFloatString<double>("inf"),
+                              parseFloatString<double>("-Infinity"), parseFloatString<double>("nan")));
+    check("BadFormat BadFormat BadFormat", String::fmt("` ` `", parseFloatString<double>(""),
+                                               parseFloatString<double>("-"), parseFloatString<double>(".")));
+    check("BadFormat BadFormat BadFormat BadFormat",
+        String::fmt("` ` ` `", parseFloatString<double>("1e"), parseFloatString<double>("1e+"),
+            parseFloatString<double>("0x10"), parseFloatString<double>("1 ")));
+
+    // The float path
+    check("0.1", parseFloatString<float>("0.1"));
+    check("16777216.0 16777220.0",
+        String::fmt("` `", parseFloatString<float>("16777217"), parseFloatString<float>("16777219")));
+    check("1.0000001", parseFloatString<float>("1.00000005960464477539062500001"));
+    check("3.4028235e+38 Overflow",
+        String::fmt("` `", parseFloatString<float>("3.4028235e38"), parseFloatString<float>("3.4028236e38")));
+    check("1.1754944e-38", parseFloatString<float>("1.17549435e-38"));
+    check("1e-45 1e-45 0.0", String::fmt("` ` `", parseFloatString<float>("1.4e-45"),
+                                 parseFloatString<float>("7.1e-46"), parseFloatString<float>("7e-46")));
+    check("-0.0", parseFloatString<float>("-0.0"));
+}
@@ -0,0 +1,81 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns the integer parse() reads from a string, or the name of the error.
+///
+template<IsInteger T, IntegerParsingScheme S = IntegerParsingScheme::DEFAULT>
+String parseIntString(StringRef s)
+{
+    auto result = parse<T, S>(s);
+    if (result.isOk()) {
+        return String::fmt("`", result.unwrap());
+    }
+    return result.error().template is<Errors::Overflow>() ? "Overflow" : "BadFormat";
+}
+
+///
+/// Test parse() for integers: the JSON and YAML syntaxes, and the limits of every width.
+///
+inline void testParseInt()
+{
+    stdout.println("\nTESTING parse (integers)");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+    using enum IntegerParsingScheme;
+
+    // JSON: no leading zeros, no '+', no prefixes
+    check("0 0", String::fmt("` `", parseIntString<i32>("0"), parseIntString<u32>("0")));
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32>("01"), parseIntString<i32>("00")));
+    check("BadFormat", parseIntString<i32>("-01"));
+    check("BadFormat", parseIntString<i32>("+1"));
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32>(" 1"), parseIntString<i32>("1a")));
+    check("0", parseIntString<i32>("-0"));
+
+    // "-0" is negative as far as unsigned types are concerned
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<u32>("-0"), parseIntString<u64>("-0")));
+    check("BadFormat", parseIntString<u8, YAML>("-0"));
+
+    // Empty and sign-only strings
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32>(""), parseIntString<u64>("")));
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32>("-"), parseIntString<i32, YAML>("-")));
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32, YAML>(""), parseIntString<i32, YAML>("+")));
+
+    // YAML: 0x, 0o, 0b and leading-0 octal prefixes, a sign, and underscores between digits
+    check("65535 255", String::fmt("` `", parseIntString<u16, YAML>("0x_ff_ff"), parseIntString<u16, YAML>("0xFF")));
+    check("15 15 5", String::fmt("` ` `", parseIntString<i32, YAML>("0o17"), parseIntString<i32, YAML>("017"),
+                         parseIntString<i32, YAML>("0b101")));
+    check("1000 12", String::fmt("` `", parseIntString<i32, YAML>("1_000"), parseIntString<i32, YAML>("1__2")));
+    check("-16 5", String::fmt("` `", parseIntString<i32, YAML>("-0x10"), parseIntString<i32, YAML>("+5")));
+    check("BadFormat BadFormat BadFormat", String::fmt("` ` `", parseIntString<i32, YAML>("0x"),
+                                               parseIntString<i32, YAML>("0o"), parseIntString<i32, YAML>("0b")));
+    check("BadFormat BadFormat", String::fmt("` `", parseIntString<i32, YAML>("0b2"), parseIntString<i32, YAML>("08")));
+    check("BadFormat BadFormat",
+        String::fmt("` `", parseIntString<i32, YAML>("_1"), parseIntString<i32, YAML>("0_x1")));
+    check("18446744073709551615 Overflow", String::fmt("` `", parseIntString<u64, YAML>("0xffff_ffff_ffff_ffff"),
+                                               parseIntString<u64, YAML>("0x1_0000_0000_0000_0000")));
+
+    // MIN and MAX of every width parse, one past them overflows
+    check("-128 127", String::fmt("` `", parseIntString<i8>("-128"), parseIntString<i8>("127")));
+    check("Overflow Overflow", String::fmt("` `", parseIntString<i8>("-129"), parseIntString<i8>("128")));
+    check("255 Overflow", String::fmt("` `", parseIntString<u8>("255"), parseIntString<u8>("256")));
+    check("-32768 32767", String::fmt("` `", parseIntString<i16>("-32768"), parseIntString<i16>("32767")));
+    check("Overflow Overflow", String::fmt("` `", parseIntString<i16>("-32769"), parseIntString<i16>("32768")));
+    check("65535 Overflow", String::fmt("` `", parseIntString<u16>("65535"), parseIntString<u16>("65536")));
+    check("-2147483648 2147483647",
+        String::fmt("` `", parseIntString<i32>("-2147483648"), parseIntString<i32>("2147483647")));
+    check("Overflow Overflow",
+        String::fmt("` `", parseIntString<i32>("-2147483649"), parseIntString<i32>("2147483648")));
+    check("4294967295 Overflow",
+        String::fmt("` `", parseIntString<u32>("4294967295"), parseIntString<u32>("4294967296")));
+    check("-9223372036854775808", parseIntString<i64>("-9223372036854775808"));
+    check("9223372036854775807", parseIntString<i64>("9223372036854775807"));
+    check("Overflow Overflow", String::fmt("` `", parseIntString<i64>("-9223372036854775809"),
+                                   parseIntString<i64>("9223372036854775808")));
+    check("18446744073709551615", parseIntString<u64>("18446744073709551615"));
+    check("Overflow Overflow", String::fmt("` `", parseIntString<u64>("18446744073709551616"),
+                                   parseIntString<u64>("99999999999999999999999")));
+}
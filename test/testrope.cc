@@ -0,0 +1,67 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test Rope against a String put through the same random inserts and erases, and check that edits in the middle of a
+/// chunk do not leave underfull chunks behind.
+///
+inline void testRope()
+{
+    stdout.println("\nTESTING Rope");
+    usize t = 0;
+    auto countChunks = [](Rope const& rope) {
+        usize chunks = 0;
+        rope.forEachChunk([&](StringRef) { chunks++; });
+        return chunks;
+    };
+
+    Rope small("hello world");
+    small.erase(5, 1);
+    small.insert(5, ", ");
+    stdout.println("\t(`) Expect \"hello, world 1\" : ` `", t++, small, countChunks(small));
+
+    u64 seed = 0x9E3779B97F4A7C15ull;
+    auto random = [&](usize bound) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return usize(seed >> 33) % bound;
+    };
+
+    char const* letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    String model;
+    for (usize i = 0; i < 3000; i++) {
+        model.append(StringRef(UNSAFE(letters + i % 26), 1));
+    }
+    Rope rope(model);
+    usize mismatches = 0;
+    for (usize op = 0; op < 3000; op++) {
+        usize length = model.length();
+        if (random(2) == 0 || length == 0) {
+            usize index = random(length + 1);
+            usize n = random(4) == 0 ? random(1200) : random(3) + 1;
+            String text;
+            for (usize i = 0; i < n; i++) {
+                text.append(StringRef(UNSAFE(letters + 26 + random(26)), 1));
+            }
+            rope.insert(index, text);
+            model.insert(usize(index), text);
+        } else {
+            usize index = random(length);
+            usize n = min(length - index, random(4) == 0 ? random(1500) : random(3) + 1);
+            rope.erase(index, n);
+            model.erase(usize(index), n);
+        }
+        if (rope.length() != model.length()) {
+            mismatches++;
+        } else if (model.length() > 0) {
+            usize index = random(model.length());
+            mismatches += rope[index] != model[usize(index)];
+        }
+    }
+    stdout.println("\t(`) Expect \"0\" : `", t++, mismatches);
+    stdout.println("\t(`) Expect \"true true\" : ` `", t++, rope.equals(model), rope.toString().equals(model));
+
+    // Every chunk boundary an edit touched was merged if it could be, so the chunks stay well filled on average
+    usize fullChunks = model.length() / Rope::CHUNK_CAPACITY + 1;
+    stdout.println("\t(`) Expect \"true\" : `", t++, countChunks(rope) <= 3 * fullChunks);
+}
@@ -0,0 +1,103 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns the number of ways of splitting the first bytes of data into pieces for which Hasher::State does not give
+/// the same hash as Hasher::hashBytes on the whole. Every split in two is tried for the lengths around the 48-byte
+/// rounds and LONG_INPUT, and around the first 1 KB block, after which Xxh3 scrambles its accumulators; random splits
+/// into up to 8 pieces (some of them empty) for every length up to MAX_LENGTH.
+///
+template<typename Hasher>
+usize streamingHashMismatches(u8 const* data)
+{
+    constexpr usize MAX_LENGTH = 2100;
+    auto seed = typename Hasher::SeedType(7);
+    usize mismatches = 0;
+    auto checkSplits = [&](usize length) {
+        auto expected = Hasher::hashBytes(data, length, seed);
+        for (usize split = 0; split <= length; split++) {
+            typename Hasher::State state(seed);
+            state.update(data, split);
+            state.update(UNSAFE(data + split), length - split);
+            mismatches += state.finalize() != expected;
+        }
+    };
+    for (usize length = 0; length <= 320; length++) {
+        checkSplits(length);
+    }
+    for (usize length = 1020; length <= 1100; length++) {
+        checkSplits(length);
+    }
+    for (usize length : {usize(2047), usize(2048), usize(2049), usize(2112)}) {
+        checkSplits(length);
+    }
+
+    u64 random = 0x9E3779B97F4A7C15ull;
+    auto next = [&](u64 bound) {
+        random = (random * 6364136223846793005ull) + 1442695040888963407ull;
+        return (random >> 33) % bound;
+    };
+    for (usize length = 0; length <= MAX_LENGTH; length++) {
+        typename Hasher::State state(seed);
+        HashState<Hasher> hashState(seed);
+        usize pieces = 1 + next(8);
+        for (usize i = 0, done = 0; i < pieces; i++) {
+            usize n = i == pieces - 1 ? length - done : next(length - done + 1);
+            state.update(UNSAFE(data + done), n);
+            hashState.update(UNSAFE(data + done), n);
+            done += n;
+            // Finalizing does not stop more data from being added
+            if (i == 0) {
+                mismatches += state.finalize() != Hasher::hashBytes(data, done, seed);
+            }
+        }
+        auto expected = Hash<Hasher>::hashData(data, length, seed);
+        mismatches += state.finalize() != expected;
+        mismatches += hashState.finalize() != expected;
+    }
+    return mismatches;
+}
+
+///
+/// Returns true if a string given alone to HashState::update hashes like Hash::hash of it and like a C string.
+///
+template<typename Hasher>
+bool hashStateStringMatches(StringRef str)
+{
+    auto streamed = HashState<Hasher>().update(str).finalize();
+    return streamed == Hash<Hasher>::hash(str) && streamed == Hasher::hashCString(str.data(), Hasher::DEFAULT_SEED);
+}
+
+///
+/// Test that Crc32, WyHash and Xxh3 give the same hash for an input however it is split, through their State and
+/// through HashState, and HashState::update(StringRef).
+///
+inline void testStreamingHash()
+{
+    stdout.println("\nTESTING Hasher::State and HashState");
+    usize t = 0;
+    constexpr usize MAX_LENGTH = 2112;
+    auto* data = new u8[MAX_LENGTH];
+    u64 seed = 0x2545F4914F6CDD1Dull;
+    for (usize i = 0; i < MAX_LENGTH; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        UNSAFE(data[i] = u8(seed));
+    }
+    stdout.println("\t(`) Expect \"0\" : ` (Crc32)", t++, streamingHashMismatches<Crc32>(data));
+    stdout.println("\t(`) Expect \"0\" : ` (WyHash)", t++, streamingHashMismatches<WyHash>(data));
+    stdout.println("\t(`) Expect \"0\" : ` (Xxh3)", t++, streamingHashMismatches<Xxh3>(data));
+    delete[] data;
+
+    StringRef text = "a string that is long enough for the 48-byte rounds of WyHash";
+    stdout.println("\t(`) Expect \"true true true\" : ` ` `", t++, hashStateStringMatches<Crc32>(text),
+        hashStateStringMatches<WyHash>(text), hashStateStringMatches<Xxh3>(text));
+    stdout.println("\t(`) Expect \"true true\" : ` `", t++, hashStateStringMatches<WyHash>(""),
+        hashStateStringMatches<WyHash>("abc"));
+    // The terminators keep the pieces apart
+    auto abThenC = HashState<WyHash>().update(StringRef("ab")).update(StringRef("c")).finalize();
+    auto aThenBc = HashState<WyHash>().update(StringRef("a")).update(StringRef("bc")).finalize();
+    stdout.println("\t(`) Expect \"true\" : `", t++, abThenC != aThenBc);
+}
@@ -0,0 +1,73 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Test copies of a String made shared with share(): they read the same buffer until one of them is modified, and the
+/// buffer is freed with the last of them.
+///
+inline void testStringShare()
+{
+    stdout.println("\nTESTING String::share()");
+    usize t = 0;
+    auto liveBefore = HeapStats::liveBytes();
+    {
+        StringRef text = "a string that is too long to be stored inline, so it is on the heap";
+        String original = "a string that is too long to be stored inline";
+        original.append(", so it is on the heap");
+        original.share();
+        String copy = original;
+        auto* copy2 = new String(original);
+        stdout.println("\t(`) Expect \"true true\" : ` `", t++, original.isShared(), copy.isShared());
+        stdout.println("\t(`) Expect \"true true\" : ` `", t++, copy.data() == original.data(),
+            copy2->data() == original.data());
+
+        copy[usize(0)] = 'A';
+        stdout.println("\t(`) Expect \"false\" : `", t++, copy.isShared());
+        stdout.println("\t(`) Expect \"A`\" : `", t++, StringRef(UNSAFE(text.data() + 1)), copy);
+        stdout.println("\t(`) Expect \"`\" : `", t++, text, original);
+        stdout.println("\t(`) Expect \"true\" : `", t++, copy2->data() == original.data());
+
+        // The buffer outlives the string that shared it, and is freed with the last copy
+        auto freesBefore = HeapStats::freeCount();
+        original = String("short");
+        stdout.println("\t(`) Expect \"`\" : `", t++, text, *copy2);
+        stdout.println("\t(`) Expect \"0\" : `", t++, HeapStats::freeCount() - freesBefore);
+        delete copy2;
+        if constexpr (HeapStats::ENABLED) {
+            stdout.println("\t(`) Expect \"2\" : `", t++, HeapStats::freeCount() - freesBefore);
+        }
+    }
+    if constexpr (HeapStats::ENABLED) {
+        stdout.println("\t(`) Expect \"0\" : `", t++, HeapStats::liveBytes() - liveBefore);
+    }
+}
+
+///
+/// Test that a moved-from String is left empty and can still be used: read, compared, appended to and assigned.
+///
+inline void testStringMove()
+{
+    stdout.println("\nTESTING String move");
+    usize t = 0;
+    StringRef text = "a string that is too long to be stored inline, so it is on the heap";
+    for (StringRef contents : {StringRef("short"), text}) {
+        String original = contents;
+        auto const* data = original.data();
+        String moved = static_cast<String&&>(original);
+        // A heap buffer is taken over, not copied
+        stdout.println("\t(`) Expect \"true true\" : ` `", t++, moved.equals(contents),
+            contents.length() <= String::INLINE_LENGTH || moved.data() == data);
+        stdout.println("\t(`) Expect \"0 true true []\" : ` ` ` [`]", t++, original.length(), original.cstr() != nullptr,
+            original.equals(""), original);
+        original.append("again");
+        stdout.println("\t(`) Expect \"again\" : `", t++, original);
+
+        String assigned = "to be replaced";
+        assigned = static_cast<String&&>(moved);
+        stdout.println("\t(`) Expect \"true 0 true\" : ` ` `", t++, assigned.equals(contents), moved.length(),
+            moved.equals(""));
+        moved = assigned;
+        stdout.println("\t(`) Expect \"true\" : `", t++, moved.equals(contents));
+    }
+}
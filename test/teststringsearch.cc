@@ -0,0 +1,146 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns the index in an Optional, or "None".
+///
+inline String indexString(Optional<usize> index)
+{
+    return index.hasValue() ? String::fmt("`", index.val()) : String("None");
+}
+
+///
+/// Test StringRef::find, rfind, findAll and count, through both the SIMD filter (needles shorter than
+/// TWO_WAY_MIN_NEEDLE) and Two-Way: empty needles, needles longer than the haystack, periodic needles, matches at
+/// either end, and random haystacks over a two-letter alphabet checked against a character by character search.
+///
+inline void testStringSearch()
+{
+    stdout.println("\nTESTING StringRef::find, rfind, findAll and count");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+    auto all = [](StringRef hay, StringRef needle) {
+        String result;
+        hay.findAll(needle, [&](usize i) { result.append(String::fmt("` ", i)); });
+        return result;
+    };
+
+    // An empty needle is found at the start by find and at the end by rfind, and is not counted
+    check("0 3 None", String::fmt("` ` `", indexString(StringRef("abc").find("")),
+                          indexString(StringRef("abc").rfind("")), indexString(StringRef("abc").find("", 4))));
+    check("0 0", String::fmt("` `", indexString(StringRef("").find("")), indexString(StringRef("").rfind(""))));
+    check("0 ", String::fmt("` `", StringRef("abc").count(""), all("abc", "")));
+
+    // A needle longer than the haystack is not found
+    check("None None 0", String::fmt("` ` `", indexString(StringRef("ab").find("abc")),
+                             indexString(StringRef("ab").rfind("abc")), StringRef("ab").count("abc")));
+    check("None None",
+        String::fmt("` `", indexString(StringRef("").find("a")), indexString(StringRef("").rfind("a"))));
+
+    // Periodic needles, whose prefixes match at many positions before the whole needle does
+    check("3 3", String::fmt("` `", indexString(StringRef("aaaaaab").find("aaab")),
+                     indexString(StringRef("aaaaaab").rfind("aaab"))));
+    check("None", indexString(StringRef("aaaaaaa").find("aaab")));
+    check("4 2", String::fmt("` `", indexString(StringRef("abababac").find("abac")),
+                     indexString(StringRef("abababac").rfind("abab"))));
+    // The same for needles long enough for Two-Way: 39 'a's and a 'b', in 50 'a's and a 'b'
+    String longHay;
+    String longNeedle;
+    for (usize i = 0; i < 50; i++) {
+        longHay.append("a");
+        longNeedle.append(i < 39 ? "a" : "");
+    }
+    longHay.append("b");
+    longNeedle.append("b");
+    check("11 11 None", String::fmt("` ` `", indexString(longHay.find(longNeedle)),
+                            indexString(longHay.rfind(longNeedle)), indexString(longHay.find(longNeedle, 12))));
+
+    // rfind finds a match at position 0, and find one that ends at the last character
+    check("0 0", String::fmt("` `", indexString(StringRef("abcd").rfind("ab")),
+                     indexString(StringRef("abcd").rfind("abcd"))));
+    check("2 3", String::fmt("` `", indexString(StringRef("abcd").find("cd")),
+                     indexString(StringRef("abcd").find("d", 3))));
+
+    // count and findAll skip the occurrences that overlap the previous one
+    check("2 0 2 ", String::fmt("` `", StringRef("aaaa").count("aa"), all("aaaa", "aa")));
+    check("1 0 ", String::fmt("` `", StringRef("aaa").count("aa"), all("aaa", "aa")));
+    check("2 0 4 ", String::fmt("` `", StringRef("abababa").count("aba"), all("abababa", "aba")));
+
+    // Random haystacks and needles, often planted in the haystack or made periodic, against a naive search
+    u64 seed = 0x9E3779B97F4A7C15ull;
+    auto next = [&](u64 bound) {
+        seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+        return (seed >> 33) % bound;
+    };
+    UNSAFE_BEGIN;
+    usize mismatches = 0;
+    char hayBuffer[300];
+    char needleBuffer[80];
+    for (usize iteration = 0; iteration < 20'000; iteration++) {
+        usize n = next(300);
+        usize m = next(4) == 0 ? 1 + next(79) : 1 + next(12);
+        for (usize i = 0; i < n; i++) {
+            hayBuffer[i] = char('a' + next(2));
+        }
+        usize period = 1 + next(4);
+        for (usize i = 0; i < m; i++) {
+            needleBuffer[i] = i >= period && next(3) != 0 ? needleBuffer[i - period] : char('a' + next(2));
+        }
+        if (m <= n && next(2) == 0) {
+            usize at = next(n - m + 1);
+            for (usize i = 0; i < m; i++) {
+                hayBuffer[at + i] = needleBuffer[i];
+            }
+        }
+        StringRef hay(&hayBuffer[0], n);
+        StringRef needle(&needleBuffer[0], m);
+
+        auto matchesAt = [&](usize i) {
+            for (usize j = 0; j < m; j++) {
+                if (hayBuffer[i + j] != needleBuffer[j]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        Optional<usize> first = None;
+        Optional<usize> last = None;
+        String expectedAll;
+        usize expectedCount = 0;
+        for (usize i = 0; i + m <= n; i++) {
+            if (matchesAt(i)) {
+                if (!first.hasValue()) {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+        for (usize i = 0; i + m <= n;) {
+            if (matchesAt(i)) {
+                expectedAll.append(String::fmt("` ", i));
+                expectedCount++;
+                i += m;
+            } else {
+                i++;
+            }
+        }
+        usize from = next(n + 2);
+        Optional<usize> firstFrom = None;
+        for (usize i = from; i + m <= n; i++) {
+            if (matchesAt(i)) {
+                firstFrom = i;
+                break;
+            }
+        }
+        mismatches += indexString(hay.find(needle)) != indexString(first);
+        mismatches += indexString(hay.rfind(needle)) != indexString(last);
+        mismatches += indexString(hay.find(needle, from)) != indexString(firstFrom);
+        mismatches += hay.count(needle) != expectedCount;
+        mismatches += all(hay, needle) != expectedAll;
+    }
+    UNSAFE_END;
+    stdout.println("\t(`) Expect \"0\" : `", t++, mismatches);
+}
@@ -0,0 +1,90 @@
+#include <commons/godbolt.hh>
+
+using namespace cm;
+
+///
+/// Returns what toChars() writes for a value, or "None" if it fails.
+///
+template<IntBaseFmt Base = IntBaseFmt::B10>
+String toCharsString(IsInteger auto value)
+{
+    char buffer[TO_CHARS_MAX_LENGTH<decltype(value), Base>];
+    auto n = toChars<Base>(value, ArrayRef<char>(buffer));
+    if (!n.hasValue()) {
+        return "None";
+    }
+    Assert(n.val() == toCharsLength<Base>(value), ASMS_BUG);
+    return String(StringRef(&buffer[0], n.val()));
+}
+
+///
+/// Test toChars() for integers in every base, at the limits of every width, and with a buffer that is too small.
+///
+inline void testToChars()
+{
+    stdout.println("\nTESTING toChars (integers)");
+    usize t = 0;
+    auto check = [&](StringRef expected, String const& actual) {
+        stdout.println("\t(`) Expect \"`\" : `", t++, expected, actual);
+    };
+
+    check("0", toCharsString(0));
+    check("0", toCharsString(u8(0)));
+    check("-1", toCharsString(-1));
+    check("9", toCharsString(9));
+    check("10", toCharsString(10));
+    check("99", toCharsString(99));
+    check("100", toCharsString(100));
+
+    // The limits of every width, including MIN, whose magnitude does not fit in the signed type
+    check("-128 127 255", String::fmt("` ` `", toCharsString(MIN_VALUE<i8>), toCharsString(MAX_VALUE<i8>),
+                              toCharsString(MAX_VALUE<u8>)));
+    check("-32768 32767 65535", String::fmt("` ` `", toCharsString(MIN_VALUE<i16>), toCharsString(MAX_VALUE<i16>),
+                                    toCharsString(MAX_VALUE<u16>)));
+    check("-2147483648 2147483647 4294967295", String::fmt("` ` `", toCharsString(MIN_VALUE<i32>),
+                                                   toCharsString(MAX_VALUE<i32>), toCharsString(MAX_VALUE<u32>)));
+    check("-9223372036854775808", toCharsString(MIN_VALUE<i64>));
+    check("9223372036854775807", toCharsString(MAX_VALUE<i64>));
+    check("18446744073709551615", toCharsString(MAX_VALUE<u64>));
+
+    // Every base, on MAX of u64 and MIN of i64
+    using enum IntBaseFmt;
+    check("1111111111111111111111111111111111111111111111111111111111111111", toCharsString<B2>(MAX_VALUE<u64>));
+    check("-1000000000000000000000000000000000000000000000000000000000000000", toCharsString<B2>(MIN_VALUE<i64>));
+    check("11112220022122120101211020120210210211220", toCharsString<B3>(MAX_VALUE<u64>));
+    check("-2021110011022210012102010021220101220222", toCharsString<B3>(MIN_VALUE<i64>));
+    check("33333333333333333333333333333333", toCharsString<B4>(MAX_VALUE<u64>));
+    check("-20000000000000000000000000000000", toCharsString<B4>(MIN_VALUE<i64>));
+    check("2214220303114400424121122430", toCharsString<B5>(MAX_VALUE<u64>));
+    check("-1104332401304422434310311213", toCharsString<B5>(MIN_VALUE<i64>));
+    check("3520522010102100444244423", toCharsString<B6>(MAX_VALUE<u64>));
+    check("-1540241003031030222122212", toCharsString<B6>(MIN_VALUE<i64>));
+    check("45012021522523134134601", toCharsString<B7>(MAX_VALUE<u64>));
+    check("-22341010611245052052301", toCharsString<B7>(MIN_VALUE<i64>));
+    check("1777777777777777777777", toCharsString<B8>(MAX_VALUE<u64>));
+    check("-1000000000000000000000", toCharsString<B8>(MIN_VALUE<i64>));
+    check("145808576354216723756", toCharsString<B9>(MAX_VALUE<u64>));
+    check("-67404283172107811828", toCharsString<B9>(MIN_VALUE<i64>));
+    check("ffffffffffffffff", toCharsString<B16>(MAX_VALUE<u64>));
+    check("-8000000000000000", toCharsString<B16>(MIN_VALUE<i64>));
+    check("-ff 7f", String::fmt("` `", toCharsString<B16>(-255), toCharsString<B16>(i8(127))));
+    check("P////////// -IAAAAAAAAAA A", String::fmt("` ` `", toCharsString<B64>(MAX_VALUE<u64>),
+                                           toCharsString<B64>(MIN_VALUE<i64>), toCharsString<B64>(0)));
+    check("P__________ -IAAAAAAAAAA A", String::fmt("` ` `", toCharsString<B64_URL>(MAX_VALUE<u64>),
+                                           toCharsString<B64_URL>(MIN_VALUE<i64>), toCharsString<B64_URL>(0)));
+    check("Dzzzzzzzzzz -6.......... .", String::fmt("` ` `", toCharsString<B64_crypt>(MAX_VALUE<u64>),
+                                           toCharsString<B64_crypt>(MIN_VALUE<i64>), toCharsString<B64_crypt>(0)));
+    check("N9999999999 -G.......... .", String::fmt("` ` `", toCharsString<B64_bcrypt>(MAX_VALUE<u64>),
+                                           toCharsString<B64_bcrypt>(MIN_VALUE<i64>), toCharsString<B64_bcrypt>(0)));
+    check("f__________ -80000000000 0", String::fmt("` ` `", toCharsString<B64_Bash>(MAX_VALUE<u64>),
+                                           toCharsString<B64_Bash>(MIN_VALUE<i64>), toCharsString<B64_Bash>(0)));
+
+    // A buffer one character too small fails without writing anything, an exact one succeeds
+    char buffer[8] = "xxxxxxx";
+    auto tooSmall = toChars(-123456, ArrayRef<char>(&buffer[0], 6));
+    stdout.println("\t(`) Expect \"false xxxxxxx\" : ` `", t++, tooSmall.hasValue(), StringRef(&buffer[0], 7));
+    auto exact = toChars(-123456, ArrayRef<char>(&buffer[0], 7));
+    stdout.println("\t(`) Expect \"7 -123456\" : ` `", t++, exact.val(), StringRef(&buffer[0], 7));
+    auto empty = toChars(0, ArrayRef<char>(&buffer[0], usize(0)));
+    stdout.println("\t(`) Expect \"false\" : `", t++, empty.hasValue());
+}